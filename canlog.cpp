@@ -0,0 +1,958 @@
+#include "canlog.h"
+#include <QFileInfo>
+#include <QDebug>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+// Bytes of the file mapped at a time. Lines never get near this, a line cut by the end of a
+// window is parsed again from the start of the next one.
+constexpr qint64 WindowSize = qint64(64) << 20;
+
+// Bytes of lines parsed by one task past the header. Large enough that a task outweighs its
+// scheduling, small enough that a batch of frames per thread stays a few megabytes.
+constexpr qint64 PartSize = qint64(256) << 10;
+
+// Nibble value of a hex digit, 0xFF for anything else
+struct HexTable {
+    uchar values[256];
+    constexpr HexTable() : values() {
+        for (int i = 0; i < 256; ++i) {
+            values[i] = 0xFF;
+        }
+        for (int i = 0; i < 10; ++i) {
+            values['0' + i] = uchar(i);
+        }
+        for (int i = 0; i < 6; ++i) {
+            values['a' + i] = uchar(10 + i);
+            values['A' + i] = uchar(10 + i);
+        }
+    }
+};
+constexpr HexTable Hex;
+
+inline uchar hexValue(char c)
+{
+    return Hex.values[uchar(c)];
+}
+
+constexpr quint64 Ones = 0x0101010101010101ull;
+constexpr quint64 HighBits = Ones * 0x80;
+
+// Bit 7 of each byte tells whether it lies in [low, high], valid for ASCII bytes only
+constexpr quint64 bytesInRange(quint64 bytes, quint64 low, quint64 high)
+{
+    return (bytes + Ones * (0x80 - low)) & ~(bytes + Ones * (0x7F - high)) & HighBits;
+}
+
+// Eight hex digits to four bytes at once, false if any of them is not a hex digit. Text logs
+// spend most of their bytes on payload hex, this keeps it off the per-character path.
+inline bool decodeHex8(const char* text, uchar* out)
+{
+    const quint64 chars = qFromLittleEndian<quint64>(text);
+    const quint64 lower = chars | Ones * 0x20;
+    if ((chars & HighBits) || (bytesInRange(chars, '0', '9') | bytesInRange(lower, 'a', 'f')) != HighBits) {
+        return false;
+    }
+
+    // Nibble values, then pairs of nibbles into bytes and the bytes packed together
+    quint64 nibbles = (lower & Ones * 0x0F) + ((lower >> 6) & Ones) * 9;
+    nibbles = ((nibbles << 4) | (nibbles >> 8)) & 0x00FF00FF00FF00FFull;
+    nibbles = (nibbles | (nibbles >> 8)) & 0x0000FFFF0000FFFFull;
+    nibbles = (nibbles | (nibbles >> 16)) & 0xFFFFFFFFull;
+    qToLittleEndian(quint32(nibbles), out);
+    return true;
+}
+
+// Eight decimal digits at once, for the long integer part of absolute timestamps
+inline bool decodeDecimal8(const char* text, quint32& value)
+{
+    quint64 chars = qFromLittleEndian<quint64>(text);
+    if ((chars & HighBits) || bytesInRange(chars, '0', '9') != HighBits) {
+        return false;
+    }
+    chars -= Ones * '0';
+    chars = chars * 10 + (chars >> 8);
+    chars = ((chars & 0x000000FF000000FFull) * (100 + (1000000ull << 32))
+             + ((chars >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32))) >> 32;
+    value = quint32(chars);
+    return true;
+}
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+inline void skipSpaces(const char*& p, const char* end)
+{
+    while (p < end && isSpace(*p)) {
+        ++p;
+    }
+}
+
+// Next whitespace separated token, empty at the end of the line
+inline std::string_view token(const char*& p, const char* end)
+{
+    skipSpaces(p, end);
+    const char* start = p;
+    while (p < end && !isSpace(*p)) {
+        ++p;
+    }
+    return std::string_view(start, size_t(p - start));
+}
+
+// Hex number of up to eight digits, false if the text holds anything else
+inline bool parseHex(std::string_view text, quint32& value)
+{
+    if (text.empty() || text.size() > 8) {
+        return false;
+    }
+    quint32 result = 0;
+    for (char c : text) {
+        const uchar nibble = hexValue(c);
+        if (nibble > 15) {
+            return false;
+        }
+        result = result << 4 | nibble;
+    }
+    value = result;
+    return true;
+}
+
+inline bool parseDecimal(std::string_view text, quint32& value)
+{
+    if (text.empty() || text.size() > 9) {
+        return false;
+    }
+    quint32 result = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        result = result * 10 + quint32(c - '0');
+    }
+    value = result;
+    return true;
+}
+
+// Fixed point number such as 1436509052.249713, scaled by 10^digits so timestamps stay exact
+// integers. Digits beyond the scale are dropped.
+bool parseFixed(std::string_view text, int digits, qint64& value)
+{
+    qint64 whole = 0;
+    size_t i = 0;
+    quint32 chunk;
+    while (text.size() - i >= 8 && decodeDecimal8(text.data() + i, chunk)) {
+        whole = whole * 100000000 + chunk;
+        i += 8;
+    }
+    for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i) {
+        whole = whole * 10 + (text[i] - '0');
+    }
+    if (i == 0 && (text.empty() || text[0] != '.')) {
+        return false;
+    }
+    qint64 fraction = 0;
+    int fractionDigits = 0;
+    if (i < text.size() && text[i] == '.') {
+        for (++i; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i) {
+            if (fractionDigits < digits) {
+                fraction = fraction * 10 + (text[i] - '0');
+                ++fractionDigits;
+            }
+        }
+    }
+    if (i != text.size()) {
+        return false;
+    }
+    for (; fractionDigits < digits; ++fractionDigits) {
+        fraction *= 10;
+    }
+    qint64 scale = 1;
+    for (int d = 0; d < digits; ++d) {
+        scale *= 10;
+    }
+    value = whole * scale + fraction;
+    return true;
+}
+
+// Payload bytes for a CAN FD data length code
+inline int dlcToSize(quint32 dlc)
+{
+    static constexpr quint8 Sizes[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+    return Sizes[dlc & 0x0F];
+}
+
+// End of the line starting at begin, given where the next one starts
+inline const char* withoutLineBreak(const char* begin, const char* end)
+{
+    if (end > begin && end[-1] == '\n') {
+        --end;
+    }
+    if (end > begin && end[-1] == '\r') {
+        --end;
+    }
+    return end;
+}
+
+inline bool startsWith(const char* begin, const char* end, std::string_view prefix)
+{
+    return size_t(end - begin) >= prefix.size() && std::memcmp(begin, prefix.data(), prefix.size()) == 0;
+}
+
+// Reads space separated hex bytes into the frame, false if fewer than count are there
+bool readDataBytes(const char*& p, const char* end, int count, CanFrame& frame)
+{
+    skipSpaces(p, end);
+    int i = 0;
+
+    // Bytes written as "AB CD EF 01", four at a time while the layout holds
+    while (count - i >= 4 && end - p >= 11 && p[2] == ' ' && p[5] == ' ' && p[8] == ' ') {
+        const char digits[8] = {p[0], p[1], p[3], p[4], p[6], p[7], p[9], p[10]};
+        if (!decodeHex8(digits, frame.data + i)) {
+            break;
+        }
+        i += 4;
+        p += 11;
+        skipSpaces(p, end);
+    }
+
+    for (; i < count; ++i) {
+        skipSpaces(p, end);
+        if (end - p < 2) {
+            return false;
+        }
+        const uchar high = hexValue(p[0]);
+        const uchar low = hexValue(p[1]);
+        if ((high | low) > 15) {
+            return false;
+        }
+        frame.data[i] = uchar(high << 4 | low);
+        p += 2;
+    }
+    frame.size = quint8(count);
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------
+// candump -L (SocketCAN log files)
+//   (1436509052.249713) can0 18FEF100#FFFFFFFFFFFFFFFF
+//   (1436509052.249713) can0 123#R
+//   (1436509052.249713) can1 18FEF100##1FFFFFFFFFFFFFFFFFFFF
+// Eight digit identifiers are extended, error frames carry bit 29 as in can_frame.
+class CandumpParser : public CanLogParser {
+    public:
+        std::unique_ptr<CanLogParser> clone() const override { return std::make_unique<CandumpParser>(*this); }
+
+        bool parseLine(const char* p, const char* end, CanFrame& frame) override
+        {
+            skipSpaces(p, end);
+            if (p == end || *p != '(') {
+                return false;
+            }
+            const char* close = static_cast<const char*>(std::memchr(p, ')', size_t(end - p)));
+            if (!close || !parseFixed(std::string_view(p + 1, size_t(close - p - 1)), 6, frame.timestamp)) {
+                return false;
+            }
+            p = close + 1;
+
+            // Channel number from the trailing digits of the interface name, which rarely changes
+            const std::string_view interface = token(p, end);
+            if (interface.size() != m_interfaceSize
+                || std::memcmp(interface.data(), m_interface.data(), interface.size()) != 0) {
+                size_t digits = interface.size();
+                while (digits > 0 && interface[digits - 1] >= '0' && interface[digits - 1] <= '9') {
+                    --digits;
+                }
+                quint32 channel = 0;
+                parseDecimal(interface.substr(digits), channel);
+                m_channel = quint8(channel);
+                m_interfaceSize = std::min(interface.size(), m_interface.size());
+                std::memcpy(m_interface.data(), interface.data(), m_interfaceSize);
+            }
+            frame.channel = m_channel;
+
+            // Identifier digits up to the '#', extended ones in one step
+            skipSpaces(p, end);
+            const char* idBegin = p;
+            quint32 id = 0;
+            uchar idBytes[4];
+            if (end - p > 8 && p[8] == '#' && decodeHex8(p, idBytes)) {
+                id = qFromBigEndian<quint32>(idBytes);
+                p += 8;
+            } else {
+                uchar nibble;
+                while (p < end && (nibble = hexValue(*p)) <= 15) {
+                    id = id << 4 | nibble;
+                    ++p;
+                }
+            }
+            const std::string_view idText(idBegin, size_t(p - idBegin));
+            if (p == end || *p != '#' || idText.empty() || idText.size() > 8) {
+                return false;
+            }
+            frame.flags = 0;
+            if (idText.size() == 8) {
+                frame.flags |= CanFrame::Extended;
+                if (id & 0x20000000) {
+                    frame.flags |= CanFrame::Error;
+                }
+                id &= 0x1FFFFFFF;
+            }
+            frame.id = id;
+            ++p;
+
+            if (p < end && *p == '#') {
+                // CAN FD: one flags nibble, then the data
+                frame.flags |= CanFrame::FlexibleDataRate;
+                p += 2;
+            } else if (p < end && *p == 'R') {
+                frame.flags |= CanFrame::Remote;
+                frame.size = 0;
+                return true;
+            }
+
+            int count = 0;
+            while (end - p >= 8 && count <= 60 && decodeHex8(p, frame.data + count)) {
+                count += 4;
+                p += 8;
+            }
+            while (end - p >= 2 && count < 64) {
+                const uchar high = hexValue(p[0]);
+                const uchar low = hexValue(p[1]);
+                if ((high | low) > 15) {
+                    break;
+                }
+                frame.data[count++] = uchar(high << 4 | low);
+                p += 2;
+            }
+            frame.size = quint8(count);
+            return true;
+        }
+
+    private:
+        std::array<char, 16> m_interface{};
+        size_t m_interfaceSize = 0;
+        quint8 m_channel = 0;
+};
+
+// ----------------------------------------------------------------------------------------------
+// Vector ASC
+//   base hex  timestamps absolute
+//      0.015991 1  18FEF100x       Rx   d 8 FF FF FF FF FF FF FF FF  Length = 0 BitCount = 0
+//      0.016122 2  123             Tx   r
+//      0.016345 CANFD   1 Rx   18FEF100x  Name  1 0 d 12 FF FF ...
+// Identifiers ending in x are extended. Events other than frames (error frames, statistics,
+// triggers) are skipped.
+class AscParser : public CanLogParser {
+    public:
+        std::unique_ptr<CanLogParser> clone() const override { return std::make_unique<AscParser>(*this); }
+
+        void parseHeader(const char* p, const char* end) override
+        {
+            skipSpaces(p, end);
+            if (startsWith(p, end, "base ")) {
+                p += 5;
+                m_hexIds = token(p, end) != "dec";
+            }
+        }
+
+        bool parseLine(const char* p, const char* end, CanFrame& frame) override
+        {
+            skipSpaces(p, end);
+            if (p == end || *p < '0' || *p > '9') {
+                return false;
+            }
+
+            if (!parseFixed(token(p, end), 6, frame.timestamp)) {
+                return false;
+            }
+            std::string_view field = token(p, end);
+            const bool fd = field == "CANFD";
+            if (fd) {
+                field = token(p, end);
+            }
+            quint32 channel = 0;
+            if (!parseDecimal(field, channel)) {
+                return false;
+            }
+            frame.channel = quint8(channel);
+            frame.flags = 0;
+
+            if (fd) {
+                token(p, end);  // Direction
+            }
+            std::string_view idText = token(p, end);
+            if (!idText.empty() && (idText.back() == 'x' || idText.back() == 'X')) {
+                frame.flags |= CanFrame::Extended;
+                idText.remove_suffix(1);
+            }
+            quint32 id = 0;
+            if (!(m_hexIds ? parseHex(idText, id) : parseDecimal(idText, id))) {
+                return false;   // ErrorFrame, Statistic, SV: and other events
+            }
+            frame.id = id & 0x1FFFFFFF;
+
+            quint32 dlc = 0;
+            if (fd) {
+                // Optional symbolic name, then BRS, ESI, DLC and the data length
+                frame.flags |= CanFrame::FlexibleDataRate;
+                field = token(p, end);
+                quint32 flag = 0;
+                if (!parseDecimal(field, flag)) {
+                    field = token(p, end);
+                }
+                token(p, end);
+                quint32 length = 0;
+                if (!parseHex(token(p, end), dlc) || !parseDecimal(token(p, end), length) || length > 64) {
+                    return false;
+                }
+                return readDataBytes(p, end, int(length), frame);
+            }
+
+            token(p, end);  // Direction
+            field = token(p, end);
+            if (field == "r") {
+                frame.flags |= CanFrame::Remote;
+                frame.size = 0;
+                return true;
+            }
+            if (field != "d" || !parseHex(token(p, end), dlc)) {
+                return false;
+            }
+            return readDataBytes(p, end, std::min(int(dlc), 8), frame);
+        }
+
+    private:
+        bool m_hexIds = true;
+};
+
+// ----------------------------------------------------------------------------------------------
+// PCAN TRC, versions 1.0 to 2.1
+//   ;$FILEVERSION=2.1
+//   ;$COLUMNS=N,O,T,B,I,d,R,L,D
+//         1      1059.900 DT 1 18FEF100 Rx - 8    FF FF FF FF FF FF FF FF
+// Version 2 files list their columns, version 1 files have a fixed layout per minor version.
+// Offsets are milliseconds, identifiers longer than four digits are extended.
+class TrcParser : public CanLogParser {
+    public:
+        TrcParser() { setColumns("N,O,d,I,l,D"); }
+
+        std::unique_ptr<CanLogParser> clone() const override { return std::make_unique<TrcParser>(*this); }
+
+        void parseHeader(const char* p, const char* end) override
+        {
+            skipSpaces(p, end);
+            if (startsWith(p, end, ";$FILEVERSION=")) {
+                const std::string_view version(p + 14, size_t(end - p - 14));
+                if (version.substr(0, 3) == "1.0") {
+                    setColumns("N,O,I,l,D");
+                } else if (version.substr(0, 3) == "1.1") {
+                    setColumns("N,O,d,I,l,D");
+                } else if (version.substr(0, 3) == "1.2") {
+                    setColumns("N,O,B,d,I,l,D");
+                } else if (version.substr(0, 3) == "1.3") {
+                    setColumns("N,O,B,d,I,R,l,D");
+                } else if (version.substr(0, 3) == "2.0") {
+                    setColumns("N,O,T,I,d,l,D");
+                } else {
+                    setColumns("N,O,T,B,I,d,R,L,D");
+                }
+            } else if (startsWith(p, end, ";$COLUMNS=")) {
+                setColumns(std::string_view(p + 10, size_t(end - p - 10)));
+            }
+        }
+
+        bool parseLine(const char* p, const char* end, CanFrame& frame) override
+        {
+            skipSpaces(p, end);
+            if (p == end || *p == ';') {
+                return false;
+            }
+
+            frame.flags = 0;
+            frame.channel = 0;
+            frame.size = 0;
+            quint32 length = 0;
+            bool dataLength = false;
+            bool haveLength = false;
+            for (const char column : std::string_view(m_columns.data(), m_columnCount)) {
+                if (column == 'D') {
+                    if (frame.flags & CanFrame::Remote) {
+                        return true;
+                    }
+                    if (!haveLength) {
+                        return false;
+                    }
+                    const int size = dataLength ? int(length) : dlcToSize(length);
+                    return size <= 64 && readDataBytes(p, end, size, frame);
+                }
+
+                const std::string_view field = token(p, end);
+                if (field.empty()) {
+                    return false;
+                }
+                quint32 value = 0;
+                switch (column) {
+                    case 'O':
+                        if (!parseFixed(field, 3, frame.timestamp)) {
+                            return false;
+                        }
+                        break;
+                    case 'T':
+                        // DT data, FD/FB/FE/BI CAN FD variants, RR remote; ST, EC, ER, EV are not frames
+                        if (field == "RR") {
+                            frame.flags |= CanFrame::Remote;
+                        } else if (field == "FD" || field == "FB" || field == "FE" || field == "BI") {
+                            frame.flags |= CanFrame::FlexibleDataRate;
+                        } else if (field != "DT") {
+                            return false;
+                        }
+                        break;
+                    case 'B':
+                        if (!parseDecimal(field, value)) {
+                            return false;
+                        }
+                        frame.channel = quint8(value);
+                        break;
+                    case 'I':
+                        if (!parseHex(field, value)) {
+                            return false;
+                        }
+                        frame.id = value & 0x1FFFFFFF;
+                        if (field.size() > 4) {
+                            frame.flags |= CanFrame::Extended;
+                        }
+                        break;
+                    case 'd':
+                        // Version 1 logs warnings and errors in the direction column
+                        if (field != "Rx" && field != "Tx") {
+                            return false;
+                        }
+                        break;
+                    case 'l':
+                    case 'L':
+                        if (field == "RTR") {
+                            frame.flags |= CanFrame::Remote;
+                        } else if (!parseDecimal(field, length)) {
+                            return false;
+                        }
+                        dataLength = column == 'l';
+                        haveLength = true;
+                        break;
+                    default:
+                        break;  // Message number, reserved column
+                }
+            }
+            return false;
+        }
+
+    private:
+        std::array<char, 16> m_columns{};
+        size_t m_columnCount = 0;
+
+        void setColumns(std::string_view columns)
+        {
+            m_columnCount = 0;
+            for (char c : columns) {
+                if (c != ',' && !isSpace(c) && m_columnCount < m_columns.size()) {
+                    m_columns[m_columnCount++] = c;
+                }
+            }
+        }
+};
+
+// ----------------------------------------------------------------------------------------------
+// Format table: suffixes, a check on the first bytes for logs with another extension, and the
+// parser to create. New formats are added here.
+struct LogFormat {
+    const char* name;
+    const char* suffixes;       // Space separated, lowercase
+    bool (*probe)(std::string_view head);
+    std::unique_ptr<CanLogParser> (*create)();
+};
+
+const LogFormat Formats[] = {
+    {"candump", "log",
+     [](std::string_view head) {
+         const size_t start = head.find_first_not_of(" \t\r\n");
+         return start != std::string_view::npos && head[start] == '(' && head.find('#') != std::string_view::npos;
+     },
+     []() -> std::unique_ptr<CanLogParser> { return std::make_unique<CandumpParser>(); }},
+    {"Vector ASC", "asc",
+     [](std::string_view head) {
+         return head.find("base hex") != std::string_view::npos || head.find("base dec") != std::string_view::npos;
+     },
+     []() -> std::unique_ptr<CanLogParser> { return std::make_unique<AscParser>(); }},
+    {"PCAN TRC", "trc",
+     [](std::string_view head) {
+         return head.find(";$FILEVERSION") != std::string_view::npos
+                || head.find(";   Start time:") != std::string_view::npos;
+     },
+     []() -> std::unique_ptr<CanLogParser> { return std::make_unique<TrcParser>(); }},
+};
+
+}
+
+// ----------------------------------------------------------------------------------------------
+// CanLogReader
+
+CanLogReader::CanLogReader(std::unique_ptr<CanLogParser> parser)
+    : m_parser(std::move(parser)), m_threads(QThreadPool::globalInstance()->maxThreadCount())
+{
+}
+
+CanLogReader::~CanLogReader()
+{
+    // Tasks still parsing point into the mapping
+    m_pending.waitForFinished();
+    if (m_mapped) {
+        m_file.unmap(m_mapped);
+    }
+}
+
+std::unique_ptr<CanLogReader> CanLogReader::open(const QString& filePath, QString* error)
+{
+    QFile probeFile(filePath);
+    if (!probeFile.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = probeFile.errorString();
+        }
+        return nullptr;
+    }
+    const QByteArray head = probeFile.read(4096);
+    probeFile.close();
+    const std::string_view headView(head.constData(), size_t(head.size()));
+
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    const LogFormat* format = nullptr;
+    for (const LogFormat& candidate : Formats) {
+        if (QString::fromLatin1(candidate.suffixes).split(' ').contains(suffix)) {
+            format = &candidate;
+            break;
+        }
+    }
+    if (!format) {
+        for (const LogFormat& candidate : Formats) {
+            if (candidate.probe(headView)) {
+                format = &candidate;
+                break;
+            }
+        }
+    }
+    if (!format) {
+        if (error) {
+            *error = QStringLiteral("Unknown CAN log format");
+        }
+        return nullptr;
+    }
+
+    std::unique_ptr<CanLogReader> reader(new CanLogReader(format->create()));
+    if (!reader->openFile(filePath)) {
+        if (error) {
+            *error = reader->m_file.errorString();
+        }
+        return nullptr;
+    }
+    return reader;
+}
+
+QString CanLogReader::fileFilter()
+{
+    QStringList patterns;
+    QStringList filters;
+    for (const LogFormat& format : Formats) {
+        QStringList formatPatterns;
+        for (const QString& suffix : QString::fromLatin1(format.suffixes).split(' ')) {
+            formatPatterns << QStringLiteral("*.") + suffix;
+        }
+        patterns << formatPatterns;
+        filters << QStringLiteral("%1 (%2)").arg(QLatin1String(format.name), formatPatterns.join(' '));
+    }
+    return QStringLiteral("CAN Logs (%1);;%2;;All Files (*)").arg(patterns.join(' '), filters.join(QStringLiteral(";;")));
+}
+
+bool CanLogReader::openFile(const QString& filePath)
+{
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    m_fileSize = m_file.size();
+    return moveWindow(0);
+}
+
+bool CanLogReader::moveWindow(qint64 offset)
+{
+    if (m_mapped) {
+        m_file.unmap(m_mapped);
+        m_mapped = nullptr;
+    }
+    const qint64 length = std::min(WindowSize, m_fileSize - offset);
+    m_windowStart = offset;
+    if (length > 0) {
+        m_mapped = m_file.map(offset, length);
+    }
+    if (m_mapped) {
+        m_windowBegin = reinterpret_cast<const char*>(m_mapped);
+    } else {
+        // Pipes and some file systems cannot be mapped, read the window instead
+        m_fallback.resize(std::max<qint64>(length, 0));
+        if (length > 0 && (!m_file.seek(offset) || m_file.read(m_fallback.data(), length) != length)) {
+            qWarning() << "Failed to read CAN log:" << m_file.fileName() << m_file.errorString();
+            m_windowBegin = m_pos = m_end = nullptr;
+            return false;
+        }
+        m_windowBegin = m_fallback.constData();
+    }
+    m_pos = m_windowBegin;
+    m_end = m_windowBegin + std::max<qint64>(length, 0);
+    return true;
+}
+
+qint64 CanLogReader::position() const
+{
+    return m_windowStart + (m_pos - m_windowBegin);
+}
+
+bool CanLogReader::next(CanFrame& frame)
+{
+    // The header is read a line at a time, so each line sees the settings of the ones before,
+    // and so is the whole log with a single thread
+    while (m_inHeader || m_threads < 2) {
+        const char* begin;
+        const char* end;
+        if (!takeLines(1, true, begin, end)) {
+            return false;
+        }
+        end = withoutLineBreak(begin, end);
+        if (m_inHeader) {
+            m_parser->parseHeader(begin, end);
+        }
+        if (m_parser->parseLine(begin, end, frame)) {
+            if (m_inHeader) {
+                m_inHeader = false;
+                if (m_threads >= 2) {
+                    startBatch();
+                }
+            }
+            return true;
+        }
+    }
+
+    for (;;) {
+        while (m_part < m_parts.size()) {
+            const std::vector<CanFrame>& frames = m_parts[m_part].frames;
+            if (m_frame < frames.size()) {
+                frame = frames[m_frame++];
+                return true;
+            }
+            ++m_part;
+            m_frame = 0;
+        }
+
+        // Take over the batch parsed in the background and start on the one after it
+        m_pending.waitForFinished();
+        if (m_pendingParts.empty()) {
+            return false;
+        }
+        std::swap(m_parts, m_pendingParts);
+        m_part = 0;
+        m_frame = 0;
+        startBatch();
+    }
+}
+
+// Whole lines from the current position up to the first line break at least bytes on, fewer
+// where the window ends first. Moves to the next window once this one is used up if mayMove
+// is set, false at the end of the log or of the window.
+bool CanLogReader::takeLines(qint64 bytes, bool mayMove, const char*& begin, const char*& end)
+{
+    for (;;) {
+        const qint64 windowEnd = m_windowStart + (m_end - m_windowBegin);
+        if (m_pos >= m_end) {
+            if (!mayMove || windowEnd >= m_fileSize || !moveWindow(windowEnd)) {
+                return false;
+            }
+            continue;
+        }
+
+        const qint64 skip = std::min<qint64>(bytes, m_end - m_pos) - 1;
+        const char* lineEnd = static_cast<const char*>(std::memchr(m_pos + skip, '\n', size_t(m_end - m_pos - skip)));
+        if (!lineEnd && windowEnd < m_fileSize) {
+            // The last line goes on in the next window, stop before it
+            for (const char* p = m_pos + skip; p-- > m_pos;) {
+                if (*p == '\n') {
+                    lineEnd = p;
+                    break;
+                }
+            }
+            if (!lineEnd) {
+                if (!mayMove) {
+                    return false;
+                }
+                if (m_pos == m_windowBegin) {
+                    // A whole window without a line break is not a log, skip it
+                    m_pos = m_end;
+                } else if (!moveWindow(position())) {
+                    return false;
+                }
+                continue;
+            }
+        }
+
+        begin = m_pos;
+        end = lineEnd ? lineEnd + 1 : m_end;
+        m_pos = end;
+        return true;
+    }
+}
+
+// Hands the lines of the next batch to the thread pool, a part per thread. A batch stays within
+// the window, which is only moved for the next batch once this one is parsed.
+void CanLogReader::startBatch()
+{
+    size_t count = 0;
+    const char* begin;
+    const char* end;
+    while (count < size_t(m_threads) && takeLines(PartSize, count == 0, begin, end)) {
+        if (m_pendingParts.size() <= count) {
+            m_pendingParts.emplace_back();
+        }
+        Part& part = m_pendingParts[count++];
+        part.begin = begin;
+        part.end = end;
+        part.parser = m_parser->clone();
+    }
+    m_pendingParts.resize(count);
+    m_pending = QtConcurrent::map(m_pendingParts, parsePart);
+}
+
+void CanLogReader::parsePart(Part& part)
+{
+    part.frames.clear();
+    CanFrame frame;
+    const char* p = part.begin;
+    while (p < part.end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', size_t(part.end - p)));
+        const char* next = lineEnd ? lineEnd + 1 : part.end;
+        if (part.parser->parseLine(p, withoutLineBreak(p, next), frame)) {
+            part.frames.push_back(frame);
+        }
+        p = next;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------
+// CanLogDecoder
+
+CanLogDecoder::CanLogDecoder(const J1939Dispatch& dispatch)
+    : m_dispatch(dispatch), m_transport(dispatch)
+{
+    m_summary.perTarget.assign(size_t(dispatch.size()), 0);
+    m_summary.perSignal.resize(size_t(dispatch.size()));
+    for (int i = 0; i < dispatch.size(); ++i) {
+        m_summary.perSignal[size_t(i)].resize(size_t(dispatch.target(i).decoder.signalCount()));
+    }
+    m_transport.setCompletedCallback([this](const J1939TransportReassembler::Completed& completed) {
+        ++m_summary.transportPayloads;
+        if (!completed.target) {
+            return;
+        }
+        // Hand the payload on as one frame with the identifier the PGN would be sent with
+        CanFrame frame;
+        const quint32 pduSpecific = ((completed.pgn >> 8) & 0xFF) < 240 ? completed.destination
+                                                                         : (completed.pgn & 0xFF);
+        frame.id = quint32(completed.priority) << 26 | (completed.pgn & 0x3FF00) << 8 | pduSpecific << 8
+                   | completed.source;
+        frame.flags = CanFrame::Extended;
+        frame.timestamp = m_transportTimestamp;
+        frame.channel = m_transportChannel;
+        frame.size = 0;
+        decoded(frame, completed.target, completed.values, completed.data, completed.size);
+    });
+}
+
+void CanLogDecoder::setFrameCallback(const FrameCallback& callback)
+{
+    m_callback = callback;
+}
+
+bool CanLogDecoder::run(CanLogReader& reader, const DbcDataModel::ProgressCallback& progress)
+{
+    const qint64 progressStep = std::max<qint64>(reader.size() / 100, 1);
+    qint64 nextProgress = 0;
+    CanFrame frame;
+    while (reader.next(frame)) {
+        ++m_summary.frames;
+        if (progress && reader.position() >= nextProgress) {
+            if (!progress(int(reader.position() * 100 / std::max<qint64>(reader.size(), 1)))) {
+                return false;
+            }
+            nextProgress = reader.position() + progressStep;
+        }
+        if (frame.flags & (CanFrame::Remote | CanFrame::Error)) {
+            continue;
+        }
+
+        const bool extended = frame.flags & CanFrame::Extended;
+        if (extended) {
+            m_transportTimestamp = frame.timestamp;
+            m_transportChannel = frame.channel;
+            if (m_transport.processFrame(frame.id, frame.data, frame.size, frame.timestamp)) {
+                continue;
+            }
+        }
+
+        const J1939Dispatch::Target* target = m_dispatch.route(frame.id, extended);
+        if (!target) {
+            ++m_summary.unknown;
+            continue;
+        }
+        if (m_values.size() < size_t(target->decoder.signalCount())) {
+            m_values.resize(size_t(target->decoder.signalCount()));
+        }
+        target->decoder.decode(frame.data, frame.size, m_values.data());
+        decoded(frame, target, m_values.data(), frame.data, frame.size);
+    }
+    return true;
+}
+
+void CanLogDecoder::decoded(const CanFrame& frame, const J1939Dispatch::Target* target, const double* values,
+                            const uchar* data, int size)
+{
+    ++m_summary.decoded;
+    const size_t index = size_t(m_dispatch.indexOf(target));
+    ++m_summary.perTarget[index];
+
+    std::vector<SignalStatistics>& statistics = m_summary.perSignal[index];
+    // Multiplex values are raw, the multiplexer's physical value may be scaled
+    const quint64 selected = target->multiplexer >= 0 ? target->decoder.raw(data, size, target->multiplexer) : 0;
+    for (size_t i = 0; i < statistics.size(); ++i) {
+        const double value = values[i];
+        const int multiplexValue = target->multiplexValues[i];
+        if (std::isnan(value) || (multiplexValue >= 0 && target->multiplexer >= 0 && quint64(multiplexValue) != selected)) {
+            continue;
+        }
+        SignalStatistics& signal = statistics[i];
+        if (signal.count == 0) {
+            signal.min = signal.max = value;
+        } else {
+            signal.min = std::min(signal.min, value);
+            signal.max = std::max(signal.max, value);
+        }
+        signal.last = value;
+        ++signal.count;
+    }
+    if (m_callback) {
+        m_callback(frame, target, values, data, size);
+    }
+}
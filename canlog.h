@@ -0,0 +1,163 @@
+#ifndef CANLOG_H
+#define CANLOG_H
+
+#include <QFile>
+#include <QFuture>
+#include <QString>
+#include <QByteArray>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "dbcdata.h"
+#include "j1939.h"
+#include "j1939tp.h"
+
+// One frame of a CAN capture, the same size whatever the log format
+struct CanFrame {
+    enum Flag : quint8 {
+        Extended = 1,
+        Remote = 2,
+        FlexibleDataRate = 4,
+        Error = 8
+    };
+
+    qint64 timestamp = 0;       // Microseconds, as the log counts them (absolute or from the start)
+    quint32 id = 0;
+    quint8 flags = 0;
+    quint8 size = 0;            // Payload bytes
+    quint8 channel = 0;
+    quint8 reserved = 0;
+    uchar data[64];
+};
+
+// Parses the lines of one log format. Past the header a log is parsed in parts on several
+// threads, each part by its own copy of the parser, so parsers keep their state in members
+// that copy.
+class CanLogParser {
+    public:
+        virtual ~CanLogParser() = default;
+
+        virtual std::unique_ptr<CanLogParser> clone() const = 0;
+
+        // Reads settings such as the number base or the column layout from a line. Only lines
+        // before the first frame come here, the formats write their header at the top.
+        virtual void parseHeader(const char* begin, const char* end) { Q_UNUSED(begin); Q_UNUSED(end); }
+
+        // Parses one line without its line break, returns false for lines that hold no frame
+        virtual bool parseLine(const char* begin, const char* end, CanFrame& frame) = 0;
+};
+
+// Sequential reader over a CAN log. The file is mapped a window at a time, so only the part
+// being parsed is resident however large the capture is, and lines are parsed in place. Past
+// the header, lines are parsed in parts on the global thread pool one batch ahead of next(),
+// so reading scales with the cores while the caller works through the frames.
+// Formats plug in by deriving from CanLogParser and adding an entry to the format table in
+// canlog.cpp; candump -L, Vector ASC and PCAN TRC are built in.
+class CanLogReader {
+    public:
+        ~CanLogReader();
+
+        // Opens a log, choosing the format by extension and otherwise by the first lines.
+        // Returns nullptr with error set if the file cannot be read or the format is unknown.
+        static std::unique_ptr<CanLogReader> open(const QString& filePath, QString* error = nullptr);
+
+        // File filter for the supported formats, for file dialogs
+        static QString fileFilter();
+
+        // Reads the next frame, false at the end of the log
+        bool next(CanFrame& frame);
+
+        // Bytes of the file parsed so far, which may run a batch ahead of next()
+        qint64 position() const;
+        qint64 size() const { return m_fileSize; }
+
+    private:
+        // Lines parsed by one task, and the frames found in them
+        struct Part {
+            const char* begin = nullptr;
+            const char* end = nullptr;
+            std::unique_ptr<CanLogParser> parser;
+            std::vector<CanFrame> frames;
+        };
+
+        explicit CanLogReader(std::unique_ptr<CanLogParser> parser);
+
+        std::unique_ptr<CanLogParser> m_parser;
+        int m_threads = 1;
+        bool m_inHeader = true;         // No frame read yet
+
+        QFile m_file;
+        qint64 m_fileSize = 0;
+        qint64 m_windowStart = 0;
+        uchar* m_mapped = nullptr;
+        QByteArray m_fallback;          // Window contents when the file cannot be mapped
+        const char* m_windowBegin = nullptr;
+        const char* m_pos = nullptr;
+        const char* m_end = nullptr;
+
+        std::vector<Part> m_parts;      // Batch next() reads from
+        size_t m_part = 0;
+        size_t m_frame = 0;
+        std::vector<Part> m_pendingParts;
+        QFuture<void> m_pending;        // Parses m_pendingParts
+
+        bool openFile(const QString& filePath);
+        bool moveWindow(qint64 offset);
+        bool takeLines(qint64 bytes, bool mayMove, const char*& begin, const char*& end);
+        void startBatch();
+        static void parsePart(Part& part);
+};
+
+// Decodes every frame of a log with the messages of a dispatch table. J1939 transport
+// sessions are reassembled on the way and their payloads decoded like single frames.
+class CanLogDecoder {
+    public:
+        // Physical values one signal decoded to. Multiplexed signals only count the frames
+        // their multiplexer selects them in.
+        struct SignalStatistics {
+            qint64 count = 0;
+            double min = 0;
+            double max = 0;
+            double last = 0;
+        };
+
+        struct Summary {
+            qint64 frames = 0;
+            qint64 decoded = 0;             // Frames and transport payloads matched to a message
+            qint64 transportPayloads = 0;
+            qint64 unknown = 0;             // Frames no loaded message matches
+            std::vector<qint64> perTarget;  // Decoded count per dispatch target
+            std::vector<std::vector<SignalStatistics>> perSignal;   // Per dispatch target and signal
+        };
+
+        // Receives every decoded frame. Transport payloads come with the identifier of their PGN
+        // and the timestamp of the last packet, and their data only through data and size.
+        // values holds one entry per signal of the target message; pointers are only valid
+        // during the call.
+        using FrameCallback = std::function<void(const CanFrame& frame, const J1939Dispatch::Target* target,
+                                                 const double* values, const uchar* data, int size)>;
+
+        // The dispatch table must outlive the decoder
+        explicit CanLogDecoder(const J1939Dispatch& dispatch);
+
+        void setFrameCallback(const FrameCallback& callback);
+
+        // Reads the whole log, returns false if canceled through progress
+        bool run(CanLogReader& reader, const DbcDataModel::ProgressCallback& progress = DbcDataModel::ProgressCallback());
+
+        const Summary& summary() const { return m_summary; }
+
+    private:
+        const J1939Dispatch& m_dispatch;
+        J1939TransportReassembler m_transport;
+        FrameCallback m_callback;
+        Summary m_summary;
+        std::vector<double> m_values;
+        qint64 m_transportTimestamp = 0;    // Of the frame being fed to m_transport
+        quint8 m_transportChannel = 0;
+
+        void decoded(const CanFrame& frame, const J1939Dispatch::Target* target, const double* values,
+                     const uchar* data, int size);
+};
+
+#endif // CANLOG_H
@@ -0,0 +1,119 @@
+#include "dbccache.h"
+#include "dbcsnapshot.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+
+namespace {
+
+// Bump when the meaning of a cached model changes without the snapshot format changing,
+// e.g. after a fix to importDBC
+constexpr int CacheVersion = 8;
+
+}
+
+DbcImportCache::DbcImportCache(const QString& dbcPath)
+{
+    const QFileInfo info(dbcPath);
+    m_path = info.absoluteFilePath();
+    m_modified = info.lastModified().toMSecsSinceEpoch();
+    m_size = info.size();
+
+    // One entry per path, named after a hash of it so any path makes a valid file name
+    const QString directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/dbc";
+    const QByteArray pathHash = QCryptographicHash::hash(m_path.toUtf8(), QCryptographicHash::Sha1).toHex();
+    m_entryPath = directory + "/" + QString::fromLatin1(pathHash);
+}
+
+bool DbcImportCache::load(DbcDataModel& model)
+{
+    QFile keyFile(m_entryPath + ".key");
+    if (!keyFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray storedKey = keyFile.readAll();
+    keyFile.close();
+
+    // The contents are only read when the modification time and size leave them in question
+    if (!storedKey.startsWith(fileKeyText())) {
+        remove();
+        return false;
+    }
+    if (!hashContents()) {
+        return false;
+    }
+    if (storedKey != keyText()) {
+        // The DBC changed since the entry was written
+        remove();
+        return false;
+    }
+
+    QList<DbcDataModel*> models;
+    if (!DbcSnapshot::load(m_entryPath + "." + DbcSnapshot::Suffix, models) || models.size() != 1) {
+        qDeleteAll(models);
+        remove();
+        return false;
+    }
+
+    // Keep the name the caller gave the model, the cached one comes from the same path
+    const QString fileName = model.fileName();
+    model = std::move(*models.first());
+    model.setFileName(fileName);
+    delete models.first();
+    return true;
+}
+
+void DbcImportCache::store(DbcDataModel& model)
+{
+    if (!hashContents() || !QDir().mkpath(QFileInfo(m_entryPath).absolutePath())) {
+        return;
+    }
+
+    // The key is written last, so an entry without a matching key is never used
+    if (!DbcSnapshot::save(m_entryPath + "." + DbcSnapshot::Suffix, QList<DbcDataModel*>() << &model)) {
+        remove();
+        return;
+    }
+    QSaveFile keyFile(m_entryPath + ".key");
+    if (!keyFile.open(QIODevice::WriteOnly) || keyFile.write(keyText()) < 0 || !keyFile.commit()) {
+        qWarning() << "Could not write import cache entry for" << m_path;
+        remove();
+    }
+}
+
+// Hashes the DBC once, false if it cannot be read
+bool DbcImportCache::hashContents()
+{
+    if (m_hash.isEmpty()) {
+        QFile file(m_path);
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        if (file.open(QIODevice::ReadOnly) && hash.addData(&file)) {
+            m_hash = hash.result().toHex();
+        }
+    }
+    return !m_hash.isEmpty();
+}
+
+// The part of the key known without reading the DBC
+QByteArray DbcImportCache::fileKeyText() const
+{
+    return QString("%1\n%2\n%3\n%4\n")
+        .arg(QString::number(CacheVersion), m_path, QString::number(m_modified), QString::number(m_size))
+        .toUtf8();
+}
+
+QByteArray DbcImportCache::keyText() const
+{
+    return fileKeyText() + m_hash + "\n";
+}
+
+void DbcImportCache::remove()
+{
+    QFile::remove(m_entryPath + ".key");
+    QFile::remove(m_entryPath + "." + DbcSnapshot::Suffix);
+}
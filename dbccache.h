@@ -0,0 +1,36 @@
+#ifndef DBCCACHE_H
+#define DBCCACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include "dbcdata.h"
+
+// Parsed DBC files kept as binary snapshots in the user's cache directory. An entry belongs to
+// one DBC path and is only used while the file's modification time, size and content hash
+// still match, so editing the DBC invalidates it. The contents are only hashed once the
+// cheaper fields match an entry, or when an entry is stored.
+class DbcImportCache {
+    public:
+        // Reads the modification time and size of the DBC file
+        explicit DbcImportCache(const QString& dbcPath);
+
+        // Fills model from the cache entry, false if there is none for the current contents
+        bool load(DbcDataModel& model);
+
+        // Stores model as the entry for the file the constructor looked at
+        void store(DbcDataModel& model);
+
+    private:
+        QString m_path;             // Absolute DBC path
+        qint64 m_modified = 0;      // Milliseconds since the epoch
+        qint64 m_size = -1;
+        QByteArray m_hash;          // Hex SHA-1 of the contents, empty until hashed or if unreadable
+        QString m_entryPath;        // Cache file without extension
+
+        bool hashContents();
+        QByteArray fileKeyText() const;
+        QByteArray keyText() const;
+        void remove();
+};
+
+#endif // DBCCACHE_H
@@ -1,11 +1,268 @@
 #include "dbcdata.h"
+#include "jsonreader.h"
+#include "j1939.h"
 #include <QFile>
-#include <QJsonDocument>
-#include <QJsonValue>
+#include <QSaveFile>
+#include <QSet>
 #include <QDebug>
 #include <qfileinfo.h>
-#include <QTextStream>
-#include <QRegularExpression>
+#include <QHash>
+#include <algorithm>
+#include <charconv>
+#include <functional>
+#include <string_view>
+
+namespace {
+
+// Forward-only cursor over raw DBC text. Tokens are handed out as views into the
+// source buffer, so nothing is allocated until a value is stored in the model.
+class DbcTokenizer {
+    public:
+        DbcTokenizer(const char* begin, const char* end) : m_pos(begin), m_end(end) {}
+
+        bool atEnd() const { return m_pos >= m_end; }
+
+        const char* position() const { return m_pos; }
+
+        // True if the current line starts with whitespace (e.g. SG_ lines, NS_ symbol list)
+        bool lineIndented() const { return m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t'); }
+
+        // Skip spaces and tabs, but never past the end of the line
+        void skipSpaces() {
+            while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\r')) {
+                ++m_pos;
+            }
+        }
+
+        bool atLineEnd() {
+            skipSpaces();
+            return m_pos >= m_end || *m_pos == '\n';
+        }
+
+        char peek() {
+            skipSpaces();
+            return m_pos < m_end ? *m_pos : '\0';
+        }
+
+        char get() {
+            skipSpaces();
+            return m_pos < m_end ? *m_pos++ : '\0';
+        }
+
+        // Consume c if it is the next non-blank character on the line
+        bool accept(char c) {
+            if (peek() != c) {
+                return false;
+            }
+            ++m_pos;
+            return true;
+        }
+
+        // Identifier or bare word: [A-Za-z0-9_]+
+        std::string_view word() {
+            skipSpaces();
+            const char* start = m_pos;
+            while (m_pos < m_end && isWordChar(*m_pos)) {
+                ++m_pos;
+            }
+            return std::string_view(start, m_pos - start);
+        }
+
+        // Numeric literal including sign, decimal point and exponent
+        std::string_view number() {
+            skipSpaces();
+            const char* start = m_pos;
+            while (m_pos < m_end && isNumberChar(*m_pos)) {
+                ++m_pos;
+            }
+            return std::string_view(start, m_pos - start);
+        }
+
+        // Double-quoted string without the quotes. May span several lines (CM_ comments)
+        bool quoted(std::string_view& out) {
+            if (peek() != '"') {
+                return false;
+            }
+            const char* start = ++m_pos;
+            skipQuoted();
+            out = std::string_view(start, m_pos - start);
+            if (m_pos < m_end) {
+                ++m_pos; // Closing quote
+            }
+            return true;
+        }
+
+        // Attribute value: either a quoted string or a bare number/enumerator
+        std::string_view value() {
+            std::string_view out;
+            if (quoted(out)) {
+                return out;
+            }
+            if (peek() == '-' || peek() == '+' || peek() == '.') {
+                return number();
+            }
+            std::string_view bare = number();
+            return bare.empty() ? word() : bare;
+        }
+
+        // Rest of the statement up to its terminating ';' or the end of the line
+        std::string_view restOfStatement() {
+            skipSpaces();
+            const char* start = m_pos;
+            while (m_pos < m_end && *m_pos != ';' && *m_pos != '\n') {
+                if (*m_pos == '"') {
+                    ++m_pos;
+                    skipQuoted();
+                }
+                if (m_pos < m_end) {
+                    ++m_pos;
+                }
+            }
+            return std::string_view(start, m_pos - start);
+        }
+
+        // Move to the start of the next line, stepping over quoted strings that span lines
+        void skipLine() {
+            while (m_pos < m_end && *m_pos != '\n') {
+                if (*m_pos == '"') {
+                    ++m_pos;
+                    skipQuoted();
+                }
+                if (m_pos < m_end) {
+                    ++m_pos;
+                }
+            }
+            if (m_pos < m_end) {
+                ++m_pos;
+            }
+        }
+
+    private:
+        const char* m_pos;
+        const char* m_end;
+
+        static bool isWordChar(char c) {
+            return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+        }
+
+        static bool isNumberChar(char c) {
+            return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+        }
+
+        // Leaves m_pos on the closing quote (or at the end of the buffer)
+        void skipQuoted() {
+            while (m_pos < m_end && *m_pos != '"') {
+                if (*m_pos == '\\' && m_pos + 1 < m_end) {
+                    ++m_pos;
+                }
+                ++m_pos;
+            }
+        }
+};
+
+QString toQString(std::string_view text)
+{
+    return QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()));
+}
+
+// Quoted DBC text with its \" escapes removed
+QString toUnescapedQString(std::string_view text)
+{
+    QString result = toQString(text);
+    if (result.contains(QLatin1Char('\\'))) {
+        result.replace(QLatin1String("\\\""), QLatin1String("\""));
+    }
+    return result;
+}
+
+// Non-owning key into the source buffer, used for lookups that must not allocate
+QByteArray rawKey(std::string_view text)
+{
+    return QByteArray::fromRawData(text.data(), static_cast<qsizetype>(text.size()));
+}
+
+// BA_DEF_ statement, kept as views into the source until attributes are resolved
+struct AttributeDefinition {
+    std::string_view objectType;  // BU_, BO_, SG_, EV_ or empty for network attributes
+    std::string_view name;
+    std::string_view valueType;   // INT, HEX, FLOAT, STRING or ENUM
+    std::string_view range;       // Min and max, or the ENUM labels; empty for STRING
+};
+
+// BA_ statement, kept as views into the source until attributes are resolved
+struct AttributeAssignment {
+    std::string_view name;
+    std::string_view objectType;  // Same as AttributeDefinition::objectType
+    quint64 messageId = 0;        // BO_ and SG_ targets
+    std::string_view target;      // Node name for BU_, signal name for SG_
+    std::string_view value;
+};
+
+// CM_ statement, attached to its message or signal once parsing is done
+struct CommentEntry {
+    std::string_view objectType;  // BU_, BO_, SG_, EV_ or empty for the network
+    quint64 messageId = 0;
+    std::string_view target;      // Signal, node or environment variable name
+    std::string_view text;
+};
+
+// VAL_ statement for a signal; entries holds the raw "value \"label\"" pairs
+struct ValueTableEntry {
+    quint64 messageId = 0;
+    std::string_view signal;
+    std::string_view entries;
+};
+
+// Attributes every object of one type starts with, and the slot of each attribute by name
+struct AttributeDefaults {
+    QList<Attribute> attributes;
+    QHash<QByteArray, int> positions;
+};
+
+template <typename T>
+bool parseInteger(std::string_view text, T& out)
+{
+    if (!text.empty() && text.front() == '+') {
+        text.remove_prefix(1);
+    }
+    auto result = std::from_chars(text.data(), text.data() + text.size(), out);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+bool parseDouble(std::string_view text, double& out)
+{
+    if (!text.empty() && text.front() == '+') {
+        text.remove_prefix(1);
+    }
+    auto result = std::from_chars(text.data(), text.data() + text.size(), out);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// Overwrite one attribute of an object that was initialised from defaults
+void assignAttribute(QList<Attribute>& attributes, const AttributeDefaults& defaults,
+                     std::string_view name, std::string_view value)
+{
+    int position = defaults.positions.value(rawKey(name), -1);
+    if (position < 0) {
+        // Not declared by BA_DEF_, look through the extras assigned so far
+        const QString attributeName = toQString(name);
+        for (int i = defaults.attributes.size(); i < attributes.size(); ++i) {
+            if (attributes.at(i).name == attributeName) {
+                position = i;
+                break;
+            }
+        }
+        if (position < 0) {
+            Attribute attribute;
+            attribute.name = attributeName;
+            attributes.append(attribute);
+            position = attributes.size() - 1;
+        }
+    }
+    attributes[position].value = toUnescapedQString(value).trimmed();
+}
+
+} // namespace
 
 DbcDataModel::DbcDataModel() {
     // Constructor
@@ -22,135 +279,116 @@ QString DbcDataModel::fileName() const
 }
 
 
-bool DbcDataModel::importDBC(const QString& filePath) {
+bool DbcDataModel::importDBC(const QString& filePath, const ProgressCallback& progress) {
 
     QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!file.open(QIODevice::ReadOnly)) {
         qWarning() << "Couldn't open DBC file:" << filePath;
         return false;
     }
 
-    QTextStream in(&file);
-    QString line;
+    // Map the file and parse it in place. Owned strings are only created for
+    // values that end up in the model.
+    const qint64 fileSize = file.size();
+    uchar* mapped = fileSize > 0 ? file.map(0, fileSize) : nullptr;
+    QByteArray fallback;
+    if (!mapped) {
+        // Some devices cannot be mapped; read the bytes instead
+        fallback = file.readAll();
+    }
+    const char* begin = mapped ? reinterpret_cast<const char*>(mapped) : fallback.constData();
+    const char* end = begin + (mapped ? fileSize : fallback.size());
 
-    QMap<QString, Attribute> defaultMessageAttributes; // To store default attributes for messages
-    QMap<QString, Attribute> defaultSignalAttributes;  // To store default attributes for signals
-    QMap<QString, Attribute> defaultNodeAttributes;    // To store default attributes for nodes
+    // Attribute statements are collected during the scan and resolved in one pass at the end
+    QList<AttributeDefinition> attributeDefinitions;
+    QHash<QByteArray, std::string_view> attributeDefaultValues;
+    QList<AttributeAssignment> attributeAssignments;
 
-    QRegularExpression reNode("^BU_:\\s*(.*)");
-    QRegularExpression reMessage("^BO_\\s+(\\d+)\\s+(\\w+):\\s+(\\d+)\\s+(\\w+)");
-    QRegularExpression reSignal(
-        "^\\s*SG_\\s+(\\w+)\\s*(?:([mM]\\d*[mM]?)\\s*)?:\\s*" // Signal name and optional multiplexer indicator
-        "(\\d+)\\|(\\d+)@(\\d+)([+-])\\s+"                    // Start bit, length, byte order, sign
-        "\\(([^,]+),([^\\)]+)\\)\\s+"                         // Factor and offset
-        "\\[([^\\|]+)\\|([^\\]]+)\\]\\s+"                     // Min and max
-        "\"([^\"]*)\"\\s*"                                    // Unit
-        "(.*)"                                                // Receivers
-        );
-    QRegularExpression reAttributeDef("^BA_DEF_\\s+(\\w+)\\s+\"([^\"]+)\"\\s+(\\w+)");
-    QRegularExpression reAttributeDefDef("^BA_DEF_DEF_\\s+\"([^\"]+)\"\\s+\"?([^\"]+)\"?");
-    QRegularExpression reAttributeAssignment("^BA_\\s+\"([^\"]+)\"\\s+(\\w+)\\s+(\\w+)\\s+\"?([^\"]+)\"?");
+    // Comments and value tables are batched the same way
+    QList<CommentEntry> comments;
+    QList<ValueTableEntry> valueTables;
 
     // Set network name to file name
     Network network;
     network.name = QFileInfo(filePath).fileName();
     network.baud = ""; // Set baud rate
     m_networks.append(network);
-
-    // Map to keep track of nodes indices by name
-    QMap<QString, int> nodeMap;
-
-    while (!in.atEnd()) {
-        line = in.readLine();
-
-        // Parse nodes
-        QRegularExpressionMatch match = reNode.match(line);
-        if (match.hasMatch()) {
-            QStringList nodes = match.captured(1).split(' ', Qt::SkipEmptyParts);
-            for (const QString& nodeName : nodes) {
-                Node node;
-                node.name = nodeName.trimmed();
-
-                // Update Node-Network Association
-                NodeNetworkAssociation nodeNetworkAssociation;
-                nodeNetworkAssociation.networkName = network.name;
-                nodeNetworkAssociation.sourceAddress = 0; // TODO: Source address parsing
-                node.networks.append(nodeNetworkAssociation);
-
-                m_nodes.append(node);
-                nodeMap.insert(node.name, m_nodes.size() - 1);
+    const int networkIndex = m_networks.size() - 1;
+
+    // Map to keep track of nodes indices by name, keyed by views into the file
+    QHash<QByteArray, int> nodeMap;
+
+    // (message index, signal name) -> index into that message's signals, valid until sorting
+    QHash<std::pair<int, QByteArray>, int> signalMap;
+
+    // Single pass over the file: each statement is dispatched on its leading keyword
+    DbcTokenizer tok(begin, end);
+    const qint64 progressStep = std::max<qint64>((end - begin) / 100, 1);
+    const char* nextProgress = begin;
+    while (!tok.atEnd()) {
+        // Report about once per percent of the file, the scan covers the first 90%
+        if (progress && tok.position() >= nextProgress) {
+            if (!progress(static_cast<int>((tok.position() - begin) * 90 / (end - begin)))) {
+                qWarning() << "DBC import canceled:" << filePath;
+                return false;
             }
-            continue;
+            nextProgress = tok.position() + progressStep;
         }
 
-        // Parse messages
-        match = reMessage.match(line);
-        if (match.hasMatch()) {
-            Message message;
-            message.pgn = match.captured(1).toULongLong();
-            message.name = match.captured(2).trimmed();
-            message.length = match.captured(3).toInt();
-            QString transmitter = match.captured(4).trimmed();
-            message.priority = 0; // Initialize priority
-
-            // Add to Node-Network Association
-            if (!nodeMap.contains(transmitter)) {
-                qWarning() << "Transmitter node not found: " << transmitter << ". Creating new node.";
-                Node newNode;
-                newNode.name = transmitter;
-
-                // Update Node-Network Association
-                NodeNetworkAssociation nodeNetworkAssociation;
-                nodeNetworkAssociation.networkName = network.name;
-                nodeNetworkAssociation.sourceAddress = 0; // TODO: Source address parsing
-                newNode.networks.append(nodeNetworkAssociation);
-
-                m_nodes.append(newNode);
-                nodeMap.insert(transmitter, m_nodes.size() - 1);
-            }
+        const bool indented = tok.lineIndented();
+        const std::string_view keyword = tok.word();
 
-            Node& transmitterNode = m_nodes[nodeMap[transmitter]];
-            for (NodeNetworkAssociation& networkAssociation : transmitterNode.networks) {
-                if (networkAssociation.networkName == network.name) {
-                    // Check if the message already exists in the tx list
-                    bool messageExistsInTx = false;
-                    for (const TxRxMessage& txMsg : networkAssociation.tx) {
-                        if (txMsg.name == message.name) {
-                            messageExistsInTx = true;
-                            break;
-                        }
-                    }
-                    if (!messageExistsInTx) {
-                        TxRxMessage txRxMessage;
-                        txRxMessage.name = message.name;
-                        networkAssociation.tx.append(txRxMessage);
-                    }
-                }
+        // Parse signals
+        if (keyword == "SG_") {
+            if (m_messages.isEmpty()) {
+                qWarning() << "Signal defined before any message, skipping";
+                tok.skipLine();
+                continue;
             }
 
-            m_messages.append(message);
-            continue;
-        }
-
-        // Parse signals
-        match = reSignal.match(line);
-        if (match.hasMatch()) {
             Signal signal;
-            signal.name = match.captured(1).trimmed();
-            QString multiplexerIndicator = match.captured(2).trimmed(); // Optional multiplexer indicator
+            signal.spn = 0; // Set from the SPN attribute once attributes are resolved
+            const std::string_view signalName = tok.word();
+            signal.name = toQString(signalName);
+            std::string_view multiplexerToken;
+            if (!tok.accept(':')) {
+                multiplexerToken = tok.word(); // Optional multiplexer indicator
+                tok.accept(':');
+            }
+            QString multiplexerIndicator = toQString(multiplexerToken);
             signal.isMultiplexer = false; // Default value
             signal.multiplexValue = -1; // Default value
-            signal.startBit = match.captured(3).toInt();
-            signal.bitLength = match.captured(4).toInt();
-            signal.isBigEndian = (match.captured(5).toInt() == 1);
-            signal.isTwosComplement = (match.captured(6) == "-");
-            signal.factor = match.captured(7).toDouble();
-            signal.offset = match.captured(8).toDouble();
-            signal.scaledMin = match.captured(9).toDouble();
-            signal.scaledMax = match.captured(10).toDouble();
-            signal.units = match.captured(11).trimmed();
-            QString receivers = match.captured(12).trimmed();
-            QStringList receiverNames = receivers.split(',', Qt::SkipEmptyParts);
+
+            // Start bit, length, byte order, sign
+            bool ok = parseInteger(tok.number(), signal.startBit) && tok.accept('|');
+            ok = ok && parseInteger(tok.number(), signal.bitLength) && tok.accept('@');
+            const char byteOrder = tok.get();
+            const char sign = tok.get();
+            signal.isBigEndian = (byteOrder == '0'); // @0 is Motorola, @1 Intel
+            signal.isTwosComplement = (sign == '-');
+
+            // Factor and offset
+            ok = ok && tok.accept('(') && parseDouble(tok.number(), signal.factor) && tok.accept(',');
+            ok = ok && parseDouble(tok.number(), signal.offset) && tok.accept(')');
+
+            // Min and max
+            double minimum = 0.0;
+            double maximum = 0.0;
+            ok = ok && tok.accept('[') && parseDouble(tok.number(), minimum) && tok.accept('|');
+            ok = ok && parseDouble(tok.number(), maximum) && tok.accept(']');
+
+            // Unit
+            std::string_view units;
+            ok = ok && tok.quoted(units);
+
+            if (!ok) {
+                qWarning() << "Malformed signal definition:" << signal.name;
+                tok.skipLine();
+                continue;
+            }
+            signal.scaledMin = minimum;
+            signal.scaledMax = maximum;
+            signal.units = toUnescapedQString(units).trimmed();
 
             // Determine if the signal is a multiplexer or multiplexed signal
             if (!multiplexerIndicator.isEmpty()) {
@@ -182,18 +420,22 @@ bool DbcDataModel::importDBC(const QString& filePath) {
             }
 
             // Parse all receiver names
-            for (const QString& receiverName : receiverNames) {
-                QString trimmedReceiverName = receiverName.trimmed();
-                if (trimmedReceiverName.isEmpty()) {
-                    qWarning() << "Receiver Names Empty";
+            while (!tok.atLineEnd()) {
+                if (tok.accept(',')) {
                     continue;
                 }
+                const std::string_view receiverToken = tok.word();
+                if (receiverToken.empty()) {
+                    qWarning() << "Unexpected character in receiver list of signal" << signal.name;
+                    break;
+                }
+                const QByteArray receiverKey = rawKey(receiverToken);
                 // Add to Node-Network Association
-                if (!nodeMap.contains(trimmedReceiverName)) {
-                    qWarning() << "Receiver node not found: " << trimmedReceiverName;
+                if (!nodeMap.contains(receiverKey)) {
                     // Create a new node and add it to m_nodes and nodeMap
                     Node node;
-                    node.name = trimmedReceiverName;
+                    node.name = toQString(receiverToken);
+                    qWarning() << "Receiver node not found: " << node.name;
 
                     NodeNetworkAssociation nodeNetworkAssociation;
                     nodeNetworkAssociation.networkName = network.name;
@@ -201,9 +443,9 @@ bool DbcDataModel::importDBC(const QString& filePath) {
                     node.networks.append(nodeNetworkAssociation);
 
                     m_nodes.append(node);
-                    nodeMap.insert(node.name, m_nodes.size() - 1);
+                    nodeMap.insert(receiverKey, m_nodes.size() - 1);
                 }
-                Node& receiverNode = m_nodes[nodeMap[trimmedReceiverName]];
+                Node& receiverNode = m_nodes[nodeMap.value(receiverKey)];
                 for (NodeNetworkAssociation& networkAssociation : receiverNode.networks) {
                     if (networkAssociation.networkName == network.name) {
                         // Check if the message already exists in the rx list
@@ -224,176 +466,340 @@ bool DbcDataModel::importDBC(const QString& filePath) {
             }
 
             m_messages.last().messageSignals.append(signal);
+            signalMap.insert({m_messages.size() - 1, rawKey(signalName)}, m_messages.last().messageSignals.size() - 1);
+            tok.skipLine();
             continue;
         }
 
-        // Parse attribute definitions (BA_DEF_)
-        match = reAttributeDef.match(line);
-        if (match.hasMatch()) {
-            QString attributeType = match.captured(1).trimmed(); // Object type (BO_, SG_, etc.)
-            QString attributeName = match.captured(2).trimmed();
-            QString attributeValueType = match.captured(3).trimmed(); // Value type (STRING, INT, etc.)
-
-            // Handle attribute definition based on its type (BO_ for messages, SG_ for signals)
-            if (attributeType == "BO_") {
-                // Define attribute for all messages
-                defaultMessageAttributes.insert(attributeName, {attributeName, ""});
-            } else if (attributeType == "SG_") {
-                // Define attribute for all signals
-                defaultSignalAttributes.insert(attributeName, {attributeName, ""});
-            } else if (attributeType == "BU_") {
-                // Define attribute for all nodes
-                defaultNodeAttributes.insert(attributeName, {attributeName, ""});
-            }
+        // Only signals are indented; anything else indented is a symbol list (NS_) or a continuation
+        if (indented) {
+            tok.skipLine();
             continue;
         }
 
-        // Parse default attribute values (BA_DEF_DEF_)
-        match = reAttributeDefDef.match(line);
-        if (match.hasMatch()) {
-            QString attributeName = match.captured(1).trimmed();
-            QString defaultValue = match.captured(2).trimmed();
-
-            // Assign default value to the appropriate type
-            if (defaultMessageAttributes.contains(attributeName)) {
-                defaultMessageAttributes[attributeName].value = defaultValue;
-
-                // Add default attribute to message attributes
-                for (auto& message : m_messages) {
-                    message.messageAttributes.append(defaultMessageAttributes[attributeName]);
+        // Parse nodes
+        if (keyword == "BU_") {
+            tok.accept(':');
+            while (!tok.atLineEnd()) {
+                const std::string_view nodeName = tok.word();
+                if (nodeName.empty()) {
+                    qWarning() << "Unexpected character in node list";
+                    break;
                 }
+                Node node;
+                node.name = toQString(nodeName);
+
+                // Update Node-Network Association
+                NodeNetworkAssociation nodeNetworkAssociation;
+                nodeNetworkAssociation.networkName = network.name;
+                nodeNetworkAssociation.sourceAddress = 0; // TODO: Source address parsing
+                node.networks.append(nodeNetworkAssociation);
+
+                m_nodes.append(node);
+                nodeMap.insert(rawKey(nodeName), m_nodes.size() - 1);
+            }
+            tok.skipLine();
+            continue;
+        }
+
+        // Parse messages
+        if (keyword == "BO_") {
+            Message message;
+            bool ok = parseInteger(tok.number(), message.pgn);
+            message.name = toQString(tok.word());
+            ok = ok && !message.name.isEmpty() && tok.accept(':');
+            ok = ok && parseInteger(tok.number(), message.length);
+            const std::string_view transmitter = tok.word();
+            message.priority = 0; // Initialize priority
+
+            if (!ok || transmitter.empty()) {
+                qWarning() << "Malformed message definition:" << message.name;
+                tok.skipLine();
+                continue;
+            }
+
+            // Extended ids are J1939 identifiers, take over the fields they carry
+            if (message.pgn & DbcExtendedIdFlag) {
+                const J1939Id id = J1939Id::fromCanId(quint32(message.pgn & 0x1FFFFFFF));
+                message.priority = id.priority;
+                message.dataPage = id.dataPage;
+                message.extendedDataPage = id.extendedDataPage;
+            }
+
+            // Add to Node-Network Association
+            const QByteArray transmitterKey = rawKey(transmitter);
+            if (!nodeMap.contains(transmitterKey)) {
+                Node newNode;
+                newNode.name = toQString(transmitter);
+                qWarning() << "Transmitter node not found: " << newNode.name << ". Creating new node.";
+
+                // Update Node-Network Association
+                NodeNetworkAssociation nodeNetworkAssociation;
+                nodeNetworkAssociation.networkName = network.name;
+                nodeNetworkAssociation.sourceAddress = 0; // TODO: Source address parsing
+                newNode.networks.append(nodeNetworkAssociation);
+
+                m_nodes.append(newNode);
+                nodeMap.insert(transmitterKey, m_nodes.size() - 1);
             }
-            if (defaultSignalAttributes.contains(attributeName)) {
-                defaultSignalAttributes[attributeName].value = defaultValue;
-                // Add default attribute to signal attributes
-                for (auto& message : m_messages) {
-                    for (auto& signal : message.messageSignals) {
-                        signal.signalAttributes.append(defaultSignalAttributes[attributeName]);
+
+            Node& transmitterNode = m_nodes[nodeMap.value(transmitterKey)];
+            for (NodeNetworkAssociation& networkAssociation : transmitterNode.networks) {
+                if (networkAssociation.networkName == network.name) {
+                    // Check if the message already exists in the tx list
+                    bool messageExistsInTx = false;
+                    for (const TxRxMessage& txMsg : networkAssociation.tx) {
+                        if (txMsg.name == message.name) {
+                            messageExistsInTx = true;
+                            break;
+                        }
+                    }
+                    if (!messageExistsInTx) {
+                        TxRxMessage txRxMessage;
+                        txRxMessage.name = message.name;
+                        networkAssociation.tx.append(txRxMessage);
                     }
                 }
             }
-            if (defaultNodeAttributes.contains(attributeName)) {
-                defaultNodeAttributes[attributeName].value = defaultValue;
-                // Add default attribute to node attributes
-                for (auto& node : m_nodes) {
-                    node.nodeAttributes.append(defaultNodeAttributes[attributeName]);
-                }
+
+            m_messages.append(message);
+            indexMessage(m_messages.size() - 1);
+            tok.skipLine();
+            continue;
+        }
+
+        // Parse attribute definitions (BA_DEF_)
+        if (keyword == "BA_DEF_") {
+            AttributeDefinition definition;
+            if (tok.peek() != '"') {
+                definition.objectType = tok.word(); // Object type (BO_, SG_, etc.)
+            }
+            if (tok.quoted(definition.name)) {
+                definition.valueType = tok.word(); // Value type (STRING, INT, etc.)
+                definition.range = tok.restOfStatement();
+                attributeDefinitions.append(definition);
+            }
+            tok.skipLine();
+            continue;
+        }
+
+        // Parse default attribute values (BA_DEF_DEF_)
+        if (keyword == "BA_DEF_DEF_") {
+            std::string_view attributeName;
+            if (tok.quoted(attributeName)) {
+                attributeDefaultValues.insert(rawKey(attributeName), tok.value());
             }
+            tok.skipLine();
             continue;
         }
 
         // Parse assigned attributes (BA_)
-        match = reAttributeAssignment.match(line);
-        if (match.hasMatch()) {
-            QString attributeName = match.captured(1).trimmed();
-            QString targetType = match.captured(2).trimmed();
-            QString targetName = match.captured(3).trimmed();
-            QString value = match.captured(4).trimmed();
-
-            // Create a new Attribute object
-            Attribute attribute;
-            attribute.name = attributeName;
-            attribute.value = value;
-
-            // Replace existing attribute value if already present
-            if (targetType == "BO_") {
-                // Replace attribute in Message
-                for (auto& message : m_messages) {
-                    QString pgnString = QString::number(message.pgn);
-                    if (pgnString == targetName) {
-                        // Check if the attribute already exists and replace
-                        bool found = false;
-                        for (auto& msgAttr : message.messageAttributes) {
-                            if (msgAttr.name == attributeName) {
-                                msgAttr.value = value; // Replace the value
-                                found = true;
-                                break;
-                            }
-                        }
-                        if (!found) {
-                            message.messageAttributes.append(attribute); // Append if not found
-                        }
-                        break;
+        if (keyword == "BA_") {
+            AttributeAssignment assignment;
+            if (!tok.quoted(assignment.name)) {
+                tok.skipLine();
+                continue;
+            }
+
+            // Object attributes name their target first, network attributes go straight to the value
+            const char next = tok.peek();
+            if (next != '"' && next != '-' && next != '+' && next != '.' && !(next >= '0' && next <= '9')) {
+                assignment.objectType = tok.word();
+                if (assignment.objectType == "BO_" || assignment.objectType == "SG_") {
+                    if (!parseInteger(tok.number(), assignment.messageId)) {
+                        tok.skipLine();
+                        continue;
                     }
                 }
-            } else if (targetType == "SG_") {
-                // Replace attribute in Signal
-                for (auto& message : m_messages) {
-                    QString pgnString = QString::number(message.pgn);
-                    if (pgnString == targetName) {
-                        // For each signal in that message
-                        for (auto& signal : message.messageSignals) {
-                            bool found = false;
-                            // For each attribute in the signal
-                            for (auto& sigAttr : signal.signalAttributes) {
-                                if (sigAttr.name == attributeName) {
-                                    sigAttr.value = value; // Replace the value
-                                    found = true;
-                                    break;
-                                }
-                            }
-                            if (!found) {
-                                signal.signalAttributes.append(attribute); // Append if not found
-                            }
-                            break;
-                        }
-                    }
+                if (assignment.objectType != "BO_") {
+                    assignment.target = tok.word(); // Signal, node or environment variable name
                 }
-            } else if (targetType == "BU_") {
-                // Replace attribute in Node
-                for (auto& node : m_nodes) {
-                    if (node.name == targetName) {
-                        bool found = false;
-                        for (auto& nodeAttr : node.nodeAttributes) {
-                            if (nodeAttr.name == attributeName) {
-                                nodeAttr.value = value; // Replace the value
-                                found = true;
-                                break;
-                            }
-                        }
-                        if (!found) {
-                            node.nodeAttributes.append(attribute); // Append if not found
-                        }
-                        break;
+            }
+            assignment.value = tok.value();
+            attributeAssignments.append(assignment);
+            tok.skipLine();
+            continue;
+        }
+
+        // Parse comments (CM_)
+        if (keyword == "CM_") {
+            CommentEntry comment;
+            if (tok.peek() != '"') {
+                comment.objectType = tok.word();
+                if (comment.objectType == "BO_" || comment.objectType == "SG_") {
+                    if (!parseInteger(tok.number(), comment.messageId)) {
+                        tok.skipLine();
+                        continue;
                     }
                 }
+                if (comment.objectType != "BO_") {
+                    comment.target = tok.word();
+                }
+            }
+            if (tok.quoted(comment.text)) {
+                comments.append(comment);
             }
+            tok.skipLine();
             continue;
         }
-    }
-
-    // Close the file
-    file.close();
 
-    // Sort m_networks alphabetically by name
-    std::sort(m_networks.begin(), m_networks.end(), [](const Network& a, const Network& b) {
-        return a.name.toLower() < b.name.toLower();
-    });
+        // Parse signal value descriptions (VAL_). Environment variable tables start with a name and are skipped
+        if (keyword == "VAL_") {
+            ValueTableEntry table;
+            if (parseInteger(tok.number(), table.messageId)) {
+                table.signal = tok.word();
+                table.entries = tok.restOfStatement();
+                valueTables.append(table);
+            }
+            tok.skipLine();
+            continue;
+        }
 
-    // Sort m_nodes alphabetically by name
-    std::sort(m_nodes.begin(), m_nodes.end(), [](Node& a, Node& b) {
-        return a.name.toLower() < b.name.toLower();
-    });
+        // Statements not stored in the model (VERSION, NS_, BS_, VAL_TABLE_, ...)
+        tok.skipLine();
+    }
 
-    // For each node, sort node.networks alphabetically by networkName
-    for (Node& node : m_nodes) {
-        std::sort(node.networks.begin(), node.networks.end(), [](NodeNetworkAssociation& a, NodeNetworkAssociation& b) {
-            return a.networkName.toLower() < b.networkName.toLower();
-        });
+    // Signal lookup by message id and name, valid until the model is sorted
+    auto findSignal = [this, &signalMap](quint64 messageId, std::string_view name) -> Signal* {
+        const int messageIndex = m_pgnIndex.value(messageId, -1);
+        const int signalIndex = signalMap.value({messageIndex, rawKey(name)}, -1);
+        return signalIndex < 0 ? nullptr : &m_messages[messageIndex].messageSignals[signalIndex];
+    };
+
+    // Resolve attributes. Every object starts from the defaults for its type and the
+    // assignments then overwrite single slots, found through hashed lookups.
+    AttributeDefaults messageDefaults;
+    AttributeDefaults signalDefaults;
+    AttributeDefaults nodeDefaults;
+    AttributeDefaults networkDefaults;
+    for (const AttributeDefinition& definition : attributeDefinitions) {
+        AttributeDefaults* defaults = nullptr;
+        if (definition.objectType == "BO_") {
+            defaults = &messageDefaults;
+        } else if (definition.objectType == "SG_") {
+            defaults = &signalDefaults;
+        } else if (definition.objectType == "BU_") {
+            defaults = &nodeDefaults;
+        } else if (definition.objectType.empty()) {
+            defaults = &networkDefaults;
+        } else {
+            continue; // Environment variables are not part of the model
+        }
 
-        // Sort tx and rx messages
-        for (NodeNetworkAssociation& nodeNetwork : node.networks) {
-            std::sort(nodeNetwork.tx.begin(), nodeNetwork.tx.end(), [](const TxRxMessage& a, const TxRxMessage& b) {
-                return a.name.toLower() < b.name.toLower();
-            });
+        Attribute attribute;
+        attribute.name = toQString(definition.name);
+        attribute.type = toQString(definition.valueType);
+        attribute.range = toQString(definition.range).trimmed();
+        attribute.value = toUnescapedQString(attributeDefaultValues.value(rawKey(definition.name))).trimmed();
+        defaults->positions.insert(rawKey(definition.name), defaults->attributes.size());
+        defaults->attributes.append(attribute);
+    }
 
-            std::sort(nodeNetwork.rx.begin(), nodeNetwork.rx.end(), [](const TxRxMessage& a, const TxRxMessage& b) {
-                return a.name.toLower() < b.name.toLower();
-            });
+    // Lists are implicitly shared, so objects only get their own copy once assigned to
+    for (Message& message : m_messages) {
+        message.messageAttributes = messageDefaults.attributes;
+        for (Signal& signal : message.messageSignals) {
+            signal.signalAttributes = signalDefaults.attributes;
         }
     }
+    for (Node& node : m_nodes) {
+        node.nodeAttributes = nodeDefaults.attributes;
+    }
+    m_networks[networkIndex].networkAttributes = networkDefaults.attributes;
 
-    // Sort m_messages alphabetically by name
+    for (const AttributeAssignment& assignment : attributeAssignments) {
+        if (assignment.objectType == "BO_") {
+            if (Message* message = findMessageByPgn(assignment.messageId)) {
+                assignAttribute(message->messageAttributes, messageDefaults, assignment.name, assignment.value);
+            }
+        } else if (assignment.objectType == "SG_") {
+            if (Signal* signal = findSignal(assignment.messageId, assignment.target)) {
+                assignAttribute(signal->signalAttributes, signalDefaults, assignment.name, assignment.value);
+
+                // J1939 databases carry the SPN as a signal attribute
+                if (assignment.name == "SPN" && !parseInteger(assignment.value, signal->spn)) {
+                    signal->spn = 0;
+                }
+            }
+        } else if (assignment.objectType == "BU_") {
+            const int nodeIndex = nodeMap.value(rawKey(assignment.target), -1);
+            if (nodeIndex >= 0) {
+                assignAttribute(m_nodes[nodeIndex].nodeAttributes, nodeDefaults, assignment.name, assignment.value);
+            }
+        } else if (assignment.objectType.empty()) {
+            assignAttribute(m_networks[networkIndex].networkAttributes, networkDefaults, assignment.name, assignment.value);
+        }
+    }
+
+    // Attach comments to messages and signals. Nodes and networks have no description field
+    for (const CommentEntry& comment : comments) {
+        if (comment.objectType == "BO_") {
+            if (Message* message = findMessageByPgn(comment.messageId)) {
+                message->description = toUnescapedQString(comment.text);
+            }
+        } else if (comment.objectType == "SG_") {
+            if (Signal* signal = findSignal(comment.messageId, comment.target)) {
+                signal->description = toUnescapedQString(comment.text);
+            }
+        }
+    }
+
+    // Attach value descriptions as signal enumerations
+    for (const ValueTableEntry& table : valueTables) {
+        Signal* signal = findSignal(table.messageId, table.signal);
+        if (!signal) {
+            continue;
+        }
+        DbcTokenizer entries(table.entries.data(), table.entries.data() + table.entries.size());
+        while (!entries.atLineEnd()) {
+            qint64 value = 0;
+            std::string_view label;
+            if (!parseInteger(entries.number(), value) || !entries.quoted(label)) {
+                qWarning() << "Malformed value description for signal" << signal->name;
+                break;
+            }
+            Enumeration enumeration;
+            enumeration.name = toUnescapedQString(label);
+            enumeration.value = static_cast<int>(value);
+            signal->enumerations.append(enumeration);
+        }
+    }
+
+    // Release the mapping; nothing in the model refers to it
+    if (mapped) {
+        file.unmap(mapped);
+    }
+    file.close();
+
+    // Sort m_networks alphabetically by name
+    std::sort(m_networks.begin(), m_networks.end(), [](const Network& a, const Network& b) {
+        return a.name.toLower() < b.name.toLower();
+    });
+
+    // Sort m_nodes alphabetically by name
+    std::sort(m_nodes.begin(), m_nodes.end(), [](Node& a, Node& b) {
+        return a.name.toLower() < b.name.toLower();
+    });
+
+    // For each node, sort node.networks alphabetically by networkName
+    for (Node& node : m_nodes) {
+        std::sort(node.networks.begin(), node.networks.end(), [](NodeNetworkAssociation& a, NodeNetworkAssociation& b) {
+            return a.networkName.toLower() < b.networkName.toLower();
+        });
+
+        // Sort tx and rx messages
+        for (NodeNetworkAssociation& nodeNetwork : node.networks) {
+            std::sort(nodeNetwork.tx.begin(), nodeNetwork.tx.end(), [](const TxRxMessage& a, const TxRxMessage& b) {
+                return a.name.toLower() < b.name.toLower();
+            });
+
+            std::sort(nodeNetwork.rx.begin(), nodeNetwork.rx.end(), [](const TxRxMessage& a, const TxRxMessage& b) {
+                return a.name.toLower() < b.name.toLower();
+            });
+        }
+    }
+
+    // Sort m_messages alphabetically by name
     std::sort(m_messages.begin(), m_messages.end(), [](Message& a, Message& b) {
         return a.name.toLower() < b.name.toLower();
     });
@@ -405,225 +811,800 @@ bool DbcDataModel::importDBC(const QString& filePath) {
         });
     }
 
+    // Sorting moved every message and node, so the indexes have to follow
+    rebuildMessageIndex();
+    rebuildEndpointIndex();
+
+    if (progress) {
+        progress(100);
+    }
     return true;
 }
 
 
-bool DbcDataModel::loadJson(const QString& filePath) {
+namespace {
+
+// Output buffer for exportDBC. Everything is appended to one byte array reserved up front and
+// numbers are formatted in place, so no intermediate strings are built per field.
+class DbcTextWriter {
+    public:
+        explicit DbcTextWriter(qsizetype reserve) {
+            m_text.reserve(reserve);
+        }
+
+        DbcTextWriter& operator<<(std::string_view text) {
+            m_text.append(text.data(), static_cast<qsizetype>(text.size()));
+            return *this;
+        }
+
+        DbcTextWriter& operator<<(const char* text) {
+            return *this << std::string_view(text);
+        }
+
+        DbcTextWriter& operator<<(char c) {
+            m_text.append(c);
+            return *this;
+        }
+
+        // UTF-8, matching what importDBC decodes. Plain ASCII is copied without conversion.
+        DbcTextWriter& operator<<(const QString& text) {
+            const QChar* chars = text.constData();
+            const qsizetype size = text.size();
+            qsizetype i = 0;
+            while (i < size && chars[i].unicode() < 0x80) {
+                ++i;
+            }
+            if (i == size) {
+                const qsizetype start = m_text.size();
+                m_text.resize(start + size);
+                char* out = m_text.data() + start;
+                for (qsizetype j = 0; j < size; ++j) {
+                    out[j] = static_cast<char>(chars[j].unicode());
+                }
+            } else {
+                m_text.append(text.toUtf8());
+            }
+            return *this;
+        }
+
+        template <typename T>
+        DbcTextWriter& integer(T value) {
+            char digits[24];
+            const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            m_text.append(digits, result.ptr - digits);
+            return *this;
+        }
+
+        // Shortest text that parses back to the same double
+        DbcTextWriter& real(double value) {
+            char digits[32];
+            const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            m_text.append(digits, result.ptr - digits);
+            return *this;
+        }
+
+        // Double-quoted text with embedded quotes escaped, the reverse of toUnescapedQString
+        DbcTextWriter& quoted(const QString& text) {
+            m_text.append('"');
+            if (text.contains(QLatin1Char('"'))) {
+                QString escaped = text;
+                escaped.replace(QLatin1String("\""), QLatin1String("\\\""));
+                *this << escaped;
+            } else {
+                *this << text;
+            }
+            m_text.append('"');
+            return *this;
+        }
+
+        const QByteArray& text() const {
+            return m_text;
+        }
+
+    private:
+        QByteArray m_text;
+};
+
+// Attribute values are stored unescaped, so string values are quoted again on the way out
+void writeAttributeValue(DbcTextWriter& out, const QString& type, const QString& value)
+{
+    bool numeric = false;
+    if (type == "INT" || type == "HEX" || type == "FLOAT" || type == "ENUM") {
+        value.toDouble(&numeric);
+    }
+    if (numeric) {
+        out << value;
+    } else {
+        out.quoted(value);
+    }
+}
+
+// One attribute name as used by one object type, gathered from the objects' attribute lists
+struct ExportedAttribute {
+    QString name;
+    QString type;
+    QHash<QString, int> valueCounts;
+    QStringList values;     // Distinct values in first-seen order
+    QString defaultValue;
+    QString range;          // From the first object that has one
+};
+
+// Collects the typed attributes of all objects of one kind. Untyped attributes were assigned
+// without a BA_DEF_ and are only written as BA_, so a re-import keeps them on those objects only.
+void collectAttributes(QList<ExportedAttribute>& exported, QHash<QString, int>& positions,
+                       const QList<Attribute>& attributes)
+{
+    for (const Attribute& attribute : attributes) {
+        if (attribute.type.isEmpty()) {
+            continue;
+        }
+        int position = positions.value(attribute.name, -1);
+        if (position < 0) {
+            position = exported.size();
+            positions.insert(attribute.name, position);
+            exported.append(ExportedAttribute{attribute.name, attribute.type, {}, {}, {}, {}});
+        }
+        ExportedAttribute& entry = exported[position];
+        if (entry.range.isEmpty()) {
+            entry.range = attribute.range;
+        }
+        int& count = entry.valueCounts[attribute.value];
+        if (count++ == 0) {
+            entry.values.append(attribute.value);
+        }
+    }
+}
+
+// The most common value becomes the default, so only the exceptions need a BA_ statement
+void chooseDefaults(QList<ExportedAttribute>& exported)
+{
+    for (ExportedAttribute& entry : exported) {
+        int best = -1;
+        for (const QString& value : entry.values) {
+            const int count = entry.valueCounts.value(value);
+            if (count > best) {
+                best = count;
+                entry.defaultValue = value;
+            }
+        }
+    }
+}
+
+void writeAttributeDefinitions(DbcTextWriter& out, std::string_view objectType, const QList<ExportedAttribute>& exported)
+{
+    for (const ExportedAttribute& entry : exported) {
+        out << "BA_DEF_ " << objectType;
+        if (!objectType.empty()) {
+            out << ' ';
+        }
+        out.quoted(entry.name) << ' ' << entry.type;
+        if (!entry.range.isEmpty()) {
+            out << ' ' << entry.range;
+        } else if (entry.type == "INT" || entry.type == "HEX" || entry.type == "FLOAT") {
+            // Attributes that did not come from a BA_DEF_ get the range of their values
+            QString minimum = QStringLiteral("0");
+            QString maximum = QStringLiteral("0");
+            double low = 0.0;
+            double high = 0.0;
+            bool any = false;
+            for (const QString& value : entry.values) {
+                bool numeric = false;
+                const double number = value.toDouble(&numeric);
+                if (!numeric) {
+                    continue;
+                }
+                if (!any || number < low) {
+                    low = number;
+                    minimum = value;
+                }
+                if (!any || number > high) {
+                    high = number;
+                    maximum = value;
+                }
+                any = true;
+            }
+            out << ' ' << minimum << ' ' << maximum;
+        } else if (entry.type == "ENUM") {
+            // Only the labels seen on objects are known; BA_ values that are indexes stay as they were
+            bool first = true;
+            for (const QString& value : entry.values) {
+                bool numeric = false;
+                value.toDouble(&numeric);
+                if (!numeric) {
+                    out << (first ? " " : ",");
+                    out.quoted(value);
+                    first = false;
+                }
+            }
+        }
+        out << ";\n";
+    }
+}
+
+} // namespace
+
+
+bool DbcDataModel::exportDBC(const QString& filePath) const
+{
+    static const QString noNode = QStringLiteral("Vector__XXX");
+
+    // Network attributes and node lists have no per-network form in a DBC
+    if (m_networks.size() > 1) {
+        qWarning() << "Cannot export" << m_networks.size() << "networks to one DBC file:" << filePath;
+        return false;
+    }
+
+    qsizetype estimate = 4096 + m_nodes.size() * 64;
+    for (const Message& message : m_messages) {
+        estimate += 256 + message.messageAttributes.size() * 64;
+        for (const Signal& signal : message.messageSignals) {
+            estimate += 256 + signal.description.size() + signal.enumerations.size() * 32 + signal.signalAttributes.size() * 64;
+        }
+    }
+    DbcTextWriter out(estimate);
+
+    out << "VERSION \"\"\n\n\n"
+        << "NS_ :\n"
+        << "    NS_DESC_\n    CM_\n    BA_DEF_\n    BA_\n    VAL_\n    BA_DEF_DEF_\n    BU_SG_REL_\n\n"
+        << "BS_:\n\n";
+
+    out << "BU_:";
+    for (const Node& node : m_nodes) {
+        out << ' ' << node.name;
+    }
+    out << "\n\n\n";
+
+    // Messages with their signals
+    for (const Message& message : m_messages) {
+        const QList<std::pair<QString, QString>> transmitters = messageTransmitters(message);
+        out << "BO_ ";
+        out.integer(message.pgn);
+        out << ' ' << message.name << ": ";
+        out.integer(message.length);
+        out << ' ' << (transmitters.isEmpty() ? noNode : transmitters.first().first) << '\n';
+
+        // The model keeps receivers per message, every signal lists all of them
+        QStringList receivers;
+        for (const auto& receiver : messageReceivers(message)) {
+            if (!receivers.contains(receiver.first)) {
+                receivers.append(receiver.first);
+            }
+        }
+        if (receivers.isEmpty()) {
+            receivers.append(noNode);
+        }
+
+        for (const Signal& signal : message.messageSignals) {
+            out << " SG_ " << signal.name;
+            if (signal.multiplexValue >= 0) {
+                out << " m";
+                out.integer(signal.multiplexValue);
+                if (signal.isMultiplexer) {
+                    out << 'M';
+                }
+            } else if (signal.isMultiplexer) {
+                out << " M";
+            }
+            out << " : ";
+            out.integer(signal.startBit);
+            out << '|';
+            out.integer(signal.bitLength);
+            out << '@' << (signal.isBigEndian ? '0' : '1') << (signal.isTwosComplement ? '-' : '+');
+            out << " (";
+            out.real(signal.factor);
+            out << ',';
+            out.real(signal.offset);
+            out << ") [";
+            out.real(signal.scaledMin.toDouble());
+            out << '|';
+            out.real(signal.scaledMax.toDouble());
+            out << "] ";
+            out.quoted(signal.units) << ' ';
+            for (int i = 0; i < receivers.size(); ++i) {
+                out << (i ? "," : "") << receivers[i];
+            }
+            out << '\n';
+        }
+        out << '\n';
+    }
+    out << '\n';
+
+    // Comments
+    for (const Message& message : m_messages) {
+        if (!message.description.isEmpty()) {
+            out << "CM_ BO_ ";
+            out.integer(message.pgn);
+            out << ' ';
+            out.quoted(message.description) << ";\n";
+        }
+        for (const Signal& signal : message.messageSignals) {
+            if (!signal.description.isEmpty()) {
+                out << "CM_ SG_ ";
+                out.integer(message.pgn);
+                out << ' ' << signal.name << ' ';
+                out.quoted(signal.description) << ";\n";
+            }
+        }
+    }
+
+    // Attribute definitions and defaults, per object type
+    QList<ExportedAttribute> networkAttributes;
+    QList<ExportedAttribute> nodeAttributes;
+    QList<ExportedAttribute> messageAttributes;
+    QList<ExportedAttribute> signalAttributes;
+    QHash<QString, int> networkPositions;
+    QHash<QString, int> nodePositions;
+    QHash<QString, int> messagePositions;
+    QHash<QString, int> signalPositions;
+    const Network* network = m_networks.isEmpty() ? nullptr : &m_networks.first();
+    if (network) {
+        collectAttributes(networkAttributes, networkPositions, network->networkAttributes);
+    }
+    for (const Node& node : m_nodes) {
+        collectAttributes(nodeAttributes, nodePositions, node.nodeAttributes);
+    }
+    for (const Message& message : m_messages) {
+        collectAttributes(messageAttributes, messagePositions, message.messageAttributes);
+        for (const Signal& signal : message.messageSignals) {
+            collectAttributes(signalAttributes, signalPositions, signal.signalAttributes);
+        }
+    }
+    chooseDefaults(networkAttributes);
+    chooseDefaults(nodeAttributes);
+    chooseDefaults(messageAttributes);
+    chooseDefaults(signalAttributes);
+
+    writeAttributeDefinitions(out, "", networkAttributes);
+    writeAttributeDefinitions(out, "BU_", nodeAttributes);
+    writeAttributeDefinitions(out, "BO_", messageAttributes);
+    writeAttributeDefinitions(out, "SG_", signalAttributes);
+
+    // BA_DEF_DEF_ is keyed by name only, the first object type using a name decides its default
+    QSet<QString> defaulted;
+    for (const QList<ExportedAttribute>* exported : {&networkAttributes, &nodeAttributes, &messageAttributes, &signalAttributes}) {
+        for (const ExportedAttribute& entry : *exported) {
+            if (defaulted.contains(entry.name)) {
+                continue;
+            }
+            defaulted.insert(entry.name);
+            out << "BA_DEF_DEF_ ";
+            out.quoted(entry.name) << ' ';
+            writeAttributeValue(out, entry.type, entry.defaultValue);
+            out << ";\n";
+        }
+    }
+
+    // Values that differ from the default, and untyped attributes wherever they are set
+    auto writeAssignments = [&out](const QList<Attribute>& attributes, const QList<ExportedAttribute>& exported,
+                                   const QHash<QString, int>& positions, const std::function<void()>& writeTarget) {
+        for (const Attribute& attribute : attributes) {
+            const int position = positions.value(attribute.name, -1);
+            if (!attribute.type.isEmpty() && position >= 0 && exported[position].defaultValue == attribute.value) {
+                continue;
+            }
+            out << "BA_ ";
+            out.quoted(attribute.name) << ' ';
+            writeTarget();
+            writeAttributeValue(out, attribute.type, attribute.value);
+            out << ";\n";
+        }
+    };
+    if (network) {
+        writeAssignments(network->networkAttributes, networkAttributes, networkPositions, []() {});
+    }
+    for (const Node& node : m_nodes) {
+        writeAssignments(node.nodeAttributes, nodeAttributes, nodePositions, [&]() {
+            out << "BU_ " << node.name << ' ';
+        });
+    }
+    for (const Message& message : m_messages) {
+        writeAssignments(message.messageAttributes, messageAttributes, messagePositions, [&]() {
+            out << "BO_ ";
+            out.integer(message.pgn) << ' ';
+        });
+        for (const Signal& signal : message.messageSignals) {
+            writeAssignments(signal.signalAttributes, signalAttributes, signalPositions, [&]() {
+                out << "SG_ ";
+                out.integer(message.pgn) << ' ' << signal.name << ' ';
+            });
+        }
+    }
+
+    // Value descriptions
+    for (const Message& message : m_messages) {
+        for (const Signal& signal : message.messageSignals) {
+            if (signal.enumerations.isEmpty()) {
+                continue;
+            }
+            out << "VAL_ ";
+            out.integer(message.pgn) << ' ' << signal.name;
+            for (const Enumeration& enumeration : signal.enumerations) {
+                out << ' ';
+                out.integer(enumeration.value) << ' ';
+                out.quoted(enumeration.name);
+            }
+            out << " ;\n";
+        }
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not open file for writing:" << filePath;
+        return false;
+    }
+    if (file.write(out.text()) != out.text().size() || !file.commit()) {
+        qWarning() << "Could not write DBC file:" << filePath << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+
+bool DbcDataModel::loadJson(const QString& filePath, const ProgressCallback& progress) {
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly)) {
         qWarning() << "Couldn't open JSON file:" << filePath;
         return false;
     }
 
-    QByteArray data = file.readAll();
-    file.close();
-
-    QJsonParseError parseError;
-    QJsonDocument doc(QJsonDocument::fromJson(data, &parseError));
-    if (doc.isNull() || !doc.isObject()) {
-        qWarning() << "Invalid JSON document in file:" << filePath << ":" << parseError.errorString();
+    // Parse straight out of the mapped file, values go into the model lists as they are read
+    const qint64 fileSize = file.size();
+    uchar* mapped = fileSize > 0 ? file.map(0, fileSize) : nullptr;
+    QByteArray fallback;
+    if (!mapped) {
+        fallback = file.readAll();
+    }
+    const char* begin = mapped ? reinterpret_cast<const char*>(mapped) : fallback.constData();
+    const char* end = begin + (mapped ? fileSize : fallback.size());
+
+    JsonPullReader reader(begin, end);
+    bool canceled = false;
+    const qint64 progressStep = std::max<qint64>((end - begin) / 100, 1);
+    const char* nextProgress = begin;
+    auto reportProgress = [&]() {
+        if (progress && !canceled && reader.position() >= nextProgress) {
+            canceled = !progress(static_cast<int>(reader.offset() * 95 / std::max<qint64>(end - begin, 1)));
+            nextProgress = reader.position() + progressStep;
+        }
+        return !canceled;
+    };
+
+    if (!parseJson(reader, reportProgress)) {
+        if (canceled) {
+            qWarning() << "JSON load canceled:" << filePath;
+        } else {
+            qWarning() << "Invalid JSON document in file:" << filePath << ":" << reader.errorString();
+        }
         return false;
     }
 
-    parseJson(doc.object());
+    if (progress) {
+        progress(100);
+    }
     return true;
 }
 
 
-void DbcDataModel::parseJson(const QJsonObject& jsonObject) {
-    // Clear existing data
-    m_networks.clear();
-    m_messages.clear();
-    m_nodes.clear();
-
-    // Parse Networks ("buses" on JSON)
-    QJsonArray busesArray = jsonObject.value("buses").toArray();
-    for (const QJsonValue& value : busesArray) {
-        QJsonObject busObject = value.toObject();
-        Network network;
-        network.name = busObject.value("name").toString();
-        network.baud = busObject.value("baud").toString();
+namespace {
 
-        // Parse Network Attributes
-        QJsonArray attributesArray = busObject.value("networkAttributes").toArray();
-        for (const QJsonValue& attrValue : attributesArray) {
-            QJsonObject attrObject = attrValue.toObject();
-            Attribute attribute;
-            attribute.name = attrObject.value("name").toString();
-            attribute.type = attrObject.value("type").toString();
-            attribute.value = attrObject.value("value").toString();
-            network.networkAttributes.append(attribute);
+// Reads an array of objects, handing each one to readObject once its opening brace is consumed.
+// Anything else in place of the array or its objects is skipped.
+template <typename ReadObject>
+bool readObjects(JsonPullReader& reader, ReadObject readObject)
+{
+    if (reader.peek() != JsonPullReader::Type::Array) {
+        reader.skipValue();
+        return !reader.hasError();
+    }
+    reader.enterArray();
+    while (reader.nextElement()) {
+        if (reader.peek() != JsonPullReader::Type::Object) {
+            reader.skipValue();
+            continue;
+        }
+        reader.enterObject();
+        if (!readObject()) {
+            return false;
         }
-
-        m_networks.append(network);
     }
+    return !reader.hasError();
+}
 
-    // Sort m_networks alphabetically by name
-    std::sort(m_networks.begin(), m_networks.end(), [](const Network& a, const Network& b) {
-        return a.name.toLower() < b.name.toLower();
+void readAttributes(JsonPullReader& reader, QList<Attribute>& attributes)
+{
+    readObjects(reader, [&]() {
+        Attribute attribute;
+        std::string_view key;
+        while (reader.nextKey(key)) {
+            if (key == "name") {
+                attribute.name = reader.readString();
+            } else if (key == "type") {
+                attribute.type = reader.readString();
+            } else if (key == "value") {
+                attribute.value = reader.readString();
+            } else if (key == "range") {
+                attribute.range = reader.readString();
+            } else {
+                reader.skipValue();
+            }
+        }
+        attributes.append(attribute);
+        return true;
     });
+}
 
-    // Parse Messages
-    QJsonArray messagesArray = jsonObject.value("messages").toArray();
-    for (const QJsonValue& value : messagesArray) {
-        QJsonObject messageObject = value.toObject();
-        Message message;
-        message.pgn = messageObject.value("pgn").toVariant().toULongLong();
-        message.name = messageObject.value("name").toString();
-        message.description = messageObject.value("description").toString();
-        message.priority = messageObject.value("priority").toInt();
-        message.length = messageObject.value("length").toInt();
-        message.txPeriodicity = messageObject.value("tx_periodicity").toInt(0);
-        message.txOnChange = messageObject.value("tx_onChange").toBool(false);
-        message.multiplexValue = -1; // Always defaults to -1
-
-        // Parse Message Attributes
-        QJsonArray messageAttributesArray = messageObject.value("messageAttributes").toArray();
-        for (const QJsonValue& attrValue : messageAttributesArray) {
-            QJsonObject attrObject = attrValue.toObject();
-            Attribute attribute;
-            attribute.name = attrObject.value("name").toString();
-            attribute.type = attrObject.value("type").toString();
-            attribute.value = attrObject.value("value").toString();
-            message.messageAttributes.append(attribute);
+void readTxRxMessages(JsonPullReader& reader, QList<TxRxMessage>& messages)
+{
+    readObjects(reader, [&]() {
+        TxRxMessage message;
+        std::string_view key;
+        while (reader.nextKey(key)) {
+            if (key == "name") {
+                message.name = reader.readString();
+            } else {
+                reader.skipValue();
+            }
         }
+        messages.append(message);
+        return true;
+    });
 
-        // Parse signals
-        QJsonArray dataArray = messageObject.value("data").toArray();
-        for (const QJsonValue& dataValue : dataArray) {
-            QJsonObject signalObject = dataValue.toObject();
-            Signal signal;
-            signal.spn = signalObject.value("spn").toInt(0);
-            signal.name = signalObject.value("name").toString();
-            signal.description = signalObject.value("description").toString();
-            signal.startBit = signalObject.value("start_bit").toInt();
-            signal.bitLength = signalObject.value("bit_length").toInt();
-            signal.isBigEndian = signalObject.value("is_bigEndian").toBool(false);
-            signal.isTwosComplement = signalObject.value("is_twosComplement").toBool(false);
-            signal.factor = signalObject.value("factor").toDouble(1.0);
-            signal.offset = signalObject.value("offset").toDouble(0.0);
-            signal.units = signalObject.value("units").toString();
-            signal.multiplexValue = signalObject.value("multiplexValue").toInt(-1);
-            signal.isMultiplexer = signalObject.value("is_multiplexer").toBool(false);
-
-            // Handle scaled_min, scaled_max, scaled_default
-            signal.scaledMin = signalObject.value("scaled_min").toVariant();
-            signal.scaledMax = signalObject.value("scaled_max").toVariant();
-            signal.scaledDefault = signalObject.value("scaled_default").toVariant();
-
-            // If scaled_default is null, default to scaled_min
-            if (signal.scaledDefault.isNull()) {
-                signal.scaledDefault = signal.scaledMin;
-            }
-
-            // Parse Signal Attributes
-            QJsonArray signalAttributesArray = signalObject.value("signalAttributes").toArray();
-            for (const QJsonValue& attrValue : signalAttributesArray) {
-                QJsonObject attrObject = attrValue.toObject();
-                Attribute attribute;
-                attribute.name = attrObject.value("name").toString();
-                attribute.type = attrObject.value("type").toString();
-                attribute.value = attrObject.value("value").toString();
-                signal.signalAttributes.append(attribute);
-            }
-
-            // Parse enumerations
-            QJsonArray enumArray = signalObject.value("enumerations").toArray();
-            for (const QJsonValue& enumValue : enumArray) {
-                QJsonObject enumObject = enumValue.toObject();
+    std::sort(messages.begin(), messages.end(), [](TxRxMessage& a, TxRxMessage& b) {
+        return a.name.toLower() < b.name.toLower();
+    });
+}
+
+Signal readSignal(JsonPullReader& reader)
+{
+    Signal signal;
+    signal.spn = 0;
+    signal.startBit = 0;
+    signal.bitLength = 0;
+    signal.isBigEndian = false;
+    signal.isTwosComplement = false;
+    signal.isMultiplexer = false;
+    signal.factor = 1.0;
+    signal.offset = 0.0;
+    signal.multiplexValue = -1;
+
+    std::string_view key;
+    while (reader.nextKey(key)) {
+        if (key == "spn") {
+            signal.spn = reader.readInt(0);
+        } else if (key == "name") {
+            signal.name = reader.readString();
+        } else if (key == "description") {
+            signal.description = reader.readString();
+        } else if (key == "start_bit") {
+            signal.startBit = reader.readInt();
+        } else if (key == "bit_length") {
+            signal.bitLength = reader.readInt();
+        } else if (key == "is_bigEndian") {
+            // Taken as stored. Workspaces saved from a DBC import before format_version 2 carry
+            // the inverted flag, since importDBC used to read @1 (Intel) as big endian; such
+            // workspaces must be imported from the DBC again.
+            signal.isBigEndian = reader.readBool(false);
+        } else if (key == "is_twosComplement") {
+            signal.isTwosComplement = reader.readBool(false);
+        } else if (key == "factor") {
+            signal.factor = reader.readDouble(1.0);
+        } else if (key == "offset") {
+            signal.offset = reader.readDouble(0.0);
+        } else if (key == "units") {
+            signal.units = reader.readString();
+        } else if (key == "multiplexValue") {
+            signal.multiplexValue = reader.readInt(-1);
+        } else if (key == "is_multiplexer") {
+            signal.isMultiplexer = reader.readBool(false);
+        } else if (key == "scaled_min") {
+            signal.scaledMin = reader.readVariant();
+        } else if (key == "scaled_max") {
+            signal.scaledMax = reader.readVariant();
+        } else if (key == "scaled_default") {
+            signal.scaledDefault = reader.readVariant();
+        } else if (key == "signalAttributes") {
+            readAttributes(reader, signal.signalAttributes);
+        } else if (key == "enumerations") {
+            readObjects(reader, [&]() {
                 Enumeration enumeration;
-                enumeration.name = enumObject.value("name").toString();
-                enumeration.description = enumObject.value("description").toString();
-                enumeration.value = enumObject.value("value").toInt();
+                enumeration.value = 0;
+                std::string_view enumKey;
+                while (reader.nextKey(enumKey)) {
+                    if (enumKey == "name") {
+                        enumeration.name = reader.readString();
+                    } else if (enumKey == "description") {
+                        enumeration.description = reader.readString();
+                    } else if (enumKey == "value") {
+                        enumeration.value = reader.readInt();
+                    } else {
+                        reader.skipValue();
+                    }
+                }
                 signal.enumerations.append(enumeration);
-            }
-
-            message.messageSignals.append(signal);
+                return true;
+            });
+        } else {
+            reader.skipValue();
         }
+    }
 
-        // Sort message.messageSignals alphabetically by name
-        std::sort(message.messageSignals.begin(), message.messageSignals.end(), [](Signal& a, Signal& b) {
-            return a.name.toLower() < b.name.toLower();
-        });
+    // If scaled_default is null, default to scaled_min
+    if (signal.scaledDefault.isNull()) {
+        signal.scaledDefault = signal.scaledMin;
+    }
+    return signal;
+}
 
-        m_messages.append(message);
+Message readMessage(JsonPullReader& reader)
+{
+    Message message;
+    message.pgn = 0;
+    message.priority = 0;
+    message.length = 0;
+    message.txPeriodicity = 0;
+    message.txOnChange = false;
+    message.multiplexValue = -1; // Always defaults to -1
+
+    std::string_view key;
+    while (reader.nextKey(key)) {
+        if (key == "pgn") {
+            message.pgn = reader.readUInt64();
+        } else if (key == "name") {
+            message.name = reader.readString();
+        } else if (key == "description") {
+            message.description = reader.readString();
+        } else if (key == "priority") {
+            message.priority = reader.readInt();
+        } else if (key == "length") {
+            message.length = reader.readInt();
+        } else if (key == "tx_periodicity") {
+            message.txPeriodicity = reader.readInt(0);
+        } else if (key == "tx_onChange") {
+            message.txOnChange = reader.readBool(false);
+        } else if (key == "messageAttributes") {
+            readAttributes(reader, message.messageAttributes);
+        } else if (key == "data") {
+            readObjects(reader, [&]() {
+                message.messageSignals.append(readSignal(reader));
+                return true;
+            });
+        } else {
+            reader.skipValue();
+        }
     }
 
-    // Sort m_messages alphabetically by name
-    std::sort(m_messages.begin(), m_messages.end(), [](Message& a, Message& b) {
+    // Sort message.messageSignals alphabetically by name
+    std::sort(message.messageSignals.begin(), message.messageSignals.end(), [](Signal& a, Signal& b) {
         return a.name.toLower() < b.name.toLower();
     });
+    return message;
+}
 
-    // Parse Nodes
-    QJsonArray nodesArray = jsonObject.value("nodes").toArray();
-    for (const QJsonValue& value : nodesArray) {
-        QJsonObject nodeObject = value.toObject();
-        Node node;
-        node.name = nodeObject.value("name").toString();
-
-        // Parse Node Attributes
-        QJsonArray nodeAttributesArray = nodeObject.value("nodeAttributes").toArray();
-        for (const QJsonValue& attrValue : nodeAttributesArray) {
-            QJsonObject attrObject = attrValue.toObject();
-            Attribute attribute;
-            attribute.name = attrObject.value("name").toString();
-            attribute.type = attrObject.value("type").toString();
-            attribute.value = attrObject.value("value").toString();
-            node.nodeAttributes.append(attribute);
-        }
-
-        // Associate Nodes with their Networks (buses)
-        QJsonArray nodeNetworksArray = nodeObject.value("buses").toArray();
-        for (const QJsonValue& busValue : nodeNetworksArray) {
-            QJsonObject busObject = busValue.toObject();
-            NodeNetworkAssociation nodeNetwork;
-            nodeNetwork.networkName = busObject.value("name").toString();
-            nodeNetwork.sourceAddress = busObject.value("source_address").toInt();
-
-            // Parse tx messages
-            QJsonArray txArray = busObject.value("tx").toArray();
-            for (const QJsonValue& txValue : txArray) {
-                QJsonObject txObject = txValue.toObject();
-                TxRxMessage txMessage;
-                txMessage.name = txObject.value("name").toString();
-                nodeNetwork.tx.append(txMessage);
-            }
-
-            // Sort nodeNetwork.tx alphabetically by name
-            std::sort(nodeNetwork.tx.begin(), nodeNetwork.tx.end(), [](TxRxMessage& a, TxRxMessage& b) {
-                return a.name.toLower() < b.name.toLower();
+Node readNode(JsonPullReader& reader)
+{
+    Node node;
+    std::string_view key;
+    while (reader.nextKey(key)) {
+        if (key == "name") {
+            node.name = reader.readString();
+        } else if (key == "nodeAttributes") {
+            readAttributes(reader, node.nodeAttributes);
+        } else if (key == "buses") {
+            // Associate Nodes with their Networks (buses)
+            readObjects(reader, [&]() {
+                NodeNetworkAssociation nodeNetwork;
+                std::string_view busKey;
+                while (reader.nextKey(busKey)) {
+                    if (busKey == "name") {
+                        nodeNetwork.networkName = reader.readString();
+                    } else if (busKey == "source_address") {
+                        nodeNetwork.sourceAddress = reader.readInt();
+                    } else if (busKey == "tx") {
+                        readTxRxMessages(reader, nodeNetwork.tx);
+                    } else if (busKey == "rx") {
+                        readTxRxMessages(reader, nodeNetwork.rx);
+                    } else {
+                        reader.skipValue();
+                    }
+                }
+                node.networks.append(nodeNetwork);
+                return true;
             });
+        } else {
+            reader.skipValue();
+        }
+    }
 
-            // Parse rx messages
-            QJsonArray rxArray = busObject.value("rx").toArray();
-            for (const QJsonValue& rxValue : rxArray) {
-                QJsonObject rxObject = rxValue.toObject();
-                TxRxMessage rxMessage;
-                rxMessage.name = rxObject.value("name").toString();
-                nodeNetwork.rx.append(rxMessage);
-            }
+    // Sort node.networks alphabetically by networkName
+    std::sort(node.networks.begin(), node.networks.end(), [](NodeNetworkAssociation& a, NodeNetworkAssociation& b) {
+        return a.networkName.toLower() < b.networkName.toLower();
+    });
+    return node;
+}
 
-            // Sort nodeNetwork.rx alphabetically by name
-            std::sort(nodeNetwork.rx.begin(), nodeNetwork.rx.end(), [](TxRxMessage& a, TxRxMessage& b) {
-                return a.name.toLower() < b.name.toLower();
-            });
+} // namespace
 
-            node.networks.append(nodeNetwork);
-        }
 
-        // Sort node.networks alphabetically by networkName
-        std::sort(node.networks.begin(), node.networks.end(), [](NodeNetworkAssociation& a, NodeNetworkAssociation& b) {
-            return a.networkName.toLower() < b.networkName.toLower();
-        });
+// Walks the document once, in whatever order the top-level arrays appear. The model is only
+// replaced when the whole document was read, so a broken file leaves it untouched.
+bool DbcDataModel::parseJson(JsonPullReader& reader, const std::function<bool()>& reportProgress) {
+    QList<Network> networks;
+    QList<Message> messages;
+    QList<Node> nodes;
 
-        m_nodes.append(node);
+    if (!reader.enterObject()) {
+        return false;
+    }
+    std::string_view key;
+    while (reader.nextKey(key)) {
+        bool ok = true;
+        if (key == "buses") {
+            // Parse Networks ("buses" on JSON)
+            ok = readObjects(reader, [&]() {
+                Network network;
+                std::string_view busKey;
+                while (reader.nextKey(busKey)) {
+                    if (busKey == "name") {
+                        network.name = reader.readString();
+                    } else if (busKey == "baud") {
+                        network.baud = reader.readString();
+                    } else if (busKey == "networkAttributes") {
+                        readAttributes(reader, network.networkAttributes);
+                    } else {
+                        reader.skipValue();
+                    }
+                }
+                networks.append(network);
+                return reportProgress();
+            });
+        } else if (key == "format_version") {
+            const int version = reader.readInt(JsonFormatVersion);
+            if (version > JsonFormatVersion) {
+                qWarning() << "JSON workspace format" << version << "is newer than the supported" << JsonFormatVersion;
+                return false;
+            }
+        } else if (key == "messages") {
+            ok = readObjects(reader, [&]() {
+                messages.append(readMessage(reader));
+                return reportProgress();
+            });
+        } else if (key == "nodes") {
+            ok = readObjects(reader, [&]() {
+                nodes.append(readNode(reader));
+                return reportProgress();
+            });
+        } else {
+            reader.skipValue();
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    if (!reader.finish()) {
+        return false;
     }
 
+    // Sort m_networks alphabetically by name
+    std::sort(networks.begin(), networks.end(), [](const Network& a, const Network& b) {
+        return a.name.toLower() < b.name.toLower();
+    });
+
+    // Sort m_messages alphabetically by name
+    std::sort(messages.begin(), messages.end(), [](Message& a, Message& b) {
+        return a.name.toLower() < b.name.toLower();
+    });
+
     // Sort m_nodes alphabetically by name
-    std::sort(m_nodes.begin(), m_nodes.end(), [](Node& a, Node& b) {
+    std::sort(nodes.begin(), nodes.end(), [](Node& a, Node& b) {
         return a.name.toLower() < b.name.toLower();
     });
+
+    m_networks = std::move(networks);
+    m_messages = std::move(messages);
+    m_nodes = std::move(nodes);
+    rebuildMessageIndex();
+    rebuildEndpointIndex();
+    return true;
 }
 
 
@@ -640,3 +1621,233 @@ QList<Message>& DbcDataModel::messages() {
 QList<Node>& DbcDataModel::nodes()  {
     return m_nodes;
 }
+
+QString DbcDataModel::nameKey(const QString& name)
+{
+    return name.trimmed().toCaseFolded();
+}
+
+int DbcDataModel::indexOfMessage(const Message& message) const
+{
+    const Message* first = m_messages.constData();
+    const Message* last = first + m_messages.size();
+    if (std::less<const Message*>()(&message, first) || !std::less<const Message*>()(&message, last)) {
+        return -1;
+    }
+    return static_cast<int>(&message - first);
+}
+
+void DbcDataModel::indexMessage(int index)
+{
+    const Message& message = m_messages.at(index);
+
+    // Duplicate keys resolve to the first message, matching the old linear scans
+    if (!m_pgnIndex.contains(message.pgn)) {
+        m_pgnIndex.insert(message.pgn, index);
+    }
+    const QString key = nameKey(message.name);
+    if (!m_nameIndex.contains(key)) {
+        m_nameIndex.insert(key, index);
+    }
+}
+
+void DbcDataModel::rebuildMessageIndex()
+{
+    m_pgnIndex.clear();
+    m_nameIndex.clear();
+    m_pgnIndex.reserve(m_messages.size());
+    m_nameIndex.reserve(m_messages.size());
+    for (int i = 0; i < m_messages.size(); ++i) {
+        indexMessage(i);
+    }
+}
+
+void DbcDataModel::rebuildEndpointIndex()
+{
+    m_endpointIndex.clear();
+    m_endpointIndex.reserve(m_messages.size());
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        const QList<NodeNetworkAssociation>& associations = m_nodes.at(i).networks;
+        for (int j = 0; j < associations.size(); ++j) {
+            const NodeNetworkAssociation& nodeNetwork = associations.at(j);
+            for (const TxRxMessage& tx : nodeNetwork.tx) {
+                m_endpointIndex[tx.name][nodeNetwork.networkName].transmitters.append({i, j});
+            }
+            for (const TxRxMessage& rx : nodeNetwork.rx) {
+                m_endpointIndex[rx.name][nodeNetwork.networkName].receivers.append({i, j});
+            }
+        }
+    }
+}
+
+QMap<QString, MessageEndpoints> DbcDataModel::messageEndpoints(const QString& messageName) const
+{
+    return m_endpointIndex.value(messageName);
+}
+
+Message* DbcDataModel::findMessageByPgn(quint64 pgn)
+{
+    const int index = m_pgnIndex.value(pgn, -1);
+    return index < 0 ? nullptr : &m_messages[index];
+}
+
+Message* DbcDataModel::findMessageByName(const QString& name)
+{
+    const int index = m_nameIndex.value(nameKey(name), -1);
+    return index < 0 ? nullptr : &m_messages[index];
+}
+
+bool DbcDataModel::setMessagePgn(Message& message, quint64 pgn)
+{
+    const int index = indexOfMessage(message);
+    if (index < 0) {
+        return false;
+    }
+
+    const quint64 oldPgn = message.pgn;
+    if (oldPgn == pgn) {
+        return true;
+    }
+    message.pgn = pgn;
+
+    // Hand the old key over to the next message sharing it, if there is one
+    if (m_pgnIndex.value(oldPgn, -1) == index) {
+        m_pgnIndex.remove(oldPgn);
+        for (int i = 0; i < m_messages.size(); ++i) {
+            if (m_messages.at(i).pgn == oldPgn) {
+                m_pgnIndex.insert(oldPgn, i);
+                break;
+            }
+        }
+    }
+
+    const int existing = m_pgnIndex.value(pgn, -1);
+    if (existing < 0 || existing > index) {
+        m_pgnIndex.insert(pgn, index);
+    }
+    return true;
+}
+
+bool DbcDataModel::setMessageName(Message& message, const QString& name)
+{
+    const int index = indexOfMessage(message);
+    if (index < 0) {
+        return false;
+    }
+
+    const QString oldName = message.name;
+    const QString oldKey = nameKey(oldName);
+    const QString newKey = nameKey(name);
+    message.name = name;
+    if (oldName != name) {
+        renameMessageReferences(oldName, name);
+    }
+    if (oldKey == newKey) {
+        return true;
+    }
+
+    // Hand the old key over to the next message sharing it, if there is one
+    if (m_nameIndex.value(oldKey, -1) == index) {
+        m_nameIndex.remove(oldKey);
+        for (int i = 0; i < m_messages.size(); ++i) {
+            if (nameKey(m_messages.at(i).name) == oldKey) {
+                m_nameIndex.insert(oldKey, i);
+                break;
+            }
+        }
+    }
+
+    const int existing = m_nameIndex.value(newKey, -1);
+    if (existing < 0 || existing > index) {
+        m_nameIndex.insert(newKey, index);
+    }
+    return true;
+}
+
+void DbcDataModel::renameMessageReferences(const QString& oldName, const QString& newName)
+{
+    // Update all tx and rx references
+    for (Node& node : m_nodes) {
+        for (NodeNetworkAssociation& nodeNetwork : node.networks) {
+            for (TxRxMessage& txMessage : nodeNetwork.tx) {
+                if (txMessage.name == oldName) {
+                    txMessage.name = newName;
+                }
+            }
+            for (TxRxMessage& rxMessage : nodeNetwork.rx) {
+                if (rxMessage.name == oldName) {
+                    rxMessage.name = newName;
+                }
+            }
+        }
+    }
+
+    // Move the endpoints over to the new name instead of rebuilding the index
+    const QMap<QString, MessageEndpoints> endpoints = m_endpointIndex.take(oldName);
+    if (endpoints.isEmpty()) {
+        return;
+    }
+    QMap<QString, MessageEndpoints>& target = m_endpointIndex[newName];
+    for (auto it = endpoints.cbegin(); it != endpoints.cend(); ++it) {
+        target[it.key()].transmitters += it.value().transmitters;
+        target[it.key()].receivers += it.value().receivers;
+    }
+}
+
+void DbcDataModel::renameNetworkReferences(const QString& oldName, const QString& newName)
+{
+    if (oldName == newName) {
+        return;
+    }
+
+    bool referenced = false;
+    for (Node& node : m_nodes) {
+        for (NodeNetworkAssociation& association : node.networks) {
+            if (association.networkName == oldName) {
+                association.networkName = newName;
+                referenced = true;
+            }
+        }
+    }
+    if (!referenced) {
+        return;
+    }
+
+    // Re-key the network level of the endpoint index
+    for (QMap<QString, MessageEndpoints>& networks : m_endpointIndex) {
+        auto it = networks.find(oldName);
+        if (it == networks.end()) {
+            continue;
+        }
+        MessageEndpoints moved = it.value();
+        networks.erase(it);
+        MessageEndpoints& target = networks[newName];
+        target.transmitters += moved.transmitters;
+        target.receivers += moved.receivers;
+    }
+}
+
+QList<std::pair<QString, QString>> DbcDataModel::messageTransmitters(const Message& message) const
+{
+    return endpointNodes(message.name, &MessageEndpoints::transmitters);
+}
+
+QList<std::pair<QString, QString>> DbcDataModel::messageReceivers(const Message& message) const
+{
+    return endpointNodes(message.name, &MessageEndpoints::receivers);
+}
+
+QList<std::pair<QString, QString>> DbcDataModel::endpointNodes(const QString& messageName,
+                                                               QList<NodeNetworkRef> MessageEndpoints::*endpoints) const
+{
+    // Names and addresses are read from the nodes, so node renames need no index update
+    QList<std::pair<QString, QString>> result;
+    const QMap<QString, MessageEndpoints> networks = m_endpointIndex.value(messageName);
+    for (const MessageEndpoints& networkEndpoints : networks) {
+        for (const NodeNetworkRef& ref : networkEndpoints.*endpoints) {
+            const Node& node = m_nodes.at(ref.nodeIndex);
+            result.append(std::make_pair(node.name, QString::number(node.networks.at(ref.associationIndex).sourceAddress)));
+        }
+    }
+    return result;
+}
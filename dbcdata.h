@@ -6,12 +6,18 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QVariant>
+#include <QHash>
+#include <QMap>
+#include <functional>
+
+class JsonPullReader;
 
 class Attribute {
     public:
         QString name;
         QString type;
         QString value;
+        QString range;           // BA_DEF_ text after the type: min and max, or the ENUM labels
 };
 
 class TxRxMessage {
@@ -84,30 +90,85 @@ class Message {
         QList<Signal> messageSignals;      // Optional, defaults to empty list
         QList<Network> messageNetworks;      // Optional, defaults to empty list
         QList<Attribute> messageAttributes;  // Optional, defaults to empty list
-        QList<std::pair<QString, QString>> messageTransmitters; // Pair of transmitting node name and source address
-        QList<std::pair<QString, QString>> messageReceivers;    // Pair of receiving node name and source address
+};
+
+// A node's association with a network, as indexes into DbcDataModel::nodes() and Node::networks
+struct NodeNetworkRef {
+    int nodeIndex = -1;
+    int associationIndex = -1;
+};
+
+// Nodes transmitting and receiving a message on one network
+struct MessageEndpoints {
+    QList<NodeNetworkRef> transmitters;
+    QList<NodeNetworkRef> receivers;
 };
 
 class DbcDataModel {
     public:
+        // Receives the load progress in percent, returns false to cancel
+        using ProgressCallback = std::function<bool(int percent)>;
+
+        // Written as "format_version" in JSON workspaces. Version 2 stores is_bigEndian with the
+        // DBC meaning (@0 Motorola); files without the key are taken as written by hand.
+        static constexpr int JsonFormatVersion = 2;
+
         DbcDataModel();
 
         void setFileName(const QString& name);
-        bool loadJson(const QString& filePath);
-        bool importDBC(const QString& filePath);
+        bool loadJson(const QString& filePath, const ProgressCallback& progress = ProgressCallback());
+        bool importDBC(const QString& filePath, const ProgressCallback& progress = ProgressCallback());
+        // A DBC file describes one network, models holding more are refused
+        bool exportDBC(const QString& filePath) const;
         QString fileName() const;
 
         QList<Network>& networks();
         QList<Node>& nodes();
         QList<Message>& messages();
 
+        // Message lookup through the PGN and case-folded name indexes
+        Message* findMessageByPgn(quint64 pgn);
+        Message* findMessageByName(const QString& name);
+
+        // Edits that change an indexed key must go through these so the indexes stay in sync.
+        // Both return false if the message does not belong to this model. A rename is also
+        // applied to the tx/rx lists referencing the message.
+        bool setMessagePgn(Message& message, quint64 pgn);
+        bool setMessageName(Message& message, const QString& name);
+
+        // Points the node associations of a renamed network at the new name
+        void renameNetworkReferences(const QString& oldName, const QString& newName);
+
+        // Rebuild both indexes, required after m_messages is reordered or replaced
+        void rebuildMessageIndex();
+
+        // Transmitters and receivers of a message by network name, from the nodes' tx/rx lists
+        QMap<QString, MessageEndpoints> messageEndpoints(const QString& messageName) const;
+
+        // Pairs of node name and source address transmitting or receiving a message
+        QList<std::pair<QString, QString>> messageTransmitters(const Message& message) const;
+        QList<std::pair<QString, QString>> messageReceivers(const Message& message) const;
+
+        // Rebuild the endpoint index, required after m_nodes, a tx/rx list or a network name changes
+        void rebuildEndpointIndex();
+
     private:
         QString m_fileName;
         QList<Network> m_networks;
         QList<Node> m_nodes;
         QList<Message> m_messages;
 
-        void parseJson(const QJsonObject& jsonObject);
+        QHash<quint64, int> m_pgnIndex;     // PGN -> index into m_messages (first match)
+        QHash<QString, int> m_nameIndex;    // Case-folded, trimmed name -> index into m_messages
+        QHash<QString, QMap<QString, MessageEndpoints>> m_endpointIndex;  // Message name -> network name -> endpoints
+
+        bool parseJson(JsonPullReader& reader, const std::function<bool()>& reportProgress);
+        int indexOfMessage(const Message& message) const;
+        void indexMessage(int index);
+        static QString nameKey(const QString& name);
+        void renameMessageReferences(const QString& oldName, const QString& newName);
+        QList<std::pair<QString, QString>> endpointNodes(const QString& messageName,
+                                                         QList<NodeNetworkRef> MessageEndpoints::*endpoints) const;
 };
 
 #endif // DBCDATA
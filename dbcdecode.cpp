@@ -0,0 +1,130 @@
+#include "dbcdecode.h"
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "dbcsignalplan.h"
+
+// Bit numbering and windows are described in dbcsignalplan.h
+
+namespace {
+
+// Signal bits read one at a time, bytes past size read as zero
+quint64 readBits(const uchar* payload, int size, int startBit, int bitLength, bool bigEndian)
+{
+    auto bitAt = [&](int byte, int bit) -> quint64 {
+        return byte < size ? (payload[byte] >> bit) & 1 : 0;
+    };
+    quint64 raw = 0;
+    if (bigEndian) {
+        const int msb = motorolaLinear(startBit);
+        for (int position = msb; position < msb + bitLength; ++position) {
+            raw = (raw << 1) | bitAt(position / 8, 7 - position % 8);
+        }
+    } else {
+        for (int i = 0; i < bitLength; ++i) {
+            const int bit = startBit + i;
+            raw |= bitAt(bit / 8, bit % 8) << i;
+        }
+    }
+    return raw;
+}
+
+}
+
+MessageDecoder::MessageDecoder(const Message& message)
+{
+    m_signalCount = message.messageSignals.size();
+
+    for (int i = 0; i < m_signalCount; ++i) {
+        const Signal& signal = message.messageSignals[i];
+        const int length = signal.bitLength;
+        const bool valid = length > 0 && length <= 64 && signal.startBit >= 0;
+        m_layouts.push_back({i, signal.startBit, length, signal.isBigEndian, signal.isTwosComplement, valid,
+                             signal.factor, signal.offset});
+
+        Step step{};
+        step.index = quint32(i);
+        step.mask = lowMask(length);
+        step.extendShift = signal.isTwosComplement ? quint8(64 - length) : 0;
+        step.factor = signal.factor;
+        step.offset = signal.offset;
+
+        // Position of the lowest signal bit within a window starting at the byte holding the
+        // first signal bit, and whether the whole signal fits into that window
+        bool fits = false;
+        if (valid) {
+            const SignalWindow window = SignalWindow::of(signal);
+            step.byteOffset = window.byteOffset;
+            step.shift = window.shift;
+            fits = window.fits;
+        }
+
+        // Unsigned 64-bit values would turn negative through the signed conversion
+        if (!fits || (length == 64 && !signal.isTwosComplement)) {
+            m_wide.push_back({i, signal.startBit, length, signal.isBigEndian, signal.isTwosComplement, valid,
+                              signal.factor, signal.offset});
+            continue;
+        }
+
+        (signal.isBigEndian ? m_bigEndian : m_littleEndian).push_back(step);
+        m_windowEnd = std::max(m_windowEnd, int(step.byteOffset) + 8);
+    }
+    sortByWindow(m_littleEndian);
+    sortByWindow(m_bigEndian);
+}
+
+void MessageDecoder::decode(const uchar* payload, int size, double* values) const
+{
+    // Every window is read as a whole 8 bytes. When the payload is shorter than the windows
+    // reach, the sorted steps past its end read a zero-padded copy of their window instead.
+    auto bigEndianEnd = m_bigEndian.end();
+    auto littleEndianEnd = m_littleEndian.end();
+    if (size < m_windowEnd) {
+        littleEndianEnd = firstPastEnd(m_littleEndian, size);
+        bigEndianEnd = firstPastEnd(m_bigEndian, size);
+    }
+
+    auto decodeStep = [values](const Step& step, quint64 word) {
+        const quint64 raw = (word >> step.shift) & step.mask;
+        const qint64 value = qint64(raw << step.extendShift) >> step.extendShift;
+        values[step.index] = double(value) * step.factor + step.offset;
+    };
+    uchar window[8];
+
+    for (auto step = m_littleEndian.begin(); step != littleEndianEnd; ++step) {
+        decodeStep(*step, qFromLittleEndian<quint64>(payload + step->byteOffset));
+    }
+    for (auto step = littleEndianEnd; step != m_littleEndian.end(); ++step) {
+        copyWindow(payload, size, step->byteOffset, window);
+        decodeStep(*step, qFromLittleEndian<quint64>(window));
+    }
+
+    for (auto step = m_bigEndian.begin(); step != bigEndianEnd; ++step) {
+        decodeStep(*step, qFromBigEndian<quint64>(payload + step->byteOffset));
+    }
+    for (auto step = bigEndianEnd; step != m_bigEndian.end(); ++step) {
+        copyWindow(payload, size, step->byteOffset, window);
+        decodeStep(*step, qFromBigEndian<quint64>(window));
+    }
+
+    for (const WideSignal& signal : m_wide) {
+        if (!signal.valid) {
+            values[signal.index] = std::numeric_limits<double>::quiet_NaN();
+            continue;
+        }
+        const quint64 raw = readBits(payload, size, signal.startBit, signal.bitLength, signal.bigEndian);
+        double value = double(raw);
+        if (signal.twosComplement) {
+            const int extendShift = 64 - signal.bitLength;
+            value = double(qint64(raw << extendShift) >> extendShift);
+        }
+        values[signal.index] = value * signal.factor + signal.offset;
+    }
+}
+
+quint64 MessageDecoder::raw(const uchar* payload, int size, int index) const
+{
+    const WideSignal& signal = m_layouts[size_t(index)];
+    return signal.valid ? readBits(payload, size, signal.startBit, signal.bitLength, signal.bigEndian) : 0;
+}
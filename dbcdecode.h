@@ -0,0 +1,61 @@
+#ifndef DBCDECODE_H
+#define DBCDECODE_H
+
+#include <QtGlobal>
+#include <vector>
+#include "dbcdata.h"
+
+// Decoder for the payload of one Message, compiled from its signals. Compiling works out for
+// every signal which 8 bytes to load, the shift, mask, sign extension and scaling, so decode()
+// applies the same few operations to every signal. Signals are grouped by byte order to keep
+// the loops free of per-signal branches; the rare signals that do not fit into one 8-byte
+// window are decoded bit by bit afterwards.
+class MessageDecoder {
+    public:
+        MessageDecoder() = default;
+        explicit MessageDecoder(const Message& message);
+
+        // One value per signal, in Message::messageSignals order
+        int signalCount() const { return m_signalCount; }
+
+        // Writes raw * factor + offset of every signal to values. Bytes past size read as zero,
+        // signals with an impossible layout decode to NaN. Multiplexed signals are decoded
+        // whatever the multiplexer value is.
+        void decode(const uchar* payload, int size, double* values) const;
+
+        // Bits of one signal before sign extension and scaling, the form multiplexer values
+        // are given in. 0 for signals with an impossible layout.
+        quint64 raw(const uchar* payload, int size, int index) const;
+
+    private:
+        struct Step {
+            quint32 byteOffset;     // First byte of the 8-byte window holding the signal
+            quint32 index;          // Position in values
+            quint64 mask;           // Signal bits after shifting them down
+            quint8 shift;           // Position of the lowest signal bit in the window
+            quint8 extendShift;     // 64 - bitLength for two's complement signals, else 0
+            double factor;
+            double offset;
+        };
+
+        // Signals read bit by bit: wider than their window, 64-bit unsigned or invalid
+        struct WideSignal {
+            int index;
+            int startBit;
+            int bitLength;
+            bool bigEndian;
+            bool twosComplement;
+            bool valid;
+            double factor;
+            double offset;
+        };
+
+        std::vector<Step> m_littleEndian;      // Sorted by window
+        std::vector<Step> m_bigEndian;         // Sorted by window
+        std::vector<WideSignal> m_wide;
+        std::vector<WideSignal> m_layouts;     // Every signal by index, for raw()
+        int m_signalCount = 0;
+        int m_windowEnd = 0;        // Bytes the windows reach, shorter payloads read the last ones through a copy
+};
+
+#endif // DBCDECODE_H
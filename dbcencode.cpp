@@ -0,0 +1,155 @@
+#include "dbcencode.h"
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "dbcsignalplan.h"
+
+// Bit numbering and windows are the same as for MessageDecoder, see dbcsignalplan.h
+
+namespace {
+
+// Raw field value for a physical value, or nothing to write for NaN. The clamps keep the
+// conversion to an integer defined; only two's complement fields have a negative rawMinimum.
+bool rawValue(double value, double inverseFactor, double offset, double minimum, double maximum,
+              double rawMinimum, double rawMaximum, quint64& raw)
+{
+    if (std::isnan(value)) {
+        return false;
+    }
+    const double physical = std::clamp(value, minimum, maximum);
+    const double scaled = std::clamp(std::nearbyint((physical - offset) * inverseFactor), rawMinimum, rawMaximum);
+    raw = scaled < 0 ? quint64(qint64(scaled)) : quint64(scaled);
+    return true;
+}
+
+// Largest integer a double holds below 2^exponent, 2^exponent - 1 up to 53 bits. Past that
+// 2^exponent - 1 would round up and no longer fit the field.
+double belowPowerOfTwo(int exponent)
+{
+    return exponent <= 53 ? std::ldexp(1.0, exponent) - 1 : std::nextafter(std::ldexp(1.0, exponent), 0.0);
+}
+
+}
+
+MessageEncoder::MessageEncoder(const Message& message)
+{
+    m_signalCount = message.messageSignals.size();
+    m_payloadSize = message.length;
+
+    for (int i = 0; i < m_signalCount; ++i) {
+        const Signal& signal = message.messageSignals[i];
+        const int length = signal.bitLength;
+        if (length <= 0 || length > 64 || signal.startBit < 0) {
+            continue;
+        }
+
+        Step step{};
+        step.index = quint32(i);
+        step.mask = lowMask(length);
+        step.inverseFactor = signal.factor != 0.0 ? 1.0 / signal.factor : 0.0;
+        step.offset = signal.offset;
+
+        // DBC writes [0|0] for signals without a range
+        step.minimum = -std::numeric_limits<double>::infinity();
+        step.maximum = std::numeric_limits<double>::infinity();
+        bool minimumOk = false;
+        bool maximumOk = false;
+        const double minimum = signal.scaledMin.toDouble(&minimumOk);
+        const double maximum = signal.scaledMax.toDouble(&maximumOk);
+        if (minimumOk && maximumOk && minimum < maximum) {
+            step.minimum = minimum;
+            step.maximum = maximum;
+        }
+
+        if (signal.isTwosComplement) {
+            step.rawMinimum = -std::ldexp(1.0, length - 1);
+            step.rawMaximum = belowPowerOfTwo(length - 1);
+        } else {
+            step.rawMinimum = 0;
+            step.rawMaximum = belowPowerOfTwo(length);
+        }
+
+        const SignalWindow window = SignalWindow::of(signal);
+        step.byteOffset = window.byteOffset;
+        step.shift = window.shift;
+        const bool fits = window.fits;
+
+        if (!fits || (length == 64 && !signal.isTwosComplement)) {
+            m_wide.push_back({step, signal.startBit, length, signal.isBigEndian});
+            continue;
+        }
+
+        (signal.isBigEndian ? m_bigEndian : m_littleEndian).push_back(step);
+        m_windowEnd = std::max(m_windowEnd, int(step.byteOffset) + 8);
+    }
+    sortByWindow(m_littleEndian);
+    sortByWindow(m_bigEndian);
+}
+
+void MessageEncoder::encode(const double* values, uchar* payload, int size) const
+{
+    // Windows are read and written as whole 8 bytes. When the payload is shorter than the
+    // windows reach, the sorted steps past its end go through a copy of their window instead.
+    auto littleEndianEnd = m_littleEndian.end();
+    auto bigEndianEnd = m_bigEndian.end();
+    if (size < m_windowEnd) {
+        littleEndianEnd = firstPastEnd(m_littleEndian, size);
+        bigEndianEnd = firstPastEnd(m_bigEndian, size);
+    }
+
+    // Bits of the step's signal in word, or the word unchanged for a NaN value
+    auto encodeStep = [values](const Step& step, quint64 word) {
+        quint64 raw = 0;
+        const quint64 mask = rawValue(values[step.index], step.inverseFactor, step.offset, step.minimum, step.maximum,
+                                      step.rawMinimum, step.rawMaximum, raw) ? step.mask << step.shift : 0;
+        return (word & ~mask) | ((raw << step.shift) & mask);
+    };
+    uchar window[8];
+
+    for (auto step = m_littleEndian.begin(); step != littleEndianEnd; ++step) {
+        uchar* target = payload + step->byteOffset;
+        qToLittleEndian<quint64>(encodeStep(*step, qFromLittleEndian<quint64>(target)), target);
+    }
+    for (auto step = littleEndianEnd; step != m_littleEndian.end(); ++step) {
+        copyWindow(payload, size, step->byteOffset, window);
+        qToLittleEndian<quint64>(encodeStep(*step, qFromLittleEndian<quint64>(window)), window);
+        writeBackWindow(window, size, step->byteOffset, payload);
+    }
+
+    for (auto step = m_bigEndian.begin(); step != bigEndianEnd; ++step) {
+        uchar* target = payload + step->byteOffset;
+        qToBigEndian<quint64>(encodeStep(*step, qFromBigEndian<quint64>(target)), target);
+    }
+    for (auto step = bigEndianEnd; step != m_bigEndian.end(); ++step) {
+        copyWindow(payload, size, step->byteOffset, window);
+        qToBigEndian<quint64>(encodeStep(*step, qFromBigEndian<quint64>(window)), window);
+        writeBackWindow(window, size, step->byteOffset, payload);
+    }
+
+    for (const WideSignal& signal : m_wide) {
+        const Step& step = signal.step;
+        quint64 raw = 0;
+        if (!rawValue(values[step.index], step.inverseFactor, step.offset, step.minimum, step.maximum,
+                      step.rawMinimum, step.rawMaximum, raw)) {
+            continue;
+        }
+        auto setBit = [&](int byte, int bit, quint64 value) {
+            if (byte < size) {
+                payload[byte] = uchar((payload[byte] & ~(1u << bit)) | (uint(value) << bit));
+            }
+        };
+        if (signal.bigEndian) {
+            const int msb = motorolaLinear(signal.startBit);
+            for (int i = 0; i < signal.bitLength; ++i) {
+                const int position = msb + signal.bitLength - 1 - i;
+                setBit(position / 8, 7 - position % 8, (raw >> i) & 1);
+            }
+        } else {
+            for (int i = 0; i < signal.bitLength; ++i) {
+                const int bit = signal.startBit + i;
+                setBit(bit / 8, bit % 8, (raw >> i) & 1);
+            }
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef DBCENCODE_H
+#define DBCENCODE_H
+
+#include <QtGlobal>
+#include <vector>
+#include "dbcdata.h"
+
+// Packs physical signal values into the payload of one Message, the counterpart of
+// MessageDecoder. Compiling precomputes per signal the window, shift and mask, the inverse
+// scaling and the clamping limits, so encode() is one pass per byte order over flat steps and
+// never allocates.
+class MessageEncoder {
+    public:
+        MessageEncoder() = default;
+        explicit MessageEncoder(const Message& message);
+
+        // One value per signal, in Message::messageSignals order
+        int signalCount() const { return m_signalCount; }
+
+        // Message::length, the payload size the message is sent with
+        int payloadSize() const { return m_payloadSize; }
+
+        // Writes every value into its signal's bits of payload. Values are clamped to
+        // [scaledMin, scaledMax] when the signal has such a range, and to what the raw field can
+        // hold. A NaN value leaves its signal's bits untouched, as do bits outside any signal, so
+        // callers clear the buffer first and pass NaN for inactive multiplexed signals. Bits
+        // past size are dropped. Raw values go through a double, so fields wider than 53 bits
+        // are only as precise as one: an unsigned 64-bit field holds at most 2^64 - 2048.
+        void encode(const double* values, uchar* payload, int size) const;
+
+    private:
+        struct Step {
+            quint32 byteOffset;     // First byte of the 8-byte window holding the signal
+            quint32 index;          // Position in values
+            quint64 mask;           // Signal bits before shifting them up
+            quint8 shift;           // Position of the lowest signal bit in the window
+            double inverseFactor;   // 1 / factor, 0 for a zero factor
+            double offset;
+            double minimum;         // Physical range, infinite if the signal has none
+            double maximum;
+            double rawMinimum;      // Range of the raw field
+            double rawMaximum;
+        };
+
+        // Signals written bit by bit: wider than their window or 64-bit unsigned. Invalid
+        // layouts are dropped when compiling.
+        struct WideSignal {
+            Step step;
+            int startBit;
+            int bitLength;
+            bool bigEndian;
+        };
+
+        std::vector<Step> m_littleEndian;      // Sorted by window
+        std::vector<Step> m_bigEndian;         // Sorted by window
+        std::vector<WideSignal> m_wide;
+        int m_signalCount = 0;
+        int m_payloadSize = 0;
+        int m_windowEnd = 0;        // Bytes the windows reach, shorter payloads write the last ones through a copy
+};
+
+#endif // DBCENCODE_H
@@ -0,0 +1,221 @@
+#include "dbcquery.h"
+#include "j1939.h"
+#include <QRegularExpression>
+
+void DbcQueryEngine::setModels(const QList<DbcDataModel*>& models)
+{
+    m_models = models;
+    m_indexes.clear();
+}
+
+void DbcQueryEngine::addModel(DbcDataModel* model)
+{
+    if (!m_models.contains(model)) {
+        m_models.append(model);
+    }
+    m_indexes.remove(model);
+}
+
+void DbcQueryEngine::removeModel(DbcDataModel* model)
+{
+    m_models.removeAll(model);
+    m_indexes.remove(model);
+}
+
+void DbcQueryEngine::invalidate(DbcDataModel* model)
+{
+    if (model) {
+        m_indexes.remove(model);
+    } else {
+        m_indexes.clear();
+    }
+}
+
+void DbcQueryEngine::splitTerms(const QString& text, QStringList& fieldTerms, QStringList& plainWords)
+{
+    static const QRegularExpression whitespace("\\s+");
+    const QStringList words = text.split(whitespace, Qt::SkipEmptyParts);
+    for (const QString& word : words) {
+        if (word.startsWith("pgn:", Qt::CaseInsensitive) || word.startsWith("spn:", Qt::CaseInsensitive) ||
+            word.startsWith("attr:", Qt::CaseInsensitive)) {
+            fieldTerms.append(word);
+        } else {
+            plainWords.append(word);
+        }
+    }
+}
+
+bool DbcQueryEngine::run(const QStringList& fieldTerms, QHash<DbcDataModel*, DbcQueryMatches>& results)
+{
+    results.clear();
+    bool first = true;
+    bool malformed = false;
+
+    for (const QString& term : fieldTerms) {
+        const int colon = term.indexOf(':');
+        const QString field = term.left(colon).toLower();
+        const QString argument = term.mid(colon + 1);
+
+        // Parse the term once, then look it up in every model
+        quint64 pgn = 0;
+        int spn = 0;
+        QString attributeName;
+        QString attributeValue;
+        bool anyValue = false;
+        bool ok = false;
+        if (field == "pgn") {
+            pgn = argument.startsWith("0x", Qt::CaseInsensitive) ? argument.mid(2).toULongLong(&ok, 16)
+                                                                 : argument.toULongLong(&ok, 10);
+        } else if (field == "spn") {
+            spn = argument.toInt(&ok);
+        } else if (field == "attr") {
+            const int equals = argument.indexOf('=');
+            attributeName = fold(equals < 0 ? argument : argument.left(equals));
+            attributeValue = equals < 0 ? QString() : fold(argument.mid(equals + 1));
+            anyValue = equals < 0;
+            ok = !attributeName.isEmpty();
+        }
+        // A malformed term matches nothing, rather than being left out of the query
+        malformed = malformed || !ok;
+
+        for (DbcDataModel* model : m_models) {
+            const ModelIndex& index = indexFor(model);
+            DbcQueryMatches termMatches;
+
+            if (!ok) {
+                // Nothing to look up
+            } else if (field == "pgn") {
+                for (int message : index.pgns.value(pgn)) {
+                    termMatches.messages.insert(message);
+                }
+            } else if (field == "spn") {
+                for (int message : index.spns.value(spn)) {
+                    termMatches.signalMessages.insert(message);
+                }
+            } else {
+                auto values = index.attributes.constFind(attributeName);
+                if (values != index.attributes.constEnd()) {
+                    if (anyValue) {
+                        for (const AttributeOwners& owners : values.value()) {
+                            addOwners(owners, termMatches);
+                        }
+                    } else {
+                        auto owners = values.value().constFind(attributeValue);
+                        if (owners != values.value().constEnd()) {
+                            addOwners(owners.value(), termMatches);
+                        }
+                    }
+                }
+            }
+
+            if (first) {
+                results.insert(model, termMatches);
+            } else if (results.contains(model)) {
+                intersect(results[model], termMatches);
+            }
+        }
+        first = false;
+    }
+    return !malformed;
+}
+
+DbcQueryEngine::ModelIndex& DbcQueryEngine::indexFor(DbcDataModel* model)
+{
+    ModelIndex& index = m_indexes[model];
+    if (!index.built) {
+        build(model, index);
+    }
+    return index;
+}
+
+void DbcQueryEngine::build(DbcDataModel* model, ModelIndex& index)
+{
+    index = ModelIndex();
+
+    auto addAttributes = [&index](const QList<Attribute>& attributes, QList<int> AttributeOwners::*owners, int owner) {
+        for (const Attribute& attribute : attributes) {
+            QList<int>& list = index.attributes[fold(attribute.name)][fold(attribute.value)].*owners;
+            if (list.isEmpty() || list.last() != owner) {
+                list.append(owner);
+            }
+        }
+    };
+
+    const QList<Network>& networks = model->networks();
+    for (int i = 0; i < networks.size(); ++i) {
+        addAttributes(networks[i].networkAttributes, &AttributeOwners::networks, i);
+    }
+
+    const QList<Node>& nodes = model->nodes();
+    for (int i = 0; i < nodes.size(); ++i) {
+        addAttributes(nodes[i].nodeAttributes, &AttributeOwners::nodes, i);
+    }
+
+    const QList<Message>& messages = model->messages();
+    index.pgns.reserve(messages.size());
+    for (int i = 0; i < messages.size(); ++i) {
+        const Message& message = messages[i];
+        // Imported messages hold the BO_ identifier, which is found under its PGN as well
+        const quint64 pgn = J1939Id::pgnOf(message.pgn);
+        index.pgns[pgn].append(i);
+        if (pgn != message.pgn) {
+            index.pgns[message.pgn].append(i);
+        }
+        addAttributes(message.messageAttributes, &AttributeOwners::messages, i);
+
+        for (const Signal& signal : message.messageSignals) {
+            // SPN 0 is what signals without one carry, spn:0 finds none of them
+            if (signal.spn != 0) {
+                QList<int>& spnMessages = index.spns[signal.spn];
+                if (spnMessages.isEmpty() || spnMessages.last() != i) {
+                    spnMessages.append(i);
+                }
+            }
+            addAttributes(signal.signalAttributes, &AttributeOwners::signalMessages, i);
+        }
+    }
+
+    index.built = true;
+}
+
+// Attribute names and values compare case-insensitively, ignoring surrounding quotes and spaces
+QString DbcQueryEngine::fold(const QString& text)
+{
+    QString folded = text.trimmed();
+    if (folded.size() >= 2 && folded.startsWith('"') && folded.endsWith('"')) {
+        folded = folded.mid(1, folded.size() - 2).trimmed();
+    }
+    return folded.toCaseFolded();
+}
+
+void DbcQueryEngine::addOwners(const AttributeOwners& owners, DbcQueryMatches& matches)
+{
+    for (int network : owners.networks) {
+        matches.networks.insert(network);
+    }
+    for (int node : owners.nodes) {
+        matches.nodes.insert(node);
+    }
+    for (int message : owners.messages) {
+        matches.messages.insert(message);
+    }
+    for (int message : owners.signalMessages) {
+        matches.signalMessages.insert(message);
+    }
+}
+
+// Keeps what both terms matched. A message matched on its own fields by either term stays an
+// own match, otherwise it is kept as a match through its signals.
+void DbcQueryEngine::intersect(DbcQueryMatches& matches, const DbcQueryMatches& term)
+{
+    matches.networks.intersect(term.networks);
+    matches.nodes.intersect(term.nodes);
+
+    QSet<int> kept = matches.messages + matches.signalMessages;
+    kept.intersect(term.messages + term.signalMessages);
+
+    QSet<int> own = matches.messages + term.messages;
+    own.intersect(kept);
+    matches.messages = own;
+    matches.signalMessages = kept - own;
+}
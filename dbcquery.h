@@ -0,0 +1,69 @@
+#ifndef DBCQUERY_H
+#define DBCQUERY_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include "dbcdata.h"
+
+// Items of one model matched by a query, as indexes into the model's lists
+struct DbcQueryMatches {
+    QSet<int> networks;
+    QSet<int> nodes;
+    QSet<int> messages;         // Messages matching on their own fields
+    QSet<int> signalMessages;   // Messages matching through one of their signals
+};
+
+// Field-qualified lookups over the loaded DbcDataModels. Supported terms, all of which must match:
+//   pgn:0xFEF1 or pgn:65265     messages with that PGN, or that DBC identifier
+//   spn:190                     messages with a signal carrying that SPN
+//   attr:Name=Value             networks, nodes, messages and signals with that attribute value
+//   attr:Name                   the same, with any value
+// A pgn: or spn: argument that is not a number, or an attr: without a name, matches nothing.
+// Signals without an SPN (0) are not indexed. Each model gets its own PGN, SPN and attribute
+// indexes, built on the first query after the model was added or invalidated.
+class DbcQueryEngine {
+    public:
+        void setModels(const QList<DbcDataModel*>& models);
+        void addModel(DbcDataModel* model);
+        void removeModel(DbcDataModel* model);
+
+        // Marks the indexes of a model, or of every model, as stale after an edit
+        void invalidate(DbcDataModel* model = nullptr);
+
+        // Splits text into field-qualified terms and the remaining plain words
+        static void splitTerms(const QString& text, QStringList& fieldTerms, QStringList& plainWords);
+
+        // Runs the field-qualified terms. Every model gets an entry in results; returns false if
+        // a term is malformed, in which case all entries are empty.
+        bool run(const QStringList& fieldTerms, QHash<DbcDataModel*, DbcQueryMatches>& results);
+
+    private:
+        // Owners of one attribute value
+        struct AttributeOwners {
+            QList<int> networks;
+            QList<int> nodes;
+            QList<int> messages;
+            QList<int> signalMessages;
+        };
+
+        struct ModelIndex {
+            bool built = false;
+            QHash<quint64, QList<int>> pgns;                                // PGN -> messages
+            QHash<int, QList<int>> spns;                                    // SPN -> messages
+            QHash<QString, QHash<QString, AttributeOwners>> attributes;     // Folded name -> folded value -> owners
+        };
+
+        QList<DbcDataModel*> m_models;
+        QHash<DbcDataModel*, ModelIndex> m_indexes;
+
+        ModelIndex& indexFor(DbcDataModel* model);
+        static void build(DbcDataModel* model, ModelIndex& index);
+        static QString fold(const QString& text);
+        static void addOwners(const AttributeOwners& owners, DbcQueryMatches& matches);
+        static void intersect(DbcQueryMatches& matches, const DbcQueryMatches& term);
+};
+
+#endif // DBCQUERY_H
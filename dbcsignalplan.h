@@ -0,0 +1,85 @@
+#ifndef DBCSIGNALPLAN_H
+#define DBCSIGNALPLAN_H
+
+#include <QtGlobal>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "dbcdata.h"
+
+// Signal layout shared by MessageDecoder and MessageEncoder. Bit numbering follows DBC. Intel
+// (little endian) signals name their least significant bit, counting from bit 0 of byte 0
+// upwards. Motorola (big endian) signals name their most significant bit in the same numbering,
+// and continue into the following bytes; "linear" positions number the bits of a Motorola
+// payload from the MSB of byte 0 onwards.
+
+inline int motorolaLinear(int startBit)
+{
+    return (startBit / 8) * 8 + (7 - startBit % 8);
+}
+
+inline quint64 lowMask(int bitLength)
+{
+    return bitLength >= 64 ? ~quint64(0) : (quint64(1) << bitLength) - 1;
+}
+
+// The 8 bytes a signal is read from or written to as one word
+struct SignalWindow {
+    quint32 byteOffset = 0;     // First byte of the window, the one holding the first signal bit
+    quint8 shift = 0;           // Position of the lowest signal bit in the window
+    bool fits = false;          // Whether the whole signal lies within the window
+
+    // For signals of 1 to 64 bits starting at a non-negative bit
+    static SignalWindow of(const Signal& signal) {
+        SignalWindow window;
+        if (!signal.isBigEndian) {
+            window.byteOffset = quint32(signal.startBit / 8);
+            window.shift = quint8(signal.startBit % 8);
+            window.fits = window.shift + signal.bitLength <= 64;
+        } else {
+            const int msb = motorolaLinear(signal.startBit);
+            window.byteOffset = quint32(msb / 8);
+            const int lastBit = msb % 8 + signal.bitLength - 1;   // Linear position of the LSB in the window
+            window.shift = quint8(63 - std::min(lastBit, 63));
+            window.fits = lastBit <= 63;
+        }
+        return window;
+    }
+};
+
+// Steps ordered by window, so the ones reaching past the end of a short payload are a tail
+template <typename Step>
+void sortByWindow(std::vector<Step>& steps)
+{
+    std::stable_sort(steps.begin(), steps.end(), [](const Step& a, const Step& b) {
+        return a.byteOffset < b.byteOffset;
+    });
+}
+
+// First step of a sorted list whose window does not lie within size bytes
+template <typename Step>
+typename std::vector<Step>::const_iterator firstPastEnd(const std::vector<Step>& steps, int size)
+{
+    return std::partition_point(steps.begin(), steps.end(), [size](const Step& step) {
+        return qint64(step.byteOffset) + 8 <= size;
+    });
+}
+
+// Copies the part of a window that lies within size bytes, the rest of window reads as zero
+inline void copyWindow(const uchar* payload, int size, quint32 byteOffset, uchar* window)
+{
+    std::memset(window, 0, 8);
+    if (qint64(byteOffset) < size) {
+        std::memcpy(window, payload + byteOffset, size_t(std::min<qint64>(8, size - qint64(byteOffset))));
+    }
+}
+
+// Writes back the part of a window copied by copyWindow
+inline void writeBackWindow(const uchar* window, int size, quint32 byteOffset, uchar* payload)
+{
+    if (qint64(byteOffset) < size) {
+        std::memcpy(payload + byteOffset, window, size_t(std::min<qint64>(8, size - qint64(byteOffset))));
+    }
+}
+
+#endif // DBCSIGNALPLAN_H
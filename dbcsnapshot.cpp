@@ -0,0 +1,793 @@
+#include "dbcsnapshot.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QHash>
+#include <QDebug>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// File layout, version 2. Integers are in the byte order of the writing machine, checked
+// through byteOrder on load, and every section starts on an 8-byte boundary.
+//
+//   FileHeader
+//   StringEntry[stringCount]       offset and length in UTF-16 units into the string data
+//   char16_t[stringDataSize]       string data; string id 0 is the empty string
+//   ModelRecord[modelCount]        one Section per record array of the model
+//   per model: NetworkRecord[], NodeRecord[], AssociationRecord[], quint32[] (tx/rx message
+//              names), MessageRecord[], SignalRecord[], EnumerationRecord[], AttributeRecord[]
+//
+// Objects point at their children with a Range into the next array down and at text by string
+// id. Each Section also stores its record size, so fields can be appended to a record in a later
+// version without breaking older readers.
+//
+// Version 2 has the layout of version 1. It marks snapshots whose isBigEndian follows the DBC
+// byte order (@0 Motorola); version 1 ones may hold the inverted flag importDBC used to store.
+// AttributeRecord::range was appended later; records written without it read as no range.
+
+const char* const DbcSnapshot::Suffix = "hiws";
+
+namespace {
+
+constexpr char Magic[4] = {'H', 'I', 'W', 'S'};
+constexpr quint16 Version = 2;
+constexpr quint16 ByteOrderMark = 0x0102;
+
+struct FileHeader {
+    char magic[4];
+    quint16 version;
+    quint16 byteOrder;
+    quint32 modelCount;
+    quint32 stringCount;
+    quint64 stringIndexOffset;
+    quint64 stringDataOffset;
+    quint64 stringDataSize;
+    quint64 modelTableOffset;
+    quint64 fileSize;
+};
+
+struct StringEntry {
+    quint32 offset;
+    quint32 length;
+};
+
+struct Range {
+    quint32 first = 0;
+    quint32 count = 0;
+};
+
+enum SectionId {
+    NetworkSection,
+    NodeSection,
+    AssociationSection,
+    TxRxSection,
+    MessageSection,
+    SignalSection,
+    EnumerationSection,
+    AttributeSection,
+    SectionCount
+};
+
+struct Section {
+    quint64 offset;
+    quint32 count;
+    quint32 recordSize;
+};
+
+struct ModelRecord {
+    quint32 fileName;
+    quint32 reserved;
+    Section sections[SectionCount];
+};
+
+struct AttributeRecord {
+    quint32 name;
+    quint32 type;
+    quint32 value;
+    quint32 range;
+};
+
+struct NetworkRecord {
+    quint32 name;
+    quint32 baud;
+    Range attributes;
+};
+
+struct NodeRecord {
+    quint32 name;
+    quint32 reserved;
+    Range associations;
+    Range attributes;
+};
+
+struct AssociationRecord {
+    quint32 networkName;
+    qint32 sourceAddress;
+    Range tx;
+    Range rx;
+};
+
+struct MessageRecord {
+    quint64 pgn;
+    quint32 name;
+    quint32 description;
+    qint32 priority;
+    qint32 length;
+    qint32 txPeriodicity;
+    qint32 multiplexValue;
+    quint8 txOnChange;
+    quint8 dataPage;
+    quint8 extendedDataPage;
+    quint8 reserved;
+    quint32 reserved2;
+    Range messageSignals;
+    Range attributes;
+};
+
+enum VariantType : quint32 {
+    NullVariant,
+    BoolVariant,
+    IntVariant,
+    DoubleVariant,
+    StringVariant   // payload is a string id
+};
+
+struct VariantRecord {
+    quint32 type;
+    quint32 reserved;
+    quint64 payload;
+};
+
+enum SignalFlag : quint32 {
+    BigEndianFlag = 1,
+    TwosComplementFlag = 2,
+    MultiplexerFlag = 4
+};
+
+struct SignalRecord {
+    qint32 spn;
+    quint32 name;
+    quint32 description;
+    quint32 units;
+    qint32 startBit;
+    qint32 bitLength;
+    qint32 multiplexValue;
+    quint32 flags;
+    double factor;
+    double offset;
+    VariantRecord scaledMin;
+    VariantRecord scaledMax;
+    VariantRecord scaledDefault;
+    Range enumerations;
+    Range attributes;
+};
+
+struct EnumerationRecord {
+    quint32 name;
+    quint32 description;
+    qint32 value;
+};
+
+// The records are written as they are laid out in memory, these keep the layout fixed
+static_assert(sizeof(FileHeader) == 56, "FileHeader layout changed");
+static_assert(sizeof(ModelRecord) == 136, "ModelRecord layout changed");
+static_assert(sizeof(NetworkRecord) == 16, "NetworkRecord layout changed");
+static_assert(sizeof(NodeRecord) == 24, "NodeRecord layout changed");
+static_assert(sizeof(AssociationRecord) == 24, "AssociationRecord layout changed");
+static_assert(sizeof(MessageRecord) == 56, "MessageRecord layout changed");
+static_assert(sizeof(SignalRecord) == 112, "SignalRecord layout changed");
+static_assert(sizeof(EnumerationRecord) == 12, "EnumerationRecord layout changed");
+static_assert(sizeof(AttributeRecord) == 16, "AttributeRecord layout changed");
+
+// Record size written per section
+constexpr quint32 RecordSizes[SectionCount] = {
+    sizeof(NetworkRecord), sizeof(NodeRecord), sizeof(AssociationRecord), sizeof(quint32),
+    sizeof(MessageRecord), sizeof(SignalRecord), sizeof(EnumerationRecord), sizeof(AttributeRecord)
+};
+
+// Smallest record size a reader of this version accepts per section; fields past it are
+// appended ones that older files leave out
+constexpr quint32 MinimumRecordSizes[SectionCount] = {
+    sizeof(NetworkRecord), sizeof(NodeRecord), sizeof(AssociationRecord), sizeof(quint32),
+    sizeof(MessageRecord), sizeof(SignalRecord), sizeof(EnumerationRecord), offsetof(AttributeRecord, range)
+};
+
+quint64 aligned(quint64 offset)
+{
+    return (offset + 7) & ~quint64(7);
+}
+
+// ---------------------------------------------------------------------------------------------
+// Writing
+
+// Record arrays of one model, in SectionId order
+struct ModelRecords {
+    quint32 fileName = 0;
+    std::vector<NetworkRecord> networks;
+    std::vector<NodeRecord> nodes;
+    std::vector<AssociationRecord> associations;
+    std::vector<quint32> txRx;
+    std::vector<MessageRecord> messages;
+    std::vector<SignalRecord> signalRecords;
+    std::vector<EnumerationRecord> enumerations;
+    std::vector<AttributeRecord> attributes;
+
+    std::pair<const void*, size_t> section(int id) const
+    {
+        switch (id) {
+        case NetworkSection:     return {networks.data(), networks.size()};
+        case NodeSection:        return {nodes.data(), nodes.size()};
+        case AssociationSection: return {associations.data(), associations.size()};
+        case TxRxSection:        return {txRx.data(), txRx.size()};
+        case MessageSection:     return {messages.data(), messages.size()};
+        case SignalSection:      return {signalRecords.data(), signalRecords.size()};
+        case EnumerationSection: return {enumerations.data(), enumerations.size()};
+        default:                 return {attributes.data(), attributes.size()};
+        }
+    }
+};
+
+class SnapshotWriter {
+    public:
+        SnapshotWriter()
+        {
+            m_entries.push_back({0, 0});
+        }
+
+        void addModel(DbcDataModel* model)
+        {
+            ModelRecords records;
+            records.fileName = string(model->fileName());
+
+            for (const Network& network : model->networks()) {
+                records.networks.push_back({string(network.name), string(network.baud),
+                                            addAttributes(records, network.networkAttributes)});
+            }
+
+            for (const Node& node : model->nodes()) {
+                NodeRecord record{};
+                record.name = string(node.name);
+                record.attributes = addAttributes(records, node.nodeAttributes);
+                record.associations = {quint32(records.associations.size()), quint32(node.networks.size())};
+                for (const NodeNetworkAssociation& association : node.networks) {
+                    AssociationRecord associationRecord{};
+                    associationRecord.networkName = string(association.networkName);
+                    associationRecord.sourceAddress = association.sourceAddress;
+                    associationRecord.tx = addTxRx(records, association.tx);
+                    associationRecord.rx = addTxRx(records, association.rx);
+                    records.associations.push_back(associationRecord);
+                }
+                records.nodes.push_back(record);
+            }
+
+            for (const Message& message : model->messages()) {
+                MessageRecord record{};
+                record.pgn = message.pgn;
+                record.name = string(message.name);
+                record.description = string(message.description);
+                record.priority = message.priority;
+                record.length = message.length;
+                record.txPeriodicity = message.txPeriodicity;
+                record.multiplexValue = message.multiplexValue;
+                record.txOnChange = message.txOnChange;
+                record.dataPage = message.dataPage;
+                record.extendedDataPage = message.extendedDataPage;
+                record.attributes = addAttributes(records, message.messageAttributes);
+                record.messageSignals = {quint32(records.signalRecords.size()), quint32(message.messageSignals.size())};
+                for (const Signal& signal : message.messageSignals) {
+                    records.signalRecords.push_back(signalRecord(records, signal));
+                }
+                records.messages.push_back(record);
+            }
+
+            m_models.push_back(std::move(records));
+        }
+
+        bool write(QSaveFile& file)
+        {
+            // Lay out the file first so the header and section table can be written in order
+            FileHeader header{};
+            std::memcpy(header.magic, Magic, sizeof(Magic));
+            header.version = Version;
+            header.byteOrder = ByteOrderMark;
+            header.modelCount = quint32(m_models.size());
+            header.stringCount = quint32(m_entries.size());
+            header.stringIndexOffset = aligned(sizeof(FileHeader));
+            header.stringDataOffset = aligned(header.stringIndexOffset + m_entries.size() * sizeof(StringEntry));
+            header.stringDataSize = quint64(m_data.size());
+            header.modelTableOffset = aligned(header.stringDataOffset + header.stringDataSize * sizeof(char16_t));
+
+            std::vector<ModelRecord> table(m_models.size());
+            quint64 offset = aligned(header.modelTableOffset + table.size() * sizeof(ModelRecord));
+            for (size_t i = 0; i < m_models.size(); ++i) {
+                table[i] = ModelRecord{};
+                table[i].fileName = m_models[i].fileName;
+                for (int id = 0; id < SectionCount; ++id) {
+                    const quint32 count = quint32(m_models[i].section(id).second);
+                    table[i].sections[id] = {offset, count, RecordSizes[id]};
+                    offset = aligned(offset + quint64(count) * RecordSizes[id]);
+                }
+            }
+            header.fileSize = offset;
+
+            m_position = 0;
+            append(file, &header, sizeof(header), header.stringIndexOffset);
+            append(file, m_entries.data(), m_entries.size() * sizeof(StringEntry), header.stringDataOffset);
+            append(file, m_data.constData(), size_t(m_data.size()) * sizeof(char16_t), header.modelTableOffset);
+            append(file, table.data(), table.size() * sizeof(ModelRecord), 0);
+            for (size_t i = 0; i < m_models.size(); ++i) {
+                for (int id = 0; id < SectionCount; ++id) {
+                    const Section& section = table[i].sections[id];
+                    append(file, m_models[i].section(id).first, size_t(section.count) * section.recordSize, 0);
+                }
+            }
+            return !m_failed && m_position == header.fileSize;
+        }
+
+    private:
+        std::vector<StringEntry> m_entries;
+        QString m_data;
+        QHash<QString, quint32> m_ids;
+        std::vector<ModelRecords> m_models;
+        quint64 m_position = 0;
+        bool m_failed = false;
+
+        // Equal strings share one id, so attribute names repeated on every message cost nothing
+        quint32 string(const QString& text)
+        {
+            if (text.isEmpty()) {
+                return 0;
+            }
+            auto existing = m_ids.constFind(text);
+            if (existing != m_ids.constEnd()) {
+                return existing.value();
+            }
+            const quint32 id = quint32(m_entries.size());
+            m_entries.push_back({quint32(m_data.size()), quint32(text.size())});
+            m_data.append(text);
+            m_ids.insert(text, id);
+            return id;
+        }
+
+        Range addAttributes(ModelRecords& records, const QList<Attribute>& attributes)
+        {
+            const Range range{quint32(records.attributes.size()), quint32(attributes.size())};
+            for (const Attribute& attribute : attributes) {
+                records.attributes.push_back(
+                    {string(attribute.name), string(attribute.type), string(attribute.value), string(attribute.range)});
+            }
+            return range;
+        }
+
+        Range addTxRx(ModelRecords& records, const QList<TxRxMessage>& messages)
+        {
+            const Range range{quint32(records.txRx.size()), quint32(messages.size())};
+            for (const TxRxMessage& message : messages) {
+                records.txRx.push_back(string(message.name));
+            }
+            return range;
+        }
+
+        VariantRecord variant(const QVariant& value)
+        {
+            VariantRecord record{};
+            switch (value.typeId()) {
+            case QMetaType::UnknownType:
+            case QMetaType::Nullptr:
+                record.type = NullVariant;
+                break;
+            case QMetaType::Bool:
+                record.type = BoolVariant;
+                record.payload = value.toBool();
+                break;
+            case QMetaType::Int:
+            case QMetaType::UInt:
+            case QMetaType::LongLong:
+                record.type = IntVariant;
+                record.payload = quint64(value.toLongLong());
+                break;
+            case QMetaType::Double:
+            case QMetaType::Float: {
+                record.type = DoubleVariant;
+                const double number = value.toDouble();
+                std::memcpy(&record.payload, &number, sizeof(number));
+                break;
+            }
+            default:
+                record.type = StringVariant;
+                record.payload = string(value.toString());
+                break;
+            }
+            return record;
+        }
+
+        SignalRecord signalRecord(ModelRecords& records, const Signal& signal)
+        {
+            SignalRecord record{};
+            record.spn = signal.spn;
+            record.name = string(signal.name);
+            record.description = string(signal.description);
+            record.units = string(signal.units);
+            record.startBit = signal.startBit;
+            record.bitLength = signal.bitLength;
+            record.multiplexValue = signal.multiplexValue;
+            record.flags = (signal.isBigEndian ? BigEndianFlag : 0) | (signal.isTwosComplement ? TwosComplementFlag : 0)
+                           | (signal.isMultiplexer ? MultiplexerFlag : 0);
+            record.factor = signal.factor;
+            record.offset = signal.offset;
+            record.scaledMin = variant(signal.scaledMin);
+            record.scaledMax = variant(signal.scaledMax);
+            record.scaledDefault = variant(signal.scaledDefault);
+            record.attributes = addAttributes(records, signal.signalAttributes);
+            record.enumerations = {quint32(records.enumerations.size()), quint32(signal.enumerations.size())};
+            for (const Enumeration& enumeration : signal.enumerations) {
+                records.enumerations.push_back({string(enumeration.name), string(enumeration.description), enumeration.value});
+            }
+            return record;
+        }
+
+        // Writes size bytes, then zero padding up to padTo if that lies further on
+        void append(QSaveFile& file, const void* data, size_t size, quint64 padTo)
+        {
+            static const char zeros[8] = {};
+            if (size > 0 && file.write(static_cast<const char*>(data), qint64(size)) != qint64(size)) {
+                m_failed = true;
+            }
+            m_position += size;
+            const quint64 target = padTo ? padTo : aligned(m_position);
+            if (target > m_position) {
+                const qint64 padding = qint64(target - m_position);
+                if (file.write(zeros, padding) != padding) {
+                    m_failed = true;
+                }
+                m_position = target;
+            }
+        }
+};
+
+// ---------------------------------------------------------------------------------------------
+// Reading
+
+class SnapshotReader {
+    public:
+        SnapshotReader(const char* data, quint64 size) : m_data(data), m_size(size) {}
+
+        bool readHeader()
+        {
+            if (m_size < sizeof(FileHeader)) {
+                return fail("file too small");
+            }
+            std::memcpy(&m_header, m_data, sizeof(FileHeader));
+            if (std::memcmp(m_header.magic, Magic, sizeof(Magic)) != 0) {
+                return fail("not a binary workspace");
+            }
+            if (m_header.byteOrder != ByteOrderMark) {
+                return fail("written on a machine with a different byte order");
+            }
+            if (m_header.version == 1) {
+                return fail("written before the DBC byte order fix, save it again from its DBC or JSON source");
+            }
+            if (m_header.version != Version) {
+                return fail(QString("unsupported version %1").arg(m_header.version));
+            }
+            if (m_header.fileSize != m_size) {
+                return fail("file is truncated");
+            }
+            if (!fits(m_header.stringIndexOffset, m_header.stringCount, sizeof(StringEntry))
+                || !fits(m_header.stringDataOffset, m_header.stringDataSize, sizeof(char16_t))
+                || !fits(m_header.modelTableOffset, m_header.modelCount, sizeof(ModelRecord))
+                || m_header.stringDataOffset % alignof(char16_t) != 0) {
+                return fail("section out of bounds");
+            }
+
+            // Every string is created once and shared by all the objects using it
+            const QChar* chars = reinterpret_cast<const QChar*>(m_data + m_header.stringDataOffset);
+            m_strings.reserve(m_header.stringCount);
+            for (quint32 i = 0; i < m_header.stringCount; ++i) {
+                StringEntry entry;
+                std::memcpy(&entry, m_data + m_header.stringIndexOffset + quint64(i) * sizeof(StringEntry), sizeof(entry));
+                if (quint64(entry.offset) + entry.length > m_header.stringDataSize) {
+                    return fail("string out of bounds");
+                }
+                m_strings.append(entry.length ? QString(chars + entry.offset, entry.length) : QString());
+            }
+            return true;
+        }
+
+        quint32 modelCount() const { return m_header.modelCount; }
+
+        bool readModel(quint32 index, DbcDataModel& model, const std::function<bool(int percent)>& progress)
+        {
+            std::memcpy(&m_model, m_data + m_header.modelTableOffset + quint64(index) * sizeof(ModelRecord), sizeof(ModelRecord));
+            for (int id = 0; id < SectionCount; ++id) {
+                const Section& section = m_model.sections[id];
+                if (section.recordSize < MinimumRecordSizes[id] || !fits(section.offset, section.count, section.recordSize)) {
+                    return fail("section out of bounds");
+                }
+            }
+            model.setFileName(string(m_model.fileName));
+
+            QList<Network>& networks = model.networks();
+            networks.reserve(m_model.sections[NetworkSection].count);
+            for (quint32 i = 0; i < m_model.sections[NetworkSection].count; ++i) {
+                const NetworkRecord record = this->record<NetworkRecord>(NetworkSection, i);
+                Network network;
+                network.name = string(record.name);
+                network.baud = string(record.baud);
+                network.networkAttributes = attributes(record.attributes);
+                networks.append(network);
+            }
+
+            QList<Node>& nodes = model.nodes();
+            nodes.reserve(m_model.sections[NodeSection].count);
+            for (quint32 i = 0; i < m_model.sections[NodeSection].count; ++i) {
+                const NodeRecord record = this->record<NodeRecord>(NodeSection, i);
+                Node node;
+                node.name = string(record.name);
+                node.nodeAttributes = attributes(record.attributes);
+                if (checkRange(AssociationSection, record.associations)) {
+                    node.networks.reserve(record.associations.count);
+                    for (quint32 a = 0; a < record.associations.count; ++a) {
+                        const AssociationRecord associationRecord =
+                            this->record<AssociationRecord>(AssociationSection, record.associations.first + a);
+                        NodeNetworkAssociation association;
+                        association.networkName = string(associationRecord.networkName);
+                        association.sourceAddress = associationRecord.sourceAddress;
+                        association.tx = txRx(associationRecord.tx);
+                        association.rx = txRx(associationRecord.rx);
+                        node.networks.append(association);
+                    }
+                }
+                nodes.append(node);
+            }
+
+            QList<Message>& messages = model.messages();
+            const quint32 messageCount = m_model.sections[MessageSection].count;
+            messages.reserve(messageCount);
+            for (quint32 i = 0; i < messageCount && m_error.isEmpty(); ++i) {
+                if (progress && i % 256 == 0 && !progress(int(quint64(i) * 100 / messageCount))) {
+                    return false;
+                }
+                const MessageRecord record = this->record<MessageRecord>(MessageSection, i);
+                Message message;
+                message.pgn = record.pgn;
+                message.name = string(record.name);
+                message.description = string(record.description);
+                message.priority = record.priority;
+                message.length = record.length;
+                message.txPeriodicity = record.txPeriodicity;
+                message.multiplexValue = record.multiplexValue;
+                message.txOnChange = record.txOnChange;
+                message.dataPage = record.dataPage;
+                message.extendedDataPage = record.extendedDataPage;
+                message.messageAttributes = attributes(record.attributes);
+                if (checkRange(SignalSection, record.messageSignals)) {
+                    message.messageSignals.reserve(record.messageSignals.count);
+                    for (quint32 s = 0; s < record.messageSignals.count; ++s) {
+                        message.messageSignals.append(signal(record.messageSignals.first + s));
+                    }
+                }
+                messages.append(message);
+            }
+
+            if (!m_error.isEmpty()) {
+                return false;
+            }
+            model.rebuildMessageIndex();
+            model.rebuildEndpointIndex();
+            return true;
+        }
+
+        QString errorString() const { return m_error; }
+
+    private:
+        const char* m_data;
+        quint64 m_size;
+        FileHeader m_header{};
+        ModelRecord m_model{};
+        QList<QString> m_strings;
+        QString m_error;
+
+        bool fail(const QString& error)
+        {
+            if (m_error.isEmpty()) {
+                m_error = error;
+            }
+            return false;
+        }
+
+        bool fits(quint64 offset, quint64 count, quint64 recordSize) const
+        {
+            return offset <= m_size && (recordSize == 0 || count <= (m_size - offset) / recordSize);
+        }
+
+        bool checkRange(SectionId id, const Range& range)
+        {
+            if (quint64(range.first) + range.count > m_model.sections[id].count) {
+                return fail("record reference out of bounds");
+            }
+            return true;
+        }
+
+        // Records are copied out so the mapping needs no particular alignment. Fields a shorter
+        // record leaves out stay zero.
+        template <typename T>
+        T record(SectionId id, quint32 index) const
+        {
+            T value{};
+            const Section& section = m_model.sections[id];
+            std::memcpy(&value, m_data + section.offset + quint64(index) * section.recordSize,
+                        std::min<size_t>(sizeof(T), section.recordSize));
+            return value;
+        }
+
+        QString string(quint32 id)
+        {
+            if (id >= quint32(m_strings.size())) {
+                fail("string id out of bounds");
+                return QString();
+            }
+            return m_strings.at(id);
+        }
+
+        QList<Attribute> attributes(const Range& range)
+        {
+            QList<Attribute> result;
+            if (!checkRange(AttributeSection, range)) {
+                return result;
+            }
+            result.reserve(range.count);
+            for (quint32 i = 0; i < range.count; ++i) {
+                const AttributeRecord record = this->record<AttributeRecord>(AttributeSection, range.first + i);
+                result.append(Attribute{string(record.name), string(record.type), string(record.value), string(record.range)});
+            }
+            return result;
+        }
+
+        QList<TxRxMessage> txRx(const Range& range)
+        {
+            QList<TxRxMessage> result;
+            if (!checkRange(TxRxSection, range)) {
+                return result;
+            }
+            result.reserve(range.count);
+            for (quint32 i = 0; i < range.count; ++i) {
+                result.append(TxRxMessage{string(record<quint32>(TxRxSection, range.first + i))});
+            }
+            return result;
+        }
+
+        QVariant variant(const VariantRecord& record)
+        {
+            switch (record.type) {
+            case BoolVariant:
+                return record.payload != 0;
+            case IntVariant:
+                return qlonglong(record.payload);
+            case DoubleVariant: {
+                double number;
+                std::memcpy(&number, &record.payload, sizeof(number));
+                return number;
+            }
+            case StringVariant:
+                return string(quint32(record.payload));
+            default:
+                return QVariant();
+            }
+        }
+
+        Signal signal(quint32 index)
+        {
+            const SignalRecord record = this->record<SignalRecord>(SignalSection, index);
+            Signal signal;
+            signal.spn = record.spn;
+            signal.name = string(record.name);
+            signal.description = string(record.description);
+            signal.units = string(record.units);
+            signal.startBit = record.startBit;
+            signal.bitLength = record.bitLength;
+            signal.multiplexValue = record.multiplexValue;
+            signal.isBigEndian = record.flags & BigEndianFlag;
+            signal.isTwosComplement = record.flags & TwosComplementFlag;
+            signal.isMultiplexer = record.flags & MultiplexerFlag;
+            signal.factor = record.factor;
+            signal.offset = record.offset;
+            signal.scaledMin = variant(record.scaledMin);
+            signal.scaledMax = variant(record.scaledMax);
+            signal.scaledDefault = variant(record.scaledDefault);
+            signal.signalAttributes = attributes(record.attributes);
+            if (checkRange(EnumerationSection, record.enumerations)) {
+                signal.enumerations.reserve(record.enumerations.count);
+                for (quint32 i = 0; i < record.enumerations.count; ++i) {
+                    const EnumerationRecord enumeration =
+                        this->record<EnumerationRecord>(EnumerationSection, record.enumerations.first + i);
+                    signal.enumerations.append(Enumeration{string(enumeration.name), string(enumeration.description),
+                                                           enumeration.value});
+                }
+            }
+            return signal;
+        }
+};
+
+} // namespace
+
+
+bool DbcSnapshot::save(const QString& filePath, const QList<DbcDataModel*>& models)
+{
+    SnapshotWriter writer;
+    for (DbcDataModel* model : models) {
+        writer.addModel(model);
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not open file for writing:" << filePath;
+        return false;
+    }
+    if (!writer.write(file) || !file.commit()) {
+        qWarning() << "Could not write binary workspace:" << filePath << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool DbcSnapshot::load(const QString& filePath, QList<DbcDataModel*>& models, const DbcDataModel::ProgressCallback& progress)
+{
+    models.clear();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Couldn't open binary workspace:" << filePath;
+        return false;
+    }
+
+    const qint64 fileSize = file.size();
+    uchar* mapped = fileSize > 0 ? file.map(0, fileSize) : nullptr;
+    QByteArray fallback;
+    if (!mapped) {
+        fallback = file.readAll();
+    }
+    const char* data = mapped ? reinterpret_cast<const char*>(mapped) : fallback.constData();
+    const quint64 size = quint64(mapped ? fileSize : fallback.size());
+
+    SnapshotReader reader(data, size);
+    if (!reader.readHeader()) {
+        qWarning() << "Invalid binary workspace:" << filePath << ":" << reader.errorString();
+        return false;
+    }
+
+    std::vector<std::unique_ptr<DbcDataModel>> loaded;
+    const quint32 count = reader.modelCount();
+    for (quint32 i = 0; i < count; ++i) {
+        loaded.push_back(std::make_unique<DbcDataModel>());
+        const bool ok = reader.readModel(i, *loaded.back(), [&](int percent) {
+            return !progress || progress(int((quint64(i) * 100 + percent) / count));
+        });
+        if (!ok) {
+            if (reader.errorString().isEmpty()) {
+                qWarning() << "Binary workspace load canceled:" << filePath;
+            } else {
+                qWarning() << "Invalid binary workspace:" << filePath << ":" << reader.errorString();
+            }
+            return false;
+        }
+    }
+
+    for (std::unique_ptr<DbcDataModel>& model : loaded) {
+        models.append(model.release());
+    }
+    if (progress) {
+        progress(100);
+    }
+    return true;
+}
+
+bool DbcSnapshot::isSnapshot(const QString& filePath)
+{
+    QFile file(filePath);
+    char magic[sizeof(Magic)];
+    return file.open(QIODevice::ReadOnly) && file.read(magic, sizeof(magic)) == qint64(sizeof(magic))
+           && std::memcmp(magic, Magic, sizeof(Magic)) == 0;
+}
@@ -0,0 +1,29 @@
+#ifndef DBCSNAPSHOT_H
+#define DBCSNAPSHOT_H
+
+#include <QString>
+#include <QList>
+#include "dbcdata.h"
+
+// Versioned binary snapshot of one or more DbcDataModels. All text goes into one UTF-16 string
+// table and everything else into arrays of fixed-size records, so a message, signal or node is
+// found by index and loading is a walk over the mapped file rather than a parse. The layout is
+// described in dbcsnapshot.cpp.
+class DbcSnapshot {
+    public:
+        // File extension used for binary workspaces
+        static const char* const Suffix;
+
+        // Writes the models to filePath, replacing it only once everything was written
+        static bool save(const QString& filePath, const QList<DbcDataModel*>& models);
+
+        // Reads every model in the file. The new models belong to the caller; on failure or
+        // cancel nothing is returned.
+        static bool load(const QString& filePath, QList<DbcDataModel*>& models,
+                         const DbcDataModel::ProgressCallback& progress = DbcDataModel::ProgressCallback());
+
+        // True if the file starts with the snapshot header, whatever its extension
+        static bool isSnapshot(const QString& filePath);
+};
+
+#endif // DBCSNAPSHOT_H
@@ -1,11 +1,11 @@
 #ifndef DBCTREE_H
 #define DBCTREE_H
 
-#include <QTreeWidget>
-#include <QSet>
+#include <QTreeView>
 #include "dbcdata.h"
+#include "dbctreemodel.h"
 
-class DbcTree : public QTreeWidget {
+class DbcTree : public QTreeView {
     Q_OBJECT
 
     public:
@@ -17,15 +17,24 @@ class DbcTree : public QTreeWidget {
 
         void populateTree(const QList<DbcDataModel*>& models);
 
-    protected:
-        // Event handler declarations
-        void dragMoveEvent(QDragMoveEvent *event) override;
-        void dropEvent(QDropEvent *event) override;
+        // Incremental updates for a single model, see DbcTreeModel
+        void addModel(DbcDataModel* model);
+        void removeModel(DbcDataModel* model);
+        DbcTreeModel* treeModel() const;
 
-        // Used for alphabetical sorting
-        void sortChildItems(QTreeWidgetItem* parentItem);
-        QList<DbcDataModel*> m_models;
+        // Fetches and expands every branch
+        void expandAllItems();
 
+        // Hides the top-level items that do not match the text, see DbcTreeModel::search, and
+        // the loaded rows under the shown ones that neither match its words nor lead to a match
+        void filter(const QString& text);
+
+    private:
+        DbcTreeModel* m_treeModel;
+
+        void expandCategories(const QModelIndex& parent, int first, int last);
+        void expandAllItems(const QModelIndex& parent);
+        bool filterLoadedRows(const QModelIndex& parent, const QString& words);
 };
 
 #endif // DBCTREE_H
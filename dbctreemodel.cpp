@@ -0,0 +1,957 @@
+#include "dbctreemodel.h"
+#include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
+
+DbcTreeModel::DbcTreeModel(QObject *parent)
+    : QAbstractItemModel(parent),
+      m_root(new TreeNode{Kind::Category}),
+      m_networkIcon(":/icons/network.svg"),
+      m_nodeIcon(":/icons/node.svg"),
+      m_messageIcon(":/icons/message.svg"),
+      m_signalIcon(":/icons/signal.svg") {
+    // Start out with the empty categories so models can be added one at a time
+    setModels(QList<DbcDataModel*>());
+}
+
+DbcTreeModel::~DbcTreeModel() {
+}
+
+void DbcTreeModel::setModels(const QList<DbcDataModel*>& models)
+{
+    beginResetModel();
+    m_models = models;
+    m_query.setModels(models);
+    m_root.reset(new TreeNode{Kind::Category});
+
+    // Create top-level categories
+    TreeNode* networksCategory = addCategory(m_root.get(), "<Networks>", Kind::Category);
+    TreeNode* nodesCategory = addCategory(m_root.get(), "<Nodes>", Kind::Category);
+    TreeNode* messagesCategory = addCategory(m_root.get(), "<Messages>", Kind::Category);
+
+    // Only the entries of the top-level categories are built here, everything below
+    // them is created by fetchMore when a branch is expanded
+    for (DbcDataModel* model : models) {
+        if (!model) {
+            qWarning() << "setModels: Encountered a null DbcDataModel pointer.";
+            continue;
+        }
+
+        for (int i = 0; i < model->networks().size(); ++i) {
+            findOrCreateChild(networksCategory, Kind::Network, {model, i}, false);
+        }
+        for (int i = 0; i < model->nodes().size(); ++i) {
+            findOrCreateChild(nodesCategory, Kind::Node, {model, i}, false);
+        }
+        for (int i = 0; i < model->messages().size(); ++i) {
+            findOrCreateChild(messagesCategory, Kind::Message, {model, i}, false);
+        }
+    }
+
+    // The category lookups are kept so later models can be merged in without a rebuild
+    m_categoryLookup = std::move(m_buildLookup);
+    m_buildLookup.clear();
+    m_categoryLookupDirty = false;
+    m_searchIndexDirty = true;
+    endResetModel();
+}
+
+void DbcTreeModel::addModel(DbcDataModel* model)
+{
+    syncModel(model, true);
+}
+
+void DbcTreeModel::removeModel(DbcDataModel* model)
+{
+    syncModel(model, false);
+}
+
+// Brings one model's entries under the top-level categories in line with its data. Only the
+// items holding a reference to the model are touched, other models' items are left alone.
+void DbcTreeModel::syncModel(DbcDataModel* model, bool present)
+{
+    if (!model || m_root->children.size() < 3) {
+        return;
+    }
+
+    const bool known = m_models.contains(model);
+    if (!known && !present) {
+        return;
+    }
+    if (!known) {
+        m_models.append(model);
+    }
+    ensureCategoryLookup();
+    m_searchIndexDirty = true;
+
+    const Kind kinds[] = {Kind::Network, Kind::Node, Kind::Message};
+    const int counts[] = {present ? int(model->networks().size()) : 0,
+                          present ? int(model->nodes().size()) : 0,
+                          present ? int(model->messages().size()) : 0};
+
+    QSet<TreeNode*> touched;
+    for (int c = 0; c < 3; ++c) {
+        TreeNode* category = m_root->children[c].get();
+        QHash<QString, TreeNode*>& lookup = m_categoryLookup[category];
+
+        // Drop the model's old references, a new model has none so this scan is skipped
+        QSet<TreeNode*> stripped;
+        if (known) {
+            for (const std::unique_ptr<TreeNode>& child : category->children) {
+                if (child->refs.removeIf([&](const Ref& ref) { return ref.model == model; }) > 0) {
+                    stripped.insert(child.get());
+                }
+            }
+        }
+
+        // Merge the current entries into existing items, new ones are staged and appended
+        TreeNode staging{Kind::Category};
+        for (int i = 0; i < counts[c]; ++i) {
+            TreeNode candidate{kinds[c]};
+            candidate.refs.append({model, i});
+            const QString key = lookupKey(&candidate);
+
+            TreeNode* existing = lookup.value(key);
+            if (existing) {
+                if (std::none_of(existing->refs.begin(), existing->refs.end(),
+                                 [&](const Ref& ref) { return ref.model == model; })) {
+                    existing->refs.append({model, i});
+                }
+                stripped.insert(existing);
+            } else if (!m_buildLookup[&staging].contains(key)) {
+                // Entries repeated within the model collapse into one item, as in setModels
+                m_buildLookup[&staging].insert(key, addChild(&staging, kinds[c], {model, i}, false));
+            }
+        }
+        const QHash<QString, TreeNode*> staged = m_buildLookup.take(&staging);
+        for (auto it = staged.cbegin(); it != staged.cend(); ++it) {
+            lookup.insert(it.key(), it.value());
+        }
+
+        if (!staging.children.empty()) {
+            const int first = int(category->children.size());
+            beginInsertRows(indexFor(category), first, first + int(staging.children.size()) - 1);
+            for (std::unique_ptr<TreeNode>& child : staging.children) {
+                child->parent = category;
+                child->row = int(category->children.size());
+                category->children.push_back(std::move(child));
+            }
+            endInsertRows();
+        }
+
+        // Items left without any model go, the others show a changed model list
+        QList<int> emptied;
+        for (TreeNode* node : stripped) {
+            if (node->refs.isEmpty()) {
+                emptied.append(node->row);
+            } else {
+                touched.insert(node);
+            }
+        }
+        if (!emptied.isEmpty()) {
+            removeChildRows(category, emptied);
+            m_categoryLookupDirty = true;
+        }
+    }
+
+    if (present) {
+        m_query.addModel(model);
+    } else {
+        m_models.removeAll(model);
+        m_query.removeModel(model);
+    }
+
+    for (TreeNode* node : touched) {
+        QModelIndex index = indexFor(node);
+        emit dataChanged(index, index);
+        rebuildBranch(node);
+    }
+
+    // Message branches list transmitters and receivers from every model
+    TreeNode* messagesCategory = m_root->children[2].get();
+    for (const std::unique_ptr<TreeNode>& child : messagesCategory->children) {
+        if (child->fetched && !touched.contains(child.get()) &&
+            !model->messageEndpoints(displayName(child.get())).isEmpty()) {
+            rebuildBranch(child.get());
+        }
+    }
+}
+
+// Removes the given rows of a parent, highest first so the lower rows stay valid
+void DbcTreeModel::removeChildRows(TreeNode* parent, QList<int> rows)
+{
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+    const QModelIndex parentIndex = indexFor(parent);
+    int i = 0;
+    while (i < rows.size()) {
+        // Extend the run of adjacent rows
+        int last = rows[i];
+        int first = last;
+        while (i + 1 < rows.size() && rows[i + 1] == first - 1) {
+            first = rows[++i];
+        }
+        ++i;
+
+        beginRemoveRows(parentIndex, first, last);
+        parent->children.erase(parent->children.begin() + first, parent->children.begin() + last + 1);
+        for (int row = first; row < int(parent->children.size()); ++row) {
+            parent->children[row]->row = row;
+        }
+        endRemoveRows();
+    }
+}
+
+// Drops the built children of a node that was already expanded and builds them again
+void DbcTreeModel::rebuildBranch(TreeNode* node)
+{
+    if (!node->fetched) {
+        return;
+    }
+
+    const QModelIndex index = indexFor(node);
+    if (!node->children.empty()) {
+        beginRemoveRows(index, 0, int(node->children.size()) - 1);
+        node->children.clear();
+        endRemoveRows();
+    }
+    node->fetched = false;
+    fetchMore(index);
+}
+
+void DbcTreeModel::ensureCategoryLookup()
+{
+    if (!m_categoryLookupDirty) {
+        return;
+    }
+
+    m_categoryLookup.clear();
+    for (const std::unique_ptr<TreeNode>& category : m_root->children) {
+        QHash<QString, TreeNode*>& lookup = m_categoryLookup[category.get()];
+        lookup.reserve(int(category->children.size()));
+        for (const std::unique_ptr<TreeNode>& child : category->children) {
+            lookup.insert(lookupKey(child.get()), child.get());
+        }
+    }
+    m_categoryLookupDirty = false;
+}
+
+QModelIndex DbcTreeModel::index(int row, int column, const QModelIndex& parent) const
+{
+    TreeNode* parentNode = nodeFor(parent);
+    if (!parentNode || column != 0 || row < 0 || row >= int(parentNode->children.size())) {
+        return QModelIndex();
+    }
+    return createIndex(row, 0, parentNode->children[row].get());
+}
+
+QModelIndex DbcTreeModel::parent(const QModelIndex& child) const
+{
+    if (!child.isValid()) {
+        return QModelIndex();
+    }
+    return indexFor(nodeFor(child)->parent);
+}
+
+int DbcTreeModel::rowCount(const QModelIndex& parent) const
+{
+    TreeNode* node = nodeFor(parent);
+    return node ? int(node->children.size()) : 0;
+}
+
+int DbcTreeModel::columnCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return 1;
+}
+
+QVariant DbcTreeModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+    const TreeNode* node = nodeFor(index);
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return displayName(node);
+    case Qt::DecorationRole:
+        switch (node->kind) {
+        case Kind::Network:
+        case Kind::NodeNetwork:
+        case Kind::MessageNetwork:
+            return m_networkIcon;
+        case Kind::Node:
+        case Kind::NetworkNode:
+        case Kind::MessageNetworkNode:
+            return m_nodeIcon;
+        case Kind::Message:
+        case Kind::TxMessage:
+        case Kind::RxMessage:
+            return m_messageIcon;
+        case Kind::Signal:
+            return m_signalIcon;
+        default:
+            return QVariant();
+        }
+    case TypeRole:
+        return typeName(node);
+    case ModelNamesRole: {
+        QStringList names = modelNames(node);
+        return names.isEmpty() ? QVariant() : QVariant(names);
+    }
+    case UniqueKeyRole:
+        return uniqueKey(node);
+    default:
+        return QVariant();
+    }
+}
+
+Qt::ItemFlags DbcTreeModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+bool DbcTreeModel::hasChildren(const QModelIndex& parent) const
+{
+    TreeNode* node = nodeFor(parent);
+    return node && (!node->fetched || !node->children.empty());
+}
+
+bool DbcTreeModel::canFetchMore(const QModelIndex& parent) const
+{
+    TreeNode* node = nodeFor(parent);
+    return node && !node->fetched;
+}
+
+void DbcTreeModel::fetchMore(const QModelIndex& parent)
+{
+    TreeNode* node = nodeFor(parent);
+    if (!node || node->fetched) {
+        return;
+    }
+    node->fetched = true;
+
+    // Build into a detached node so the rows can be announced before they are attached
+    TreeNode staging{node->kind, node->label, node->refs, node->parent};
+    buildChildren(&staging);
+    m_buildLookup.clear();
+    if (staging.children.empty()) {
+        return;
+    }
+
+    beginInsertRows(parent, 0, int(staging.children.size()) - 1);
+    node->children = std::move(staging.children);
+    for (const std::unique_ptr<TreeNode>& child : node->children) {
+        child->parent = node;
+    }
+    endInsertRows();
+}
+
+void DbcTreeModel::search(const QString& text, const std::function<void(const QModelIndex& item, int match)>& visit)
+{
+    // Field-qualified terms go to the query engine, the other words are matched against names
+    QStringList fieldTerms;
+    QStringList plainWords;
+    DbcQueryEngine::splitTerms(text, fieldTerms, plainWords);
+    const QString needle = searchWords(text);
+    QHash<const TreeNode*, int> matches;
+
+    QHash<DbcDataModel*, DbcQueryMatches> fieldMatches;
+    if (!fieldTerms.isEmpty()) {
+        m_query.run(fieldTerms, fieldMatches);
+    }
+
+    if (!needle.isEmpty()) {
+        if (m_searchIndexDirty) {
+            buildSearchIndex();
+        }
+
+        auto consider = [&](int entryIndex) {
+            const SearchEntry& entry = m_searchEntries[entryIndex];
+            if (entry.name.contains(needle)) {
+                matches[entry.item] |= entry.own ? NameMatch : ContentMatch;
+            }
+        };
+
+        if (needle.size() < 3) {
+            // Too short for a trigram, scan the names
+            for (int i = 0; i < int(m_searchEntries.size()); ++i) {
+                consider(i);
+            }
+        } else {
+            // Every match contains all trigrams of the text, so only the entries of the
+            // rarest one need to be checked
+            const QList<int>* candidates = nullptr;
+            for (int i = 0; i + 3 <= needle.size(); ++i) {
+                auto it = m_searchTrigrams.constFind(trigram(needle.constData() + i));
+                if (it == m_searchTrigrams.constEnd()) {
+                    candidates = nullptr;
+                    break;
+                }
+                if (!candidates || it.value().size() < candidates->size()) {
+                    candidates = &it.value();
+                }
+            }
+            if (candidates) {
+                for (int entryIndex : *candidates) {
+                    consider(entryIndex);
+                }
+            }
+        }
+    }
+
+    for (const std::unique_ptr<TreeNode>& category : m_root->children) {
+        for (const std::unique_ptr<TreeNode>& child : category->children) {
+            int match = needle.isEmpty() ? int(NameMatch) : matches.value(child.get(), NoMatch);
+            if (!fieldTerms.isEmpty() && match != NoMatch) {
+                // Both the field terms and the words have to match
+                const int fieldMatch = queryMatch(child.get(), fieldMatches);
+                match = fieldMatch == NoMatch ? int(NoMatch)
+                                              : (needle.isEmpty() ? fieldMatch : (match | fieldMatch));
+            }
+            visit(indexFor(child.get()), match);
+        }
+    }
+}
+
+QString DbcTreeModel::searchWords(const QString& text)
+{
+    QStringList fieldTerms;
+    QStringList plainWords;
+    DbcQueryEngine::splitTerms(text, fieldTerms, plainWords);
+    return fieldTerms.isEmpty() ? text.toLower() : plainWords.join(' ').toLower();
+}
+
+int DbcTreeModel::queryMatch(const TreeNode* item, const QHash<DbcDataModel*, DbcQueryMatches>& fieldMatches) const
+{
+    int match = NoMatch;
+    for (const Ref& ref : item->refs) {
+        auto it = fieldMatches.constFind(ref.model);
+        if (it == fieldMatches.constEnd()) {
+            continue;
+        }
+        switch (item->kind) {
+        case Kind::Network:
+            if (it.value().networks.contains(ref.a)) {
+                match |= NameMatch;
+            }
+            break;
+        case Kind::Node:
+            if (it.value().nodes.contains(ref.a)) {
+                match |= NameMatch;
+            }
+            break;
+        case Kind::Message:
+            if (it.value().messages.contains(ref.a)) {
+                match |= NameMatch;
+            }
+            if (it.value().signalMessages.contains(ref.a)) {
+                match |= ContentMatch;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return match;
+}
+
+void DbcTreeModel::fieldsChanged(DbcDataModel* model)
+{
+    m_query.invalidate(model);
+}
+
+void DbcTreeModel::buildSearchIndex()
+{
+    m_searchEntries.clear();
+    m_searchTrigrams.clear();
+
+    if (m_root->children.size() < 3) {
+        m_searchIndexDirty = false;
+        return;
+    }
+    const TreeNode* networksCategory = m_root->children[0].get();
+    const TreeNode* nodesCategory = m_root->children[1].get();
+    const TreeNode* messagesCategory = m_root->children[2].get();
+
+    // Networks list the nodes attached to them
+    QHash<QString, const TreeNode*> networkItems;
+    for (const std::unique_ptr<TreeNode>& network : networksCategory->children) {
+        const QString name = displayName(network.get());
+        networkItems.insert(name, network.get());
+        addSearchEntry(name, network.get(), true);
+    }
+
+    // Nodes list their networks and the messages they transmit and receive
+    for (const std::unique_ptr<TreeNode>& item : nodesCategory->children) {
+        addSearchEntry(displayName(item.get()), item.get(), true);
+        for (const Ref& ref : item->refs) {
+            const Node& node = ref.model->nodes()[ref.a];
+            for (const NodeNetworkAssociation& nodeNetwork : node.networks) {
+                addSearchEntry(nodeNetwork.networkName, item.get(), false);
+                for (const TxRxMessage& tx : nodeNetwork.tx) {
+                    addSearchEntry(tx.name, item.get(), false);
+                }
+                for (const TxRxMessage& rx : nodeNetwork.rx) {
+                    addSearchEntry(rx.name, item.get(), false);
+                }
+                if (const TreeNode* networkItem = networkItems.value(nodeNetwork.networkName)) {
+                    addSearchEntry(node.name, networkItem, false);
+                }
+            }
+        }
+    }
+
+    // Messages list their signals
+    for (const std::unique_ptr<TreeNode>& item : messagesCategory->children) {
+        addSearchEntry(displayName(item.get()), item.get(), true);
+        for (const Ref& ref : item->refs) {
+            for (const Signal& signal : ref.model->messages()[ref.a].messageSignals) {
+                addSearchEntry(signal.name, item.get(), false);
+            }
+        }
+    }
+
+    m_searchIndexDirty = false;
+}
+
+void DbcTreeModel::addSearchEntry(const QString& name, const TreeNode* item, bool own)
+{
+    const int entryIndex = int(m_searchEntries.size());
+    m_searchEntries.push_back({name.toLower(), item, own});
+
+    const QString& lower = m_searchEntries.back().name;
+    for (int i = 0; i + 3 <= lower.size(); ++i) {
+        QList<int>& postings = m_searchTrigrams[trigram(lower.constData() + i)];
+        // A trigram repeated within one name is only listed once
+        if (postings.isEmpty() || postings.last() != entryIndex) {
+            postings.append(entryIndex);
+        }
+    }
+}
+
+quint64 DbcTreeModel::trigram(const QChar* chars)
+{
+    return (quint64(chars[0].unicode()) << 32) | (quint64(chars[1].unicode()) << 16) | chars[2].unicode();
+}
+
+QModelIndex DbcTreeModel::childByName(const QModelIndex& parent, const QString& name)
+{
+    if (canFetchMore(parent)) {
+        fetchMore(parent);
+    }
+
+    TreeNode* parentNode = nodeFor(parent);
+    for (const std::unique_ptr<TreeNode>& child : parentNode->children) {
+        if (displayName(child.get()) == name) {
+            return indexFor(child.get());
+        }
+    }
+    return QModelIndex();
+}
+
+void DbcTreeModel::messageChanged(DbcDataModel* model, const Message* message)
+{
+    m_query.invalidate(model);
+    // Renames change the merge keys of the top-level items and the searchable names
+    m_categoryLookupDirty = true;
+    m_searchIndexDirty = true;
+
+    emitChanged([&](const TreeNode& node) {
+        for (const Ref& ref : node.refs) {
+            if (ref.model != model) {
+                continue;
+            }
+            // Tx/Rx entries are matched by name, so all of them may have been renamed along with the message
+            if (node.kind == Kind::TxMessage || node.kind == Kind::RxMessage) {
+                return true;
+            }
+            if (node.kind == Kind::Message && &model->messages()[ref.a] == message) {
+                return true;
+            }
+        }
+        return false;
+    });
+}
+
+void DbcTreeModel::signalChanged(DbcDataModel* model, const Signal* signal)
+{
+    m_searchIndexDirty = true;
+
+    emitChanged([&](const TreeNode& node) {
+        if (node.kind != Kind::Signal) {
+            return false;
+        }
+        for (const Ref& ref : node.refs) {
+            if (ref.model == model && &model->messages()[ref.a].messageSignals[ref.b] == signal) {
+                return true;
+            }
+        }
+        return false;
+    });
+}
+
+void DbcTreeModel::nodeChanged(DbcDataModel* model, const Node* node)
+{
+    // Renames change the merge keys of the top-level items and the searchable names
+    m_categoryLookupDirty = true;
+    m_searchIndexDirty = true;
+
+    emitChanged([&](const TreeNode& treeNode) {
+        if (treeNode.kind != Kind::Node && treeNode.kind != Kind::NetworkNode &&
+            treeNode.kind != Kind::MessageNetworkNode) {
+            return false;
+        }
+        for (const Ref& ref : treeNode.refs) {
+            if (ref.model == model && &model->nodes()[ref.a] == node) {
+                return true;
+            }
+        }
+        return false;
+    });
+}
+
+void DbcTreeModel::networksChanged()
+{
+    // Renames change the merge keys of the top-level items and the searchable names
+    m_categoryLookupDirty = true;
+    m_searchIndexDirty = true;
+
+    // A network rename is applied to every association naming it, in every model
+    emitChanged([](const TreeNode& node) {
+        return node.kind == Kind::Network || node.kind == Kind::NodeNetwork ||
+               node.kind == Kind::MessageNetwork || node.kind == Kind::NetworkNode ||
+               node.kind == Kind::MessageNetworkNode;
+    });
+}
+
+DbcTreeModel::TreeNode* DbcTreeModel::nodeFor(const QModelIndex& index) const
+{
+    if (!index.isValid()) {
+        return m_root.get();
+    }
+    return static_cast<TreeNode*>(index.internalPointer());
+}
+
+QModelIndex DbcTreeModel::indexFor(const TreeNode* node) const
+{
+    if (!node || node == m_root.get()) {
+        return QModelIndex();
+    }
+    return createIndex(node->row, 0, const_cast<TreeNode*>(node));
+}
+
+QString DbcTreeModel::displayName(const TreeNode* node) const
+{
+    if (node->label) {
+        return QString::fromLatin1(node->label);
+    }
+    if (node->refs.isEmpty()) {
+        return QString();
+    }
+
+    const Ref& ref = node->refs.first();
+    switch (node->kind) {
+    case Kind::Network:
+        return ref.model->networks()[ref.a].name;
+    case Kind::Node:
+    case Kind::NetworkNode:
+    case Kind::MessageNetworkNode:
+        return ref.model->nodes()[ref.a].name;
+    case Kind::NodeNetwork:
+    case Kind::MessageNetwork:
+        return ref.model->nodes()[ref.a].networks[ref.b].networkName;
+    case Kind::TxMessage:
+        return ref.model->nodes()[ref.a].networks[ref.b].tx[ref.c].name;
+    case Kind::RxMessage:
+        return ref.model->nodes()[ref.a].networks[ref.b].rx[ref.c].name;
+    case Kind::Message:
+        return ref.model->messages()[ref.a].name;
+    case Kind::Signal:
+        return ref.model->messages()[ref.a].messageSignals[ref.b].name;
+    default:
+        return QString();
+    }
+}
+
+QString DbcTreeModel::typeName(const TreeNode* node) const
+{
+    switch (node->kind) {
+    case Kind::Category:
+        return "Category";
+    case Kind::Collapsible:
+        return "Collapsible";
+    case Kind::Network:
+    case Kind::NodeNetwork:
+    case Kind::MessageNetwork:
+        return "Network";
+    case Kind::Node:
+    case Kind::NetworkNode:
+    case Kind::MessageNetworkNode:
+        return "Node";
+    case Kind::Message:
+        return "Message";
+    case Kind::TxMessage:
+        return "TxMessage";
+    case Kind::RxMessage:
+        return "RxMessage";
+    case Kind::Signal:
+        return "Signal";
+    }
+    return QString();
+}
+
+QStringList DbcTreeModel::modelNames(const TreeNode* node) const
+{
+    // Networks and nodes under a message belong to the message's models
+    if (node->kind == Kind::MessageNetwork || node->kind == Kind::MessageNetworkNode) {
+        const TreeNode* ancestor = node->parent;
+        while (ancestor && ancestor->kind != Kind::Message) {
+            ancestor = ancestor->parent;
+        }
+        return ancestor ? modelNames(ancestor) : QStringList();
+    }
+
+    QStringList names;
+    for (const Ref& ref : node->refs) {
+        QString name = ref.model->fileName();
+        if (!names.contains(name)) {
+            names.append(name);
+        }
+    }
+    return names;
+}
+
+QVariant DbcTreeModel::uniqueKey(const TreeNode* node) const
+{
+    if (node->refs.isEmpty()) {
+        return QVariant();
+    }
+
+    const Ref& ref = node->refs.first();
+    switch (node->kind) {
+    case Kind::Node:
+        return displayName(node) + "::" + ref.model->fileName();
+    case Kind::NetworkNode:
+    case Kind::MessageNetworkNode:
+        return displayName(node) + "::" + ref.model->nodes()[ref.a].networks[ref.b].networkName;
+    case Kind::Message:
+        return QString::number(ref.model->messages()[ref.a].pgn);
+    case Kind::TxMessage:
+    case Kind::RxMessage: {
+        // Find the message in the model to get its PGN
+        QString name = displayName(node);
+        Message* message = ref.model->findMessageByName(name);
+        return message ? QString::number(message->pgn) : name;
+    }
+    default:
+        return QVariant();
+    }
+}
+
+DbcTreeModel::TreeNode* DbcTreeModel::addChild(TreeNode* parent, Kind kind, const Ref& ref, bool fetched)
+{
+    std::unique_ptr<TreeNode> child(new TreeNode{kind});
+    child->refs.append(ref);
+    child->parent = parent;
+    child->row = int(parent->children.size());
+    child->fetched = fetched;
+    parent->children.push_back(std::move(child));
+    return parent->children.back().get();
+}
+
+DbcTreeModel::TreeNode* DbcTreeModel::addCategory(TreeNode* parent, const char* label, Kind kind)
+{
+    std::unique_ptr<TreeNode> category(new TreeNode{kind});
+    category->label = label;
+    category->parent = parent;
+    category->row = int(parent->children.size());
+    parent->children.push_back(std::move(category));
+    return parent->children.back().get();
+}
+
+// Finds the child with the same name, type and unique key, adding the ref to it, or creates a new child
+DbcTreeModel::TreeNode* DbcTreeModel::findOrCreateChild(TreeNode* parent, Kind kind, const Ref& ref, bool fetched)
+{
+    TreeNode candidate{kind};
+    candidate.refs.append(ref);
+    candidate.parent = parent;
+    const QString key = lookupKey(&candidate);
+
+    // Lookup of the children created so far in this build, so merging models stays linear
+    QHash<QString, TreeNode*>& children = m_buildLookup[parent];
+    TreeNode* child = children.value(key);
+    if (child) {
+        bool known = std::any_of(child->refs.begin(), child->refs.end(),
+                                 [&](const Ref& existing) { return existing.model == ref.model; });
+        if (!known) {
+            child->refs.append(ref);
+        }
+        return child;
+    }
+
+    child = addChild(parent, kind, ref, fetched);
+    children.insert(key, child);
+    return child;
+}
+
+// Items with the same name, type and unique key are merged into one
+QString DbcTreeModel::lookupKey(const TreeNode* node) const
+{
+    QString key = displayName(node);
+    key += QChar(0x1f);
+    key += QString::number(int(node->kind));
+    key += QChar(0x1f);
+    key += uniqueKey(node).toString();
+    return key;
+}
+
+void DbcTreeModel::buildChildren(TreeNode* node)
+{
+    switch (node->kind) {
+    case Kind::Network:
+        // Nodes attached to this network
+        for (const Ref& ref : node->refs) {
+            const QString& networkName = ref.model->networks()[ref.a].name;
+            QList<Node>& nodes = ref.model->nodes();
+            for (int i = 0; i < nodes.size(); ++i) {
+                for (int j = 0; j < nodes[i].networks.size(); ++j) {
+                    if (nodes[i].networks[j].networkName == networkName) {
+                        findOrCreateChild(node, Kind::NetworkNode, {ref.model, i, j}, false);
+                    }
+                }
+            }
+        }
+        break;
+
+    case Kind::Node:
+        // Networks this node is attached to
+        for (const Ref& ref : node->refs) {
+            for (int j = 0; j < ref.model->nodes()[ref.a].networks.size(); ++j) {
+                findOrCreateChild(node, Kind::NodeNetwork, {ref.model, ref.a, j}, false);
+            }
+        }
+        break;
+
+    case Kind::NetworkNode:
+    case Kind::NodeNetwork: {
+        TreeNode* txMessagesCategory = addCategory(node, "<Transmitted Messages>");
+        TreeNode* rxMessagesCategory = addCategory(node, "<Received Messages>");
+        for (const Ref& ref : node->refs) {
+            addMessageChildren(txMessagesCategory, Kind::TxMessage, ref);
+            addMessageChildren(rxMessagesCategory, Kind::RxMessage, ref);
+        }
+        break;
+    }
+
+    case Kind::TxMessage:
+    case Kind::RxMessage: {
+        TreeNode* signalsCategory = addCategory(node, "<Signals>");
+        for (const Ref& ref : node->refs) {
+            Message* message = ref.model->findMessageByName(displayName(node));
+            if (message) {
+                addSignalChildren(signalsCategory, {ref.model, int(message - ref.model->messages().constData())});
+            }
+        }
+        break;
+    }
+
+    case Kind::Message: {
+        // -------------------------
+        // Add <Signals> under Message
+        // -------------------------
+        TreeNode* signalsCategory = addCategory(node, "<Signals>");
+        for (const Ref& ref : node->refs) {
+            addSignalChildren(signalsCategory, ref);
+        }
+
+        // -------------------------
+        // Add <Networks> under Message
+        // -------------------------
+        TreeNode* networksUnderMessage = addCategory(node, "<Networks>");
+        const QString messageName = displayName(node);
+
+        // Collect the transmitters and receivers of this message from each model's endpoint index
+        QMap<QString, QList<Ref>> networkTransmitters;
+        QMap<QString, QList<Ref>> networkReceivers;
+        for (DbcDataModel* model : m_models) {
+            const QMap<QString, MessageEndpoints> endpoints = model->messageEndpoints(messageName);
+            for (auto it = endpoints.cbegin(); it != endpoints.cend(); ++it) {
+                for (const NodeNetworkRef& tx : it.value().transmitters) {
+                    networkTransmitters[it.key()].append({model, tx.nodeIndex, tx.associationIndex});
+                }
+                for (const NodeNetworkRef& rx : it.value().receivers) {
+                    networkReceivers[it.key()].append({model, rx.nodeIndex, rx.associationIndex});
+                }
+            }
+        }
+
+        // Iterate through all networks that have transmitters or receivers
+        QStringList networks = networkTransmitters.keys() + networkReceivers.keys();
+        networks.removeDuplicates();
+        for (const QString& networkName : networks) {
+            const QList<Ref>& transmitters = networkTransmitters.value(networkName);
+            const QList<Ref>& receivers = networkReceivers.value(networkName);
+            TreeNode* networkItem = addChild(networksUnderMessage, Kind::MessageNetwork,
+                                             transmitters.isEmpty() ? receivers.first() : transmitters.first());
+
+            // -------------------------
+            // Add <Transmitters>
+            // -------------------------
+            TreeNode* transmittersCategory = addCategory(networkItem, "<Transmitters>");
+            for (const Ref& tx : transmitters) {
+                findOrCreateChild(transmittersCategory, Kind::MessageNetworkNode, tx, true);
+            }
+
+            // -------------------------
+            // Add <Receivers>
+            // -------------------------
+            TreeNode* receiversCategory = addCategory(networkItem, "<Receivers>");
+            for (const Ref& rx : receivers) {
+                findOrCreateChild(receiversCategory, Kind::MessageNetworkNode, rx, true);
+            }
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+void DbcTreeModel::addMessageChildren(TreeNode* category, Kind kind, const Ref& association)
+{
+    const NodeNetworkAssociation& nodeNetwork = association.model->nodes()[association.a].networks[association.b];
+    const QList<TxRxMessage>& messages = kind == Kind::TxMessage ? nodeNetwork.tx : nodeNetwork.rx;
+    for (int i = 0; i < messages.size(); ++i) {
+        addChild(category, kind, {association.model, association.a, association.b, i}, false);
+    }
+}
+
+void DbcTreeModel::addSignalChildren(TreeNode* category, const Ref& message)
+{
+    const QList<Signal>& messageSignals = message.model->messages()[message.a].messageSignals;
+    for (int i = 0; i < messageSignals.size(); ++i) {
+        findOrCreateChild(category, Kind::Signal, {message.model, message.a, i}, true);
+    }
+}
+
+void DbcTreeModel::emitChanged(const std::function<bool(const TreeNode&)>& matches)
+{
+    // Only nodes that have been fetched can be visible, so walking the built tree is enough
+    std::function<void(const TreeNode*)> visit = [&](const TreeNode* node) {
+        for (const std::unique_ptr<TreeNode>& child : node->children) {
+            if (matches(*child)) {
+                QModelIndex index = indexFor(child.get());
+                emit dataChanged(index, index);
+            }
+            visit(child.get());
+        }
+    };
+    visit(m_root.get());
+}
@@ -0,0 +1,169 @@
+#ifndef DBCTREEMODEL_H
+#define DBCTREEMODEL_H
+
+#include <QAbstractItemModel>
+#include <QIcon>
+#include <QHash>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "dbcdata.h"
+#include "dbcquery.h"
+
+// Item model over the loaded DbcDataModels. Tree nodes only hold the data model and the
+// indexes of the Network/Node/Message/Signal they stand for, names are read from the data
+// when the view asks for them. Branches are built on demand through fetchMore.
+class DbcTreeModel : public QAbstractItemModel {
+    Q_OBJECT
+
+    public:
+        // Same roles as the item based tree used
+        enum Roles {
+            TypeRole = Qt::UserRole,            // "Category", "Collapsible", "Network", "Node", "Message", ...
+            ModelNamesRole = Qt::UserRole + 1,  // QStringList of the model file names behind the item
+            UniqueKeyRole = Qt::UserRole + 2    // PGN for messages, "node::network" or "node::model" for nodes
+        };
+
+        explicit DbcTreeModel(QObject *parent = nullptr);
+        ~DbcTreeModel();
+
+        void setModels(const QList<DbcDataModel*>& models);
+
+        // Merge one model into the tree or take it out again. Only items referencing the model
+        // are touched; adding a model already in the tree updates its items. removeModel must
+        // be called while the model is still alive.
+        void addModel(DbcDataModel* model);
+        void removeModel(DbcDataModel* model);
+
+        QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+        QModelIndex parent(const QModelIndex& child) const override;
+        int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+        int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+        QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+        Qt::ItemFlags flags(const QModelIndex& index) const override;
+        bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+        bool canFetchMore(const QModelIndex& parent) const override;
+        void fetchMore(const QModelIndex& parent) override;
+
+        // How a top-level item matched a search, as flags
+        enum SearchMatch {
+            NoMatch = 0,
+            NameMatch = 1,      // The item's own name contains the text
+            ContentMatch = 2    // A network, node, message or signal listed under it does
+        };
+
+        // Matches the text against an index of all network, node, message and signal names and
+        // reports every item under the top-level categories with its SearchMatch flags. An empty
+        // text matches every item by name. Field-qualified terms such as pgn:0xFEF1, spn:190 or
+        // attr:GenMsgCycleTime=100 are run through DbcQueryEngine and must match as well.
+        void search(const QString& text, const std::function<void(const QModelIndex& item, int match)>& visit);
+
+        // The lowercase part of a search text matched against names, without field-qualified terms
+        static QString searchWords(const QString& text);
+
+        // Child of parent with the given display name, fetching the children first if needed
+        QModelIndex childByName(const QModelIndex& parent, const QString& name);
+
+        // Notifications for edits made directly on the data models, these only emit
+        // dataChanged for the items showing the edited object
+        void messageChanged(DbcDataModel* model, const Message* message);
+        void signalChanged(DbcDataModel* model, const Signal* signal);
+        void nodeChanged(DbcDataModel* model, const Node* node);
+        void networksChanged();
+
+        // Attribute, SPN or other searchable field edits, for one model or all of them
+        void fieldsChanged(DbcDataModel* model = nullptr);
+
+    private:
+        enum class Kind {
+            Category,           // Top-level <Networks>, <Nodes>, <Messages>
+            Collapsible,        // Grouping items such as <Signals>
+            Network,            // a = network index
+            Node,               // a = node index
+            Message,            // a = message index
+            NetworkNode,        // Node under a network, a = node index, b = association index
+            NodeNetwork,        // Network under a node, a = node index, b = association index
+            TxMessage,          // a = node index, b = association index, c = tx index
+            RxMessage,          // a = node index, b = association index, c = rx index
+            Signal,             // a = message index, b = signal index
+            MessageNetwork,     // Network under a message, a = node index, b = association index
+            MessageNetworkNode  // Transmitter or receiver under a message network, same as NetworkNode
+        };
+
+        // One data model behind a tree node, items merged across models hold one per model
+        struct Ref {
+            DbcDataModel* model = nullptr;
+            int a = -1;
+            int b = -1;
+            int c = -1;
+        };
+
+        struct TreeNode {
+            Kind kind;
+            const char* label = nullptr;    // Category and Collapsible text
+            QList<Ref> refs;
+            TreeNode* parent = nullptr;
+            std::vector<std::unique_ptr<TreeNode>> children;
+            int row = 0;
+            bool fetched = true;
+        };
+
+        std::unique_ptr<TreeNode> m_root;
+        QList<DbcDataModel*> m_models;
+
+        // Children by name, type and unique key, only kept while a branch is being built
+        QHash<const TreeNode*, QHash<QString, TreeNode*>> m_buildLookup;
+
+        // Same lookup for the top-level categories, kept for addModel and rebuilt after renames
+        QHash<const TreeNode*, QHash<QString, TreeNode*>> m_categoryLookup;
+        bool m_categoryLookupDirty = false;
+
+        // Search index, rebuilt on the first search after the tree or a name changed
+        struct SearchEntry {
+            QString name;               // Lowercase
+            const TreeNode* item;       // Top-level item the name is found under
+            bool own;                   // The item's own name rather than its content
+        };
+        std::vector<SearchEntry> m_searchEntries;
+        QHash<quint64, QList<int>> m_searchTrigrams;   // Three packed characters -> entry indexes
+        bool m_searchIndexDirty = true;
+        DbcQueryEngine m_query;
+
+        QIcon m_networkIcon;
+        QIcon m_nodeIcon;
+        QIcon m_messageIcon;
+        QIcon m_signalIcon;
+
+        TreeNode* nodeFor(const QModelIndex& index) const;
+        QModelIndex indexFor(const TreeNode* node) const;
+
+        QString displayName(const TreeNode* node) const;
+        QString typeName(const TreeNode* node) const;
+        QStringList modelNames(const TreeNode* node) const;
+        QVariant uniqueKey(const TreeNode* node) const;
+
+        // Tree building
+        static TreeNode* addChild(TreeNode* parent, Kind kind, const Ref& ref, bool fetched = true);
+        static TreeNode* addCategory(TreeNode* parent, const char* label, Kind kind = Kind::Collapsible);
+        TreeNode* findOrCreateChild(TreeNode* parent, Kind kind, const Ref& ref, bool fetched);
+        QString lookupKey(const TreeNode* node) const;
+        void buildChildren(TreeNode* node);
+        void addMessageChildren(TreeNode* category, Kind kind, const Ref& association);
+        void addSignalChildren(TreeNode* category, const Ref& message);
+
+        // Incremental updates
+        void syncModel(DbcDataModel* model, bool present);
+        void removeChildRows(TreeNode* parent, QList<int> rows);
+        void rebuildBranch(TreeNode* node);
+        void ensureCategoryLookup();
+
+        // Search
+        void buildSearchIndex();
+        void addSearchEntry(const QString& name, const TreeNode* item, bool own);
+        static quint64 trigram(const QChar* chars);
+        int queryMatch(const TreeNode* item, const QHash<DbcDataModel*, DbcQueryMatches>& fieldMatches) const;
+
+        void emitChanged(const std::function<bool(const TreeNode&)>& matches);
+};
+
+#endif // DBCTREEMODEL_H
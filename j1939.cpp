@@ -0,0 +1,146 @@
+#include "j1939.h"
+
+J1939Id J1939Id::fromCanId(quint32 canId)
+{
+    J1939Id id;
+    id.priority = quint8((canId >> 26) & 0x7);
+    id.extendedDataPage = (canId >> 25) & 0x1;
+    id.dataPage = (canId >> 24) & 0x1;
+    id.pduFormat = quint8((canId >> 16) & 0xFF);
+    id.pduSpecific = quint8((canId >> 8) & 0xFF);
+    id.sourceAddress = quint8(canId & 0xFF);
+    id.pgn = (quint32(id.extendedDataPage) << 17) | (quint32(id.dataPage) << 16) | (quint32(id.pduFormat) << 8)
+             | (id.isPdu1() ? 0 : id.pduSpecific);
+    return id;
+}
+
+bool J1939Id::isCanId(quint64 messagePgn)
+{
+    return (messagePgn & DbcExtendedIdFlag) || messagePgn > 0x3FFFF;
+}
+
+quint32 J1939Id::pgnOf(quint64 messagePgn)
+{
+    return isCanId(messagePgn) ? fromCanId(quint32(messagePgn & 0x1FFFFFFF)).pgn : quint32(messagePgn);
+}
+
+void J1939Dispatch::build(const QList<DbcDataModel*>& models)
+{
+    clear();
+    m_pdu2.assign(4 * 16 * 256, Slot());
+
+    for (DbcDataModel* model : models) {
+        const QList<Message>& messages = model->messages();
+        for (int i = 0; i < messages.size(); ++i) {
+            const Message& message = messages[i];
+            const qint32 target = qint32(m_targets.size());
+            bool registered = false;
+
+            // Small ids without the DBC extended flag may be 11-bit identifiers or low PGNs
+            // such as TSC1, so they are entered for both
+            if (!(message.pgn & DbcExtendedIdFlag) && message.pgn <= 0x7FF && !m_standard.contains(quint32(message.pgn))) {
+                m_standard.insert(quint32(message.pgn), target);
+                registered = true;
+            }
+
+            // Anything wider than a PGN is a 29-bit identifier carrying a source address
+            quint32 pgn = quint32(message.pgn);
+            int source = -1;
+            if (J1939Id::isCanId(message.pgn)) {
+                const J1939Id id = J1939Id::fromCanId(quint32(message.pgn & 0x1FFFFFFF));
+                pgn = id.pgn;
+                source = id.sourceAddress;
+            }
+
+            bool duplicate = false;
+            if (source >= 0) {
+                const quint64 key = (quint64(pgn) << 8) | quint64(source);
+                duplicate = m_bySource.contains(key);   // Same identifier twice, the first one wins
+                if (!duplicate) {
+                    m_bySource.insert(key, target);
+                }
+            }
+            if (!duplicate) {
+                Slot* slot = slotFor(pgn);
+                if (slot->target < 0) {
+                    slot->target = target;
+                    registered = true;
+                } else if (source >= 0) {
+                    slot->bySource = true;
+                    registered = true;
+                }
+            }
+
+            if (!registered) {
+                continue;
+            }
+            Target entry{model, i, MessageDecoder(message), message.name, {}, {}, -1, {}};
+            entry.signalNames.reserve(message.messageSignals.size());
+            entry.signalUnits.reserve(message.messageSignals.size());
+            for (int j = 0; j < message.messageSignals.size(); ++j) {
+                const Signal& signal = message.messageSignals[j];
+                entry.signalNames.append(signal.name);
+                entry.signalUnits.append(signal.units);
+                entry.multiplexValues.push_back(signal.multiplexValue);
+                if (signal.isMultiplexer && signal.multiplexValue < 0) {
+                    entry.multiplexer = j;
+                }
+            }
+            m_targets.push_back(std::move(entry));
+        }
+    }
+}
+
+void J1939Dispatch::clear()
+{
+    m_targets.clear();
+    m_pdu2.clear();
+    m_pdu1.clear();
+    m_bySource.clear();
+    m_standard.clear();
+}
+
+const J1939Dispatch::Target* J1939Dispatch::route(quint32 canId, bool extended) const
+{
+    if (!extended) {
+        const qint32 target = m_standard.value(canId & 0x7FF, -1);
+        return target < 0 ? nullptr : &m_targets[size_t(target)];
+    }
+
+    const J1939Id id = J1939Id::fromCanId(canId & 0x1FFFFFFF);
+    const Slot* slot = slotFor(id.pgn);
+    if (!slot || slot->target < 0) {
+        return nullptr;
+    }
+    qint32 target = slot->target;
+    if (slot->bySource) {
+        target = m_bySource.value((quint64(id.pgn) << 8) | id.sourceAddress, target);
+    }
+    return &m_targets[size_t(target)];
+}
+
+J1939Dispatch::Slot* J1939Dispatch::slotFor(quint32 pgn)
+{
+    const int index = pdu2Index(pgn);
+    return index >= 0 ? &m_pdu2[size_t(index)] : &m_pdu1[pgn];
+}
+
+const J1939Dispatch::Slot* J1939Dispatch::slotFor(quint32 pgn) const
+{
+    const int index = pdu2Index(pgn);
+    if (index >= 0) {
+        return m_pdu2.empty() ? nullptr : &m_pdu2[size_t(index)];
+    }
+    auto slot = m_pdu1.constFind(pgn);
+    return slot == m_pdu1.constEnd() ? nullptr : &slot.value();
+}
+
+// Position of a PDU2 PGN in m_pdu2, -1 for PDU1 PGNs
+int J1939Dispatch::pdu2Index(quint32 pgn)
+{
+    const quint32 pduFormat = (pgn >> 8) & 0xFF;
+    if (pduFormat < 240) {
+        return -1;
+    }
+    return int(((pgn >> 16) & 0x3) << 12 | (pduFormat - 240) << 8 | (pgn & 0xFF));
+}
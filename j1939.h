@@ -0,0 +1,91 @@
+#ifndef J1939_H
+#define J1939_H
+
+#include <QtGlobal>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <vector>
+#include "dbcdata.h"
+#include "dbcdecode.h"
+
+// Fields of a 29-bit J1939 CAN identifier
+struct J1939Id {
+    quint8 priority = 0;
+    bool extendedDataPage = false;
+    bool dataPage = false;
+    quint8 pduFormat = 0;
+    quint8 pduSpecific = 0;         // Destination address for PDU1, group extension for PDU2
+    quint8 sourceAddress = 0;
+    quint32 pgn = 0;                // PDU1 PGNs have the destination cleared
+
+    static J1939Id fromCanId(quint32 canId);
+
+    // Whether a Message::pgn holds a 29-bit identifier, as importDBC stores BO_ ids, rather
+    // than a bare PGN as in JSON workspaces
+    static bool isCanId(quint64 messagePgn);
+
+    // PGN of a Message::pgn, whichever of the two it holds
+    static quint32 pgnOf(quint64 messagePgn);
+
+    // PDU1 messages are sent to one destination, PDU2 ones are broadcast
+    bool isPdu1() const { return pduFormat < 240; }
+    quint8 destination() const { return isPdu1() ? pduSpecific : 0xFF; }
+};
+
+// DBC marks extended (29-bit) identifiers in BO_ ids with this bit
+constexpr quint64 DbcExtendedIdFlag = 0x80000000u;
+
+// Routes received frames to the Message describing them. PDU2 PGNs index a flat table covering
+// every data page, PDU1 PGNs and 11-bit identifiers go through one hash probe. Only PGNs that
+// several messages share, typically one per source address, need a second probe by source.
+// Message::pgn may hold a DBC BO_ id, as importDBC stores it, or a bare PGN as in JSON
+// workspaces; bare PGNs match any source address.
+class J1939Dispatch {
+    public:
+        // model and messageIndex only locate the message while the models are unchanged; the
+        // names are copied so results can be reported after the models were edited or closed
+        struct Target {
+            DbcDataModel* model;
+            int messageIndex;
+            MessageDecoder decoder;
+            QString messageName;
+            QStringList signalNames;    // In Message::messageSignals order, like the decoded values
+            QStringList signalUnits;
+            int multiplexer = -1;               // Signal selecting the multiplexed ones, -1 if none
+            std::vector<int> multiplexValues;   // Per signal, -1 for signals in every frame
+        };
+
+        // Indexes every message of the models. Must be rebuilt when messages are added,
+        // removed or get a new identifier.
+        void build(const QList<DbcDataModel*>& models);
+        void clear();
+
+        // Message for a received frame, nullptr if none of the loaded messages matches
+        const Target* route(quint32 canId, bool extended = true) const;
+
+        int size() const { return int(m_targets.size()); }
+
+        // Position of a target returned by route, for per-message bookkeeping
+        int indexOf(const Target* target) const { return int(target - m_targets.data()); }
+        const Target& target(int index) const { return m_targets[size_t(index)]; }
+
+    private:
+        struct Slot {
+            qint32 target = -1;         // First message registered for the PGN
+            bool bySource = false;      // Other messages share the PGN, look in m_bySource first
+        };
+
+        std::vector<Target> m_targets;
+        std::vector<Slot> m_pdu2;                   // (EDP, DP, PF - 240, PS) -> slot
+        QHash<quint32, Slot> m_pdu1;                // PGN -> slot
+        QHash<quint64, qint32> m_bySource;          // PGN << 8 | source address -> target
+        QHash<quint32, qint32> m_standard;          // 11-bit identifier -> target
+
+        Slot* slotFor(quint32 pgn);
+        const Slot* slotFor(quint32 pgn) const;
+        static int pdu2Index(quint32 pgn);
+};
+
+#endif // J1939_H
@@ -0,0 +1,207 @@
+#include "j1939tp.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr quint8 ConnectionManagementFormat = 0xEC;    // PGN 60416
+constexpr quint8 DataTransferFormat = 0xEB;            // PGN 60160
+
+// TP.CM control bytes
+constexpr quint8 RequestToSend = 16;
+constexpr quint8 ClearToSend = 17;
+constexpr quint8 EndOfMessageAck = 19;
+constexpr quint8 BroadcastAnnounce = 32;
+constexpr quint8 ConnectionAbort = 255;
+
+// J1939-21 timeouts in microseconds: T1 between BAM packets, T2/T3 around CTS handshakes
+constexpr qint64 BroadcastTimeout = 750000;
+constexpr qint64 ConnectionTimeout = 1250000;
+
+quint32 readPgn(const uchar* data)
+{
+    return quint32(data[5]) | quint32(data[6]) << 8 | quint32(data[7] & 0x03) << 16;
+}
+
+}
+
+J1939TransportReassembler::J1939TransportReassembler(const J1939Dispatch& dispatch, int capacity)
+    : m_dispatch(dispatch), m_sessions(size_t(std::max(capacity, 1))), m_buffers(m_sessions.size() * MaxPayload) {}
+
+void J1939TransportReassembler::setCompletedCallback(const std::function<void(const Completed&)>& callback)
+{
+    m_callback = callback;
+}
+
+bool J1939TransportReassembler::processFrame(quint32 canId, const uchar* data, int size, qint64 timestamp)
+{
+    const J1939Id id = J1939Id::fromCanId(canId & 0x1FFFFFFF);
+    if (id.pduFormat != ConnectionManagementFormat && id.pduFormat != DataTransferFormat) {
+        return false;
+    }
+    expire(timestamp);
+    if (size < 8) {
+        return true;    // TP frames are always 8 bytes, anything shorter is noise
+    }
+    if (id.pduFormat == ConnectionManagementFormat) {
+        processControl(id, data, timestamp);
+    } else {
+        processData(id, data, size, timestamp);
+    }
+    return true;
+}
+
+void J1939TransportReassembler::expire(qint64 timestamp)
+{
+    for (Session& session : m_sessions) {
+        if (session.active
+            && timestamp - session.lastTimestamp > (session.broadcast ? BroadcastTimeout : ConnectionTimeout)) {
+            session.active = false;
+            ++m_statistics.timedOut;
+        }
+    }
+}
+
+int J1939TransportReassembler::activeSessions() const
+{
+    return int(std::count_if(m_sessions.begin(), m_sessions.end(), [](const Session& session) {
+        return session.active;
+    }));
+}
+
+J1939TransportReassembler::Session* J1939TransportReassembler::find(quint8 source, quint8 destination)
+{
+    for (Session& session : m_sessions) {
+        if (session.active && session.source == source && session.destination == destination) {
+            return &session;
+        }
+    }
+    return nullptr;
+}
+
+void J1939TransportReassembler::processControl(const J1939Id& id, const uchar* data, qint64 timestamp)
+{
+    const quint8 control = data[0];
+    switch (control) {
+    case RequestToSend:
+    case BroadcastAnnounce: {
+        const bool broadcast = control == BroadcastAnnounce;
+        const quint8 destination = broadcast ? 0xFF : id.pduSpecific;
+        const quint16 size = quint16(data[1] | data[2] << 8);
+        const quint8 packets = data[3];
+        if (size < 9 || size > MaxPayload || packets == 0 || packets * 7 < size) {
+            ++m_statistics.dropped;
+            return;
+        }
+
+        Session* session = find(id.sourceAddress, destination);
+        if (session) {
+            ++m_statistics.aborted;
+        } else {
+            auto freeSlot = std::find_if(m_sessions.begin(), m_sessions.end(), [](const Session& slot) {
+                return !slot.active;
+            });
+            if (freeSlot == m_sessions.end()) {
+                ++m_statistics.dropped;
+                return;
+            }
+            session = &*freeSlot;
+        }
+
+        session->active = true;
+        session->broadcast = broadcast;
+        session->source = id.sourceAddress;
+        session->destination = destination;
+        session->priority = id.priority;
+        session->packets = packets;
+        session->nextSequence = 1;
+        session->size = size;
+        session->pgn = readPgn(data);
+        session->lastTimestamp = timestamp;
+        return;
+    }
+    case ClearToSend: {
+        // Sent by the receiver, back to the originator; it keeps the session alive
+        if (Session* session = find(id.pduSpecific, id.sourceAddress)) {
+            session->lastTimestamp = timestamp;
+        }
+        return;
+    }
+    case ConnectionAbort: {
+        // Either side may abort
+        Session* session = find(id.sourceAddress, id.pduSpecific);
+        if (!session) {
+            session = find(id.pduSpecific, id.sourceAddress);
+        }
+        if (session) {
+            session->active = false;
+            ++m_statistics.aborted;
+        }
+        return;
+    }
+    case EndOfMessageAck:
+    default:
+        // The session was completed with its last TP.DT already
+        return;
+    }
+}
+
+void J1939TransportReassembler::processData(const J1939Id& id, const uchar* data, int size, qint64 timestamp)
+{
+    Session* session = find(id.sourceAddress, id.pduSpecific);
+    if (!session) {
+        return;
+    }
+
+    const quint8 sequence = data[0];
+    if (sequence < session->nextSequence) {
+        return;     // Retransmission after a CTS, the data is already stored
+    }
+    if (sequence > session->nextSequence || sequence > session->packets) {
+        session->active = false;
+        ++m_statistics.dropped;
+        return;
+    }
+
+    const int offset = (sequence - 1) * 7;
+    const int count = std::min({7, size - 1, int(session->size) - offset});
+    std::memcpy(buffer(*session) + offset, data + 1, size_t(std::max(count, 0)));
+    session->lastTimestamp = timestamp;
+    ++session->nextSequence;
+
+    if (sequence == session->packets) {
+        complete(*session);
+    }
+}
+
+void J1939TransportReassembler::complete(Session& session)
+{
+    session.active = false;
+    ++m_statistics.completed;
+
+    // Route by an identifier built from the session, PDU1 PGNs carry the destination
+    const quint32 pduSpecific = ((session.pgn >> 8) & 0xFF) < 240 ? session.destination : (session.pgn & 0xFF);
+    const quint32 canId = quint32(session.priority) << 26 | (session.pgn & 0x3FF00) << 8 | pduSpecific << 8
+                          | session.source;
+    const J1939Dispatch::Target* target = m_dispatch.route(canId);
+
+    const double* values = nullptr;
+    if (target) {
+        // Only grows when a larger message shows up, not per session
+        if (m_values.size() < size_t(target->decoder.signalCount())) {
+            m_values.resize(size_t(target->decoder.signalCount()));
+        }
+        target->decoder.decode(buffer(session), session.size, m_values.data());
+        values = m_values.data();
+    }
+
+    if (m_callback) {
+        m_callback(Completed{session.pgn, session.source, session.destination, session.priority,
+                             buffer(session), session.size, target, values});
+    }
+}
+
+uchar* J1939TransportReassembler::buffer(const Session& session)
+{
+    return m_buffers.data() + (&session - m_sessions.data()) * MaxPayload;
+}
@@ -0,0 +1,82 @@
+#ifndef J1939TP_H
+#define J1939TP_H
+
+#include <QtGlobal>
+#include <functional>
+#include <vector>
+#include "j1939.h"
+
+// Reassembles J1939 transport protocol sessions (TP.CM / TP.DT, both BAM and RTS/CTS) seen on
+// a bus or in a capture, and decodes completed payloads with the message routed by the
+// dispatch table. Sessions live in a fixed number of slots with payload buffers reserved up
+// front, so frames are processed without allocating. A session is identified by its source
+// and destination address, as J1939-21 allows one at a time per pair; a new RTS or BAM
+// replaces the one in progress.
+class J1939TransportReassembler {
+    public:
+        // J1939-21 limit for a transport protocol payload
+        static constexpr int MaxPayload = 1785;
+
+        struct Completed {
+            quint32 pgn;
+            quint8 source;
+            quint8 destination;                     // 0xFF for BAM
+            quint8 priority;                        // Of the TP.CM frame that opened the session
+            const uchar* data;
+            int size;
+            const J1939Dispatch::Target* target;    // nullptr when no loaded message has the PGN
+            const double* values;                   // Decoded signals of target, nullptr without one
+        };
+
+        struct Statistics {
+            int completed = 0;
+            int aborted = 0;        // TP.CM Abort or a replacing RTS/BAM
+            int timedOut = 0;
+            int dropped = 0;        // No free slot, or packets out of sequence
+        };
+
+        // The dispatch table must outlive the reassembler
+        explicit J1939TransportReassembler(const J1939Dispatch& dispatch, int capacity = 32);
+
+        // Called for every completed payload; the pointers are only valid during the call
+        void setCompletedCallback(const std::function<void(const Completed&)>& callback);
+
+        // Feeds one received frame with its timestamp in microseconds. Returns false for
+        // frames that are not TP.CM or TP.DT.
+        bool processFrame(quint32 canId, const uchar* data, int size, qint64 timestamp);
+
+        // Drops sessions that have been quiet for longer than the J1939-21 timeouts
+        void expire(qint64 timestamp);
+
+        int activeSessions() const;
+        const Statistics& statistics() const { return m_statistics; }
+
+    private:
+        struct Session {
+            bool active = false;
+            bool broadcast = false;
+            quint8 source = 0;
+            quint8 destination = 0;
+            quint8 priority = 0;
+            quint8 packets = 0;             // Number of TP.DT packets announced
+            quint8 nextSequence = 1;
+            quint16 size = 0;
+            quint32 pgn = 0;
+            qint64 lastTimestamp = 0;
+        };
+
+        const J1939Dispatch& m_dispatch;
+        std::vector<Session> m_sessions;
+        std::vector<uchar> m_buffers;       // MaxPayload bytes per session
+        std::vector<double> m_values;
+        std::function<void(const Completed&)> m_callback;
+        Statistics m_statistics;
+
+        Session* find(quint8 source, quint8 destination);
+        void processControl(const J1939Id& id, const uchar* data, qint64 timestamp);
+        void processData(const J1939Id& id, const uchar* data, int size, qint64 timestamp);
+        void complete(Session& session);
+        uchar* buffer(const Session& session);
+};
+
+#endif // J1939TP_H
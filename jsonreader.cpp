@@ -0,0 +1,385 @@
+#include "jsonreader.h"
+#include <charconv>
+#include <cmath>
+#include <limits>
+
+JsonPullReader::JsonPullReader(const char* begin, const char* end)
+    : m_begin(begin), m_pos(begin), m_end(end) {}
+
+JsonPullReader::Type JsonPullReader::peek()
+{
+    skipWhitespace();
+    if (hasError() || m_pos >= m_end) {
+        return Type::Invalid;
+    }
+    switch (*m_pos) {
+    case '{': return Type::Object;
+    case '[': return Type::Array;
+    case '"': return Type::String;
+    case 't':
+    case 'f': return Type::Bool;
+    case 'n': return Type::Null;
+    default:
+        if (*m_pos == '-' || (*m_pos >= '0' && *m_pos <= '9')) {
+            return Type::Number;
+        }
+        return Type::Invalid;
+    }
+}
+
+bool JsonPullReader::enterObject()
+{
+    if (peek() != Type::Object) {
+        fail("object expected");
+        return false;
+    }
+    ++m_pos;
+    m_first.append(true);
+    return true;
+}
+
+bool JsonPullReader::nextKey(std::string_view& key)
+{
+    if (!nextMember('}')) {
+        return false;
+    }
+    skipWhitespace();
+    if (m_pos >= m_end || *m_pos != '"') {
+        fail("object key expected");
+        return false;
+    }
+    return parseString(key) && expect(':');
+}
+
+bool JsonPullReader::enterArray()
+{
+    if (peek() != Type::Array) {
+        fail("array expected");
+        return false;
+    }
+    ++m_pos;
+    m_first.append(true);
+    return true;
+}
+
+bool JsonPullReader::nextElement()
+{
+    return nextMember(']');
+}
+
+// Consumes the separator in front of the next member, or the closing bracket
+bool JsonPullReader::nextMember(char close)
+{
+    skipWhitespace();
+    if (hasError() || m_first.isEmpty()) {
+        return false;
+    }
+    if (m_pos < m_end && *m_pos == close) {
+        ++m_pos;
+        m_first.removeLast();
+        return false;
+    }
+    if (m_first.last()) {
+        m_first.last() = false;
+        return true;
+    }
+    return expect(',');
+}
+
+QString JsonPullReader::readString(const QString& defaultValue)
+{
+    if (peek() != Type::String) {
+        skipValue();
+        return defaultValue;
+    }
+    std::string_view text;
+    if (!parseString(text)) {
+        return defaultValue;
+    }
+    return QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()));
+}
+
+int JsonPullReader::readInt(int defaultValue)
+{
+    const double value = readDouble(std::numeric_limits<double>::quiet_NaN());
+    // Same rule as QJsonValue::toInt: only numbers that are exactly an int
+    if (std::isnan(value) || value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()
+        || std::floor(value) != value) {
+        return defaultValue;
+    }
+    return static_cast<int>(value);
+}
+
+quint64 JsonPullReader::readUInt64(quint64 defaultValue)
+{
+    const Type type = peek();
+    if (type == Type::String) {
+        bool ok = false;
+        const quint64 value = readString().toULongLong(&ok);
+        return ok ? value : defaultValue;
+    }
+    if (type != Type::Number) {
+        skipValue();
+        return defaultValue;
+    }
+    std::string_view text;
+    if (!parseNumber(text)) {
+        return defaultValue;
+    }
+    // Plain integers are read exactly, anything else goes through double
+    quint64 value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec == std::errc() && result.ptr == text.data() + text.size()) {
+        return value;
+    }
+    double number = 0.0;
+    result = std::from_chars(text.data(), text.data() + text.size(), number);
+    if (result.ec != std::errc() || number < 0) {
+        return defaultValue;
+    }
+    return static_cast<quint64>(number);
+}
+
+double JsonPullReader::readDouble(double defaultValue)
+{
+    if (peek() != Type::Number) {
+        skipValue();
+        return defaultValue;
+    }
+    std::string_view text;
+    if (!parseNumber(text)) {
+        return defaultValue;
+    }
+    double value = 0.0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() ? value : defaultValue;
+}
+
+bool JsonPullReader::readBool(bool defaultValue)
+{
+    if (peek() != Type::Bool) {
+        skipValue();
+        return defaultValue;
+    }
+    if (*m_pos == 't') {
+        return parseLiteral("true", 4) ? true : defaultValue;
+    }
+    return parseLiteral("false", 5) ? false : defaultValue;
+}
+
+QVariant JsonPullReader::readVariant()
+{
+    switch (peek()) {
+    case Type::Bool:
+        return readBool();
+    case Type::String:
+        return readString();
+    case Type::Number: {
+        std::string_view text;
+        if (!parseNumber(text)) {
+            return QVariant();
+        }
+        qlonglong integer = 0;
+        auto result = std::from_chars(text.data(), text.data() + text.size(), integer);
+        if (result.ec == std::errc() && result.ptr == text.data() + text.size()) {
+            return integer;
+        }
+        double number = 0.0;
+        std::from_chars(text.data(), text.data() + text.size(), number);
+        return number;
+    }
+    default:
+        skipValue();
+        return QVariant();
+    }
+}
+
+void JsonPullReader::skipValue()
+{
+    std::string_view ignored;
+    switch (peek()) {
+    case Type::Object:
+        enterObject();
+        while (nextKey(ignored)) {
+            skipValue();
+        }
+        break;
+    case Type::Array:
+        enterArray();
+        while (nextElement()) {
+            skipValue();
+        }
+        break;
+    case Type::String:
+        parseString(ignored);
+        break;
+    case Type::Number:
+        parseNumber(ignored);
+        break;
+    case Type::Bool:
+        if (*m_pos == 't') {
+            parseLiteral("true", 4);
+        } else {
+            parseLiteral("false", 5);
+        }
+        break;
+    case Type::Null:
+        parseLiteral("null", 4);
+        break;
+    case Type::Invalid:
+        fail("value expected");
+        break;
+    }
+}
+
+bool JsonPullReader::finish()
+{
+    skipWhitespace();
+    if (!hasError() && m_pos < m_end) {
+        fail("garbage at the end of the document");
+    }
+    return !hasError();
+}
+
+void JsonPullReader::skipWhitespace()
+{
+    while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\n' || *m_pos == '\r' || *m_pos == '\t')) {
+        ++m_pos;
+    }
+}
+
+bool JsonPullReader::expect(char c)
+{
+    skipWhitespace();
+    if (hasError()) {
+        return false;
+    }
+    if (m_pos >= m_end || *m_pos != c) {
+        fail(c == ':' ? "colon expected" : c == ',' ? "comma expected" : "unexpected character");
+        return false;
+    }
+    ++m_pos;
+    return true;
+}
+
+// Strings without escapes are returned as a view into the source, others are decoded into
+// m_scratch. Either way the view holds UTF-8.
+bool JsonPullReader::parseString(std::string_view& text)
+{
+    const char* start = ++m_pos;
+    while (m_pos < m_end && *m_pos != '"' && *m_pos != '\\') {
+        ++m_pos;
+    }
+    if (m_pos < m_end && *m_pos == '"') {
+        text = std::string_view(start, static_cast<size_t>(m_pos - start));
+        ++m_pos;
+        return true;
+    }
+
+    m_scratch = QByteArray(start, m_pos - start);
+    auto hexValue = [this](uint& value) {
+        if (m_end - m_pos < 4) {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char c = *m_pos++;
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= uint(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                value |= uint(c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                value |= uint(c - 'A' + 10);
+            } else {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    while (m_pos < m_end && *m_pos != '"') {
+        if (*m_pos != '\\') {
+            m_scratch.append(*m_pos++);
+            continue;
+        }
+        if (++m_pos >= m_end) {
+            break;
+        }
+        const char escape = *m_pos++;
+        switch (escape) {
+        case '"':  m_scratch.append('"'); break;
+        case '\\': m_scratch.append('\\'); break;
+        case '/':  m_scratch.append('/'); break;
+        case 'b':  m_scratch.append('\b'); break;
+        case 'f':  m_scratch.append('\f'); break;
+        case 'n':  m_scratch.append('\n'); break;
+        case 'r':  m_scratch.append('\r'); break;
+        case 't':  m_scratch.append('\t'); break;
+        case 'u': {
+            uint code = 0;
+            if (!hexValue(code)) {
+                fail("invalid unicode escape");
+                return false;
+            }
+            // High surrogate, combine with the following \uDCxx
+            if (code >= 0xD800 && code < 0xDC00 && m_end - m_pos >= 6 && m_pos[0] == '\\' && m_pos[1] == 'u') {
+                m_pos += 2;
+                uint low = 0;
+                if (!hexValue(low) || low < 0xDC00 || low > 0xDFFF) {
+                    fail("invalid surrogate pair");
+                    return false;
+                }
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+            const char32_t codePoint = code;
+            m_scratch.append(QString::fromUcs4(&codePoint, 1).toUtf8());
+            break;
+        }
+        default:
+            fail("invalid escape sequence");
+            return false;
+        }
+    }
+    if (m_pos >= m_end) {
+        fail("unterminated string");
+        return false;
+    }
+    ++m_pos;
+    text = std::string_view(m_scratch.constData(), static_cast<size_t>(m_scratch.size()));
+    return true;
+}
+
+bool JsonPullReader::parseNumber(std::string_view& text)
+{
+    const char* start = m_pos;
+    while (m_pos < m_end && ((*m_pos >= '0' && *m_pos <= '9') || *m_pos == '-' || *m_pos == '+'
+                             || *m_pos == '.' || *m_pos == 'e' || *m_pos == 'E')) {
+        ++m_pos;
+    }
+    text = std::string_view(start, static_cast<size_t>(m_pos - start));
+    double check = 0.0;
+    auto result = std::from_chars(start, m_pos, check);
+    if (result.ptr != m_pos) {
+        fail("invalid number");
+        return false;
+    }
+    return true;
+}
+
+bool JsonPullReader::parseLiteral(const char* literal, int size)
+{
+    if (m_end - m_pos < size || std::string_view(m_pos, size) != std::string_view(literal, size)) {
+        fail("invalid literal");
+        return false;
+    }
+    m_pos += size;
+    return true;
+}
+
+void JsonPullReader::fail(const char* message)
+{
+    if (m_error.isEmpty()) {
+        m_error = QString("%1 at offset %2").arg(QLatin1String(message)).arg(offset());
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <QVarLengthArray>
+#include <string_view>
+
+// Pull parser over a JSON text held in memory, typically a mapped file. The caller walks the
+// document in order: after enterObject, nextKey is called until it returns false and every key
+// must be followed by exactly one read*Value or skipValue; arrays work the same way with
+// enterArray and nextElement. Values of an unexpected type are skipped and the given default is
+// returned, like QJsonValue does. After a syntax error every call fails or returns its default,
+// so loops over objects and arrays terminate on their own.
+class JsonPullReader {
+    public:
+        enum class Type { Null, Bool, Number, String, Array, Object, Invalid };
+
+        JsonPullReader(const char* begin, const char* end);
+
+        // Type of the next value without consuming it
+        Type peek();
+
+        bool enterObject();
+        // Next key of the current object, false once the object is closed. The view is only
+        // valid until the next call.
+        bool nextKey(std::string_view& key);
+
+        bool enterArray();
+        // True if the current array has another element, false once the array is closed
+        bool nextElement();
+
+        QString readString(const QString& defaultValue = QString());
+        int readInt(int defaultValue = 0);
+        quint64 readUInt64(quint64 defaultValue = 0);
+        double readDouble(double defaultValue = 0.0);
+        bool readBool(bool defaultValue = false);
+        // Null, bool, qlonglong, double or QString; arrays and objects come back as null
+        QVariant readVariant();
+        void skipValue();
+
+        // Checks that only whitespace follows the top-level value
+        bool finish();
+
+        bool hasError() const { return !m_error.isEmpty(); }
+        QString errorString() const { return m_error; }
+        const char* position() const { return m_pos; }
+        qint64 offset() const { return m_pos - m_begin; }
+
+    private:
+        const char* m_begin;
+        const char* m_pos;
+        const char* m_end;
+        QString m_error;
+        QVarLengthArray<bool, 16> m_first;  // Per open container, whether no member was read yet
+        QByteArray m_scratch;               // Decoded text of strings containing escapes
+
+        void skipWhitespace();
+        bool expect(char c);
+        bool nextMember(char close);
+        bool parseString(std::string_view& text);
+        bool parseNumber(std::string_view& text);
+        bool parseLiteral(const char* literal, int size);
+        void fail(const char* message);
+};
+
+#endif // JSONREADER_H
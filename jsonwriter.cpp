@@ -0,0 +1,195 @@
+#include "jsonwriter.h"
+#include <QLocale>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+// Output is handed to the device in chunks of this size
+constexpr int BufferSize = 64 * 1024;
+}
+
+JsonStreamWriter::JsonStreamWriter(QIODevice* device, bool compact)
+    : m_device(device), m_compact(compact) {
+    m_buffer.reserve(BufferSize + 1024);
+}
+
+JsonStreamWriter::~JsonStreamWriter() {
+    flush();
+}
+
+void JsonStreamWriter::beginObject()
+{
+    beforeValue();
+    append('{');
+    m_hasItems.append(false);
+}
+
+void JsonStreamWriter::endObject()
+{
+    const bool hasItems = m_hasItems.takeLast();
+    if (hasItems) {
+        newline();
+    }
+    append('}');
+}
+
+void JsonStreamWriter::beginArray()
+{
+    beforeValue();
+    append('[');
+    m_hasItems.append(false);
+}
+
+void JsonStreamWriter::endArray()
+{
+    const bool hasItems = m_hasItems.takeLast();
+    if (hasItems) {
+        newline();
+    }
+    append(']');
+}
+
+void JsonStreamWriter::key(const char* name)
+{
+    beforeValue();
+    append('"');
+    append(name, int(std::strlen(name)));
+    append('"');
+    if (m_compact) {
+        append(':');
+    } else {
+        append(": ", 2);
+    }
+    m_afterKey = true;
+}
+
+void JsonStreamWriter::value(const QString& text)
+{
+    beforeValue();
+    appendString(text);
+}
+
+void JsonStreamWriter::value(qint64 number)
+{
+    beforeValue();
+    char digits[24];
+    const int size = std::snprintf(digits, sizeof(digits), "%lld", static_cast<long long>(number));
+    append(digits, size);
+}
+
+void JsonStreamWriter::value(int number)
+{
+    value(static_cast<qint64>(number));
+}
+
+void JsonStreamWriter::value(double number)
+{
+    beforeValue();
+    // JSON has no representation for NaN or infinity, QJsonDocument writes null for them too
+    if (!std::isfinite(number)) {
+        append("null", 4);
+        return;
+    }
+    const QByteArray digits = QByteArray::number(number, 'g', QLocale::FloatingPointShortest);
+    append(digits.constData(), int(digits.size()));
+}
+
+void JsonStreamWriter::value(bool flag)
+{
+    beforeValue();
+    if (flag) {
+        append("true", 4);
+    } else {
+        append("false", 5);
+    }
+}
+
+bool JsonStreamWriter::flush()
+{
+    if (!m_buffer.isEmpty() && !m_error) {
+        if (m_device->write(m_buffer) != m_buffer.size()) {
+            m_error = true;
+        }
+    }
+    m_buffer.clear();
+    return !m_error;
+}
+
+bool JsonStreamWriter::hasError() const
+{
+    return m_error;
+}
+
+// Places the separator and indentation in front of the next value
+void JsonStreamWriter::beforeValue()
+{
+    if (m_afterKey) {
+        m_afterKey = false;
+        return;
+    }
+    if (m_hasItems.isEmpty()) {
+        return;
+    }
+    if (m_hasItems.last()) {
+        append(',');
+    }
+    m_hasItems.last() = true;
+    newline();
+}
+
+void JsonStreamWriter::newline()
+{
+    if (m_compact) {
+        return;
+    }
+    append('\n');
+    for (int i = 0; i < m_hasItems.size(); ++i) {
+        append("    ", 4);
+    }
+}
+
+void JsonStreamWriter::append(const char* data, int size)
+{
+    m_buffer.append(data, size);
+    if (m_buffer.size() >= BufferSize) {
+        flush();
+    }
+}
+
+void JsonStreamWriter::append(char c)
+{
+    m_buffer.append(c);
+    if (m_buffer.size() >= BufferSize) {
+        flush();
+    }
+}
+
+void JsonStreamWriter::appendString(const QString& text)
+{
+    static const char hex[] = "0123456789abcdef";
+    const QByteArray utf8 = text.toUtf8();
+
+    append('"');
+    for (char c : utf8) {
+        const unsigned char byte = static_cast<unsigned char>(c);
+        switch (c) {
+        case '"':  append("\\\"", 2); break;
+        case '\\': append("\\\\", 2); break;
+        case '\b': append("\\b", 2); break;
+        case '\f': append("\\f", 2); break;
+        case '\n': append("\\n", 2); break;
+        case '\r': append("\\r", 2); break;
+        case '\t': append("\\t", 2); break;
+        default:
+            if (byte < 0x20) {
+                const char escaped[] = {'\\', 'u', '0', '0', hex[byte >> 4], hex[byte & 0xF]};
+                append(escaped, 6);
+            } else {
+                m_buffer.append(c);
+            }
+            break;
+        }
+    }
+    append('"');
+}
@@ -0,0 +1,50 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <QList>
+
+// Writes JSON to a device as it is produced, through a fixed-size buffer, so the document never
+// exists in memory as a whole. Values are written in call order; the writer only tracks enough
+// nesting state to place commas, colons and indentation.
+class JsonStreamWriter {
+    public:
+        explicit JsonStreamWriter(QIODevice* device, bool compact = false);
+        ~JsonStreamWriter();
+
+        void beginObject();
+        void endObject();
+        void beginArray();
+        void endArray();
+
+        // Object member name, followed by exactly one value or container
+        void key(const char* name);
+
+        void value(const QString& text);
+        void value(qint64 number);
+        void value(int number);
+        void value(double number);
+        void value(bool flag);
+
+        // Writes the buffered output to the device, returns false if the device failed
+        bool flush();
+        bool hasError() const;
+
+    private:
+        QIODevice* m_device;
+        bool m_compact;
+        bool m_error = false;
+        QByteArray m_buffer;
+        QList<bool> m_hasItems;     // Per open container, whether anything was written into it
+        bool m_afterKey = false;
+
+        void beforeValue();
+        void newline();
+        void append(const char* data, int size);
+        void append(char c);
+        void appendString(const QString& text);
+};
+
+#endif // JSONWRITER_H
@@ -1,8 +1,12 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
 #include "./dbctree.h"
+#include "./jsonwriter.h"
+#include "./dbcsnapshot.h"
+#include "./dbccache.h"
+#include "./canlog.h"
 #include <QMainWindow>
-#include <QTreeWidget>
+#include <QTreeView>
 #include <QFormLayout>
 #include <QLineEdit>
 #include <QTabWidget>
@@ -11,6 +15,7 @@
 #include <QCheckBox>
 #include <QSpinBox>
 #include <QMessageBox>
+#include <QInputDialog>
 #include <QHeaderView>
 #include <QLabel>
 #include <QPushButton>
@@ -22,7 +27,16 @@
 #include <QDir>
 #include <QSettings>
 #include <QFileInfo>
-#include <QJsonDocument>
+#include <QSaveFile>
+#include <QTimer>
+#include <QProgressDialog>
+#include <QFutureWatcher>
+#include <QPromise>
+#include <QtConcurrent>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWindow), dbcTree(new DbcTree()) {
     // Window Icon (Default)
@@ -33,7 +47,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     setCentralWidget(centralWidget);
 
     // Set up Tree item selection
-    connect(dbcTree, &QTreeWidget::itemClicked, this, &MainWindow::onTreeItemClicked);
+    connect(dbcTree, &QTreeView::clicked, this, &MainWindow::onTreeItemClicked);
 
     // Set up Right Panels
     setupRightPanel();
@@ -55,7 +69,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
         clearRightPanel();
     });
 
-    QAction *openJson = new QAction("Open from JSON...", this);
+    QAction *openJson = new QAction("Open Workspace...", this);
     fileMenu->addAction(openJson);
     // Connect File Actions
     connect(openJson, &QAction::triggered, this, [this]() {
@@ -65,9 +79,9 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
 
         QString selectedFile = QFileDialog::getOpenFileName(
             nullptr,
-            "Import JSON File",
+            "Open Workspace",
             lastDir,
-            "JSON Files (*.json)"
+            "Workspaces (*.json *.hiws);;JSON Files (*.json);;Binary Workspaces (*.hiws)"
             );
         if (!selectedFile.isEmpty()) {
             // Store last directory used
@@ -75,7 +89,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
             QString selectedDir = fileInfo.absolutePath();
             settings.setValue("lastWorkingDir", selectedDir);
 
-            openJsonFile(selectedFile);
+            openWorkspaceFile(selectedFile);
         }
     });
 
@@ -84,27 +98,27 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     fileMenu->addMenu(recentSavesMenu);
     connect(recentSavesMenu, &QMenu::triggered, this, &MainWindow::openRecentSave);
 
-    // Import DBC
-    QAction *importDBC = new QAction("Import DBC...", this);
+    // Import DBCs (multi-select, parsed in parallel)
+    QAction *importDBC = new QAction("Import DBCs...", this);
     fileMenu->addAction(importDBC);
     connect(importDBC, &QAction::triggered, this, [this]() {
         QSettings settings("Oshkosh", "HeavyInsight");
 
         QString lastDir = settings.value("lastWorkingDir", QDir::currentPath()).toString();
 
-        QString selectedFile = QFileDialog::getOpenFileName(
+        QStringList selectedFiles = QFileDialog::getOpenFileNames(
             nullptr,
-            "Import DBC File",
+            "Import DBC Files",
             lastDir,
             "DBC Files (*.dbc)"
             );
-        if (!selectedFile.isEmpty()) {
+        if (!selectedFiles.isEmpty()) {
             // Store last directory used
-            QFileInfo fileInfo(selectedFile);
+            QFileInfo fileInfo(selectedFiles.first());
             QString selectedDir = fileInfo.absolutePath();
             settings.setValue("lastWorkingDir", selectedDir);
 
-            importDBCFile(selectedFile);
+            importDBCFiles(selectedFiles);
         }
     });
     // Create Recent Imports menu
@@ -126,7 +140,100 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     QAction *exportDBC = new QAction("Export DBC...", this);
     fileMenu->addAction(exportDBC);
     connect(exportDBC, &QAction::triggered, this, [this]() {
-        // TODO: Implement DBC export functionality
+        if (dbcModels.isEmpty()) {
+            QMessageBox::information(this, "Export DBC", "There is nothing to export.");
+            return;
+        }
+
+        // A DBC file holds one model, ask which one when several are loaded
+        int modelIndex = 0;
+        if (dbcModels.size() > 1) {
+            QStringList modelNames;
+            for (DbcDataModel* model : dbcModels) {
+                modelNames.append(model->fileName());
+            }
+            bool ok = false;
+            const QString modelName = QInputDialog::getItem(this, "Export DBC", "Model to export:", modelNames, 0, false, &ok);
+            if (!ok) {
+                return;
+            }
+            modelIndex = modelNames.indexOf(modelName);
+        }
+        DbcDataModel* model = dbcModels[modelIndex];
+        if (model->networks().size() > 1) {
+            QMessageBox::warning(this, "Export DBC",
+                                 QString("%1 has %2 networks, a DBC file holds one.")
+                                     .arg(model->fileName())
+                                     .arg(model->networks().size()));
+            return;
+        }
+
+        QSettings settings("Oshkosh", "HeavyInsight");
+        QString lastDir = settings.value("lastWorkingDir", QDir::currentPath()).toString();
+        QString exportPath = QFileDialog::getSaveFileName(
+            this,
+            tr("Export DBC"),
+            QDir(lastDir).filePath(QFileInfo(model->fileName()).completeBaseName() + ".dbc"),
+            tr("DBC Files (*.dbc)")
+            );
+        if (exportPath.isEmpty()) {
+            return;
+        }
+        settings.setValue("lastWorkingDir", QFileInfo(exportPath).absolutePath());
+
+        if (!model->exportDBC(exportPath)) {
+            QMessageBox::warning(this, "Export Error", "Failed to export DBC file.");
+        }
+    });
+
+    // Close one model, the others stay loaded
+    QAction *closeModel = new QAction("Close Model...", this);
+    fileMenu->addAction(closeModel);
+    connect(closeModel, &QAction::triggered, this, [this]() {
+        if (dbcModels.isEmpty()) {
+            QMessageBox::information(this, "Close Model", "There is nothing to close.");
+            return;
+        }
+
+        QStringList modelNames;
+        for (DbcDataModel* model : dbcModels) {
+            modelNames.append(model->fileName());
+        }
+        bool ok = false;
+        const QString modelName = QInputDialog::getItem(this, "Close Model", "Model to close:", modelNames, 0, false, &ok);
+        if (!ok) {
+            return;
+        }
+        DbcDataModel* model = dbcModels[modelNames.indexOf(modelName)];
+
+        // The panel may show the model's items and the tree needs it alive to drop them
+        clearRightPanel();
+        dbcTree->removeModel(model);
+        dbcModels.removeAll(model);
+        delete model;
+    });
+
+    // Decode a CAN log against the loaded messages
+    QAction *decodeLog = new QAction("Decode CAN Log...", this);
+    fileMenu->addAction(decodeLog);
+    connect(decodeLog, &QAction::triggered, this, [this]() {
+        if (dbcModels.isEmpty()) {
+            QMessageBox::information(this, "Decode CAN Log", "Load or import messages to decode the log with first.");
+            return;
+        }
+
+        QSettings settings("Oshkosh", "HeavyInsight");
+        QString lastDir = settings.value("lastWorkingDir", QDir::currentPath()).toString();
+        QString logPath = QFileDialog::getOpenFileName(
+            this,
+            tr("Decode CAN Log"),
+            lastDir,
+            CanLogReader::fileFilter()
+            );
+        if (!logPath.isEmpty()) {
+            settings.setValue("lastWorkingDir", QFileInfo(logPath).absolutePath());
+            decodeCanLog(logPath);
+        }
     });
 
     // Save workspace as a JSON
@@ -152,7 +259,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
         }
 
         if (!saveFilePath.isEmpty()) {
-            saveAsJson(saveFilePath);
+            saveWorkspace(saveFilePath);
         }
     });
 
@@ -164,18 +271,30 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
             defaultPath = saveFilePath;
         }
         // Open a QFileDialog to let the user select the save location and file name
+        const QString indentedFilter = tr("JSON Files (*.json)");
+        const QString compactFilter = tr("Compact JSON Files (*.json)");
+        const QString binaryFilter = tr("Binary Workspaces (*.hiws)");
+        QString selectedFilter = saveCompact ? compactFilter : indentedFilter;
+        if (QFileInfo(defaultPath).suffix() == DbcSnapshot::Suffix) {
+            selectedFilter = binaryFilter;
+        }
         QString savePath = QFileDialog::getSaveFileName(
             this,
             tr("Save Workspace As"),
             defaultPath,
-            tr("JSON Files (*.json)")
+            indentedFilter + ";;" + compactFilter + ";;" + binaryFilter,
+            &selectedFilter
             );
 
 
-        // Check if the user selected a file path
+        // Check if the user selected a file path, later saves keep the chosen format
         if (!savePath.isEmpty()) {
+            if (selectedFilter == binaryFilter && QFileInfo(savePath).suffix() != DbcSnapshot::Suffix) {
+                savePath += QString(".") + DbcSnapshot::Suffix;
+            }
             saveFilePath = savePath;
-            saveAsJson(savePath);
+            saveCompact = selectedFilter == compactFilter;
+            saveWorkspace(savePath);
         }
     });
 
@@ -191,28 +310,14 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     QAction *expandAllAction = new QAction("Expand All", this);
     editMenu->addAction(expandAllAction);
     connect(expandAllAction, &QAction::triggered, this, [this]() {
-        QTreeWidgetItemIterator it(dbcTree);
-        while(*it) {
-            QTreeWidgetItem *item = *it;
-            if(item->childCount() > 0) {
-                item->setExpanded(true);
-            }
-            it++;
-        }
+        dbcTree->expandAllItems();
     });
 
     // Add collapse all action to Edit menu
     QAction *collapseAllAction = new QAction("Collapse All", this);
     editMenu->addAction(collapseAllAction);
     connect(collapseAllAction, &QAction::triggered, this, [this]() {
-        QTreeWidgetItemIterator it(dbcTree);
-        while(*it) {
-            QTreeWidgetItem *item = *it;
-            if(item->childCount() > 0) {
-                item->setExpanded(false);
-            }
-            it++;
-        }
+        dbcTree->collapseAll();
     });
 
     // View Menu
@@ -241,7 +346,14 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     // Search Bar
     QLineEdit *searchBar = new QLineEdit;
     searchBar->setPlaceholderText("Search...");
-    connect(searchBar, &QLineEdit::textChanged, this, &MainWindow::filterTreeItems);
+    // Filter once typing pauses rather than on every keystroke
+    QTimer *searchTimer = new QTimer(this);
+    searchTimer->setSingleShot(true);
+    searchTimer->setInterval(200);
+    connect(searchBar, &QLineEdit::textChanged, searchTimer, qOverload<>(&QTimer::start));
+    connect(searchTimer, &QTimer::timeout, this, [this, searchBar]() {
+        filterTreeItems(searchBar->text());
+    });
 
     leftLayout->addWidget(searchBar);
     leftLayout->addWidget(dbcTree);
@@ -324,7 +436,7 @@ void MainWindow::openRecentSave(QAction *action)
     QString filePath = action->data().toString();
     QFileInfo fileInfo(filePath);
     if (fileInfo.exists() && fileInfo.isFile()) {
-        openJsonFile(filePath);
+        openWorkspaceFile(filePath);
     } else {
         QMessageBox::warning(this, "File Not Found", "The file '" + filePath + "' could not be found.");
         recentSaves.removeAll(filePath);
@@ -353,44 +465,285 @@ void MainWindow::openRecentImport(QAction *action)
     }
 }
 
+// Runs a parse job on the thread pool behind a cancellable progress dialog.
+// The job must only touch models the GUI thread is not using; onFinished runs on the GUI thread.
+void MainWindow::runModelJob(const QString &label,
+                             std::function<bool(const DbcDataModel::ProgressCallback&)> job,
+                             std::function<void(bool ok, bool canceled)> onFinished)
+{
+    QProgressDialog *progressDialog = new QProgressDialog(label, "Cancel", 0, 100, this);
+    progressDialog->setWindowModality(Qt::WindowModal);
+    progressDialog->setMinimumDuration(500); // Small files finish before the dialog shows up
+    progressDialog->setAutoClose(false);
+    progressDialog->setAutoReset(false);
+
+    QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::progressValueChanged, progressDialog, &QProgressDialog::setValue);
+    connect(progressDialog, &QProgressDialog::canceled, watcher, &QFutureWatcher<bool>::cancel);
+
+    // finished is only emitted once the job has returned, even after a cancel
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [watcher, progressDialog, onFinished]() {
+        const bool canceled = watcher->isCanceled();
+        const bool ok = !canceled && watcher->future().resultCount() > 0 && watcher->result();
+        progressDialog->deleteLater();
+        watcher->deleteLater();
+        onFinished(ok, canceled);
+    });
+
+    watcher->setFuture(QtConcurrent::run([job](QPromise<bool> &promise) {
+        promise.setProgressRange(0, 100);
+        const bool ok = job([&promise](int percent) {
+            promise.setProgressValue(percent);
+            return !promise.isCanceled();
+        });
+        promise.addResult(ok);
+    }));
+}
+
 void MainWindow::openJsonFile(const QString &filePath)
 {
     if (!filePath.isEmpty()) {
-        // Load the JSON file into the data model
+        // Load the JSON file into a new data model on a worker thread
         DbcDataModel* newModel = new DbcDataModel();
         newModel->setFileName(QFileInfo(filePath).fileName());
-        if (newModel->loadJson(filePath)) {
-            saveFilePath = filePath;
-            qDeleteAll(dbcModels);
-            dbcModels.clear();
-            dbcModels.append(newModel);
-            updateDbcTree();
-
-            addRecentSave(filePath);
-        } else {
-            QMessageBox::warning(this, "Import Error", "Failed to import JSON file.");
-            delete newModel;
-        }
+
+        runModelJob("Loading " + newModel->fileName() + "...",
+                    [newModel, filePath](const DbcDataModel::ProgressCallback &progress) {
+                        return newModel->loadJson(filePath, progress);
+                    },
+                    [this, newModel, filePath](bool ok, bool canceled) {
+                        if (ok) {
+                            // Swap in the loaded workspace
+                            saveFilePath = filePath;
+                            qDeleteAll(dbcModels);
+                            dbcModels.clear();
+                            dbcModels.append(newModel);
+                            updateDbcTree();
+
+                            addRecentSave(filePath);
+                        } else {
+                            if (!canceled) {
+                                QMessageBox::warning(this, "Import Error", "Failed to import JSON file.");
+                            }
+                            delete newModel;
+                        }
+                    });
+    }
+}
+
+void MainWindow::openSnapshotFile(const QString &filePath)
+{
+    // Models are created on the worker thread and handed over once the whole file was read
+    auto loaded = std::make_shared<QList<DbcDataModel*>>();
+
+    runModelJob("Loading " + QFileInfo(filePath).fileName() + "...",
+                [loaded, filePath](const DbcDataModel::ProgressCallback &progress) {
+                    return DbcSnapshot::load(filePath, *loaded, progress);
+                },
+                [this, loaded, filePath](bool ok, bool canceled) {
+                    if (ok) {
+                        // Swap in the loaded workspace
+                        saveFilePath = filePath;
+                        qDeleteAll(dbcModels);
+                        dbcModels = *loaded;
+                        updateDbcTree();
+
+                        addRecentSave(filePath);
+                    } else {
+                        qDeleteAll(*loaded);
+                        if (!canceled) {
+                            QMessageBox::warning(this, "Import Error", "Failed to open binary workspace.");
+                        }
+                    }
+                });
+}
+
+// Binary workspaces are recognised by their header, anything else is read as JSON
+void MainWindow::openWorkspaceFile(const QString &filePath)
+{
+    if (DbcSnapshot::isSnapshot(filePath)) {
+        openSnapshotFile(filePath);
+    } else {
+        openJsonFile(filePath);
+    }
+}
+
+// Decodes every frame of the log on a worker thread and reports how many frames each message
+// matched. The dispatch table is built here and owns compiled copies of the messages, so the job
+// and the report never read the models, which may be edited or closed in the meantime.
+void MainWindow::decodeCanLog(const QString &filePath)
+{
+    QString error;
+    std::shared_ptr<CanLogReader> reader = CanLogReader::open(filePath, &error);
+    if (!reader) {
+        QMessageBox::warning(this, "Decode CAN Log", "Failed to open " + QFileInfo(filePath).fileName() + ": " + error);
+        return;
     }
+
+    auto dispatch = std::make_shared<J1939Dispatch>();
+    dispatch->build(dbcModels);
+    auto decoder = std::make_shared<CanLogDecoder>(*dispatch);
+
+    runModelJob("Decoding " + QFileInfo(filePath).fileName() + "...",
+                [reader, decoder](const DbcDataModel::ProgressCallback &progress) {
+                    return decoder->run(*reader, progress);
+                },
+                [this, dispatch, decoder](bool ok, bool canceled) {
+                    if (!ok) {
+                        if (!canceled) {
+                            QMessageBox::warning(this, "Decode CAN Log", "Failed to decode CAN log.");
+                        }
+                        return;
+                    }
+
+                    const CanLogDecoder::Summary &summary = decoder->summary();
+
+                    // Messages seen most often first
+                    std::vector<int> targets;
+                    for (int i = 0; i < int(summary.perTarget.size()); ++i) {
+                        if (summary.perTarget[size_t(i)] > 0) {
+                            targets.push_back(i);
+                        }
+                    }
+                    std::sort(targets.begin(), targets.end(), [&summary](int a, int b) {
+                        return summary.perTarget[size_t(a)] > summary.perTarget[size_t(b)];
+                    });
+
+                    QString report = QString("%1 frames, %2 decoded (%3 transport payloads), %4 not matching any message.\n")
+                                         .arg(summary.frames)
+                                         .arg(summary.decoded)
+                                         .arg(summary.transportPayloads)
+                                         .arg(summary.unknown);
+                    const int shown = std::min<int>(int(targets.size()), 20);
+                    for (int i = 0; i < shown; ++i) {
+                        const J1939Dispatch::Target &target = dispatch->target(targets[size_t(i)]);
+                        report += QString("\n%1: %2").arg(target.messageName)
+                                                     .arg(summary.perTarget[size_t(targets[size_t(i)])]);
+                    }
+                    if (int(targets.size()) > shown) {
+                        report += QString("\n... and %1 more messages").arg(int(targets.size()) - shown);
+                    }
+
+                    // Value ranges of every decoded signal, behind "Show Details..."
+                    QString details;
+                    for (int index : targets) {
+                        const J1939Dispatch::Target &target = dispatch->target(index);
+                        const std::vector<CanLogDecoder::SignalStatistics> &statistics = summary.perSignal[size_t(index)];
+                        details += target.messageName + "\n";
+                        for (size_t i = 0; i < statistics.size(); ++i) {
+                            const CanLogDecoder::SignalStatistics &signal = statistics[i];
+                            if (signal.count == 0) {
+                                continue;
+                            }
+                            const QString units = target.signalUnits[int(i)].isEmpty() ? QString()
+                                                                                      : " " + target.signalUnits[int(i)];
+                            details += QString("  %1: %2 to %3%4, last %5 (%6 values)\n")
+                                           .arg(target.signalNames[int(i)])
+                                           .arg(signal.min)
+                                           .arg(signal.max)
+                                           .arg(units)
+                                           .arg(signal.last)
+                                           .arg(signal.count);
+                        }
+                    }
+
+                    QMessageBox box(QMessageBox::Information, "Decode CAN Log", report, QMessageBox::Ok, this);
+                    box.setDetailedText(details);
+                    box.exec();
+                });
 }
 
 void MainWindow::importDBCFile(const QString &filePath)
 {
     if (!filePath.isEmpty()) {
-        // Import the DBC file into the data model
+        importDBCFiles(QStringList() << filePath);
+    }
+}
+
+void MainWindow::importDBCFiles(const QStringList &filePaths)
+{
+    if (filePaths.isEmpty()) {
+        return;
+    }
+
+    // One data model per file, each parsed on its own pool thread
+    QList<DbcDataModel*> newModels;
+    for (const QString &filePath : filePaths) {
         DbcDataModel* newModel = new DbcDataModel();
         newModel->setFileName(QFileInfo(filePath).fileName());
+        newModels.append(newModel);
+    }
 
-        if (newModel->importDBC(filePath)) {
-            dbcModels.append(newModel);
-            updateDbcTree();
+    // Per-file success flags, shared between the job and the completion handler
+    auto succeeded = std::make_shared<std::vector<char>>(filePaths.size(), 0);
 
-            addRecentImport(filePath);
-        } else {
-            QMessageBox::warning(this, "Import Error", "Failed to import DBC file.");
-            delete newModel;
-        }
-    }
+    QString label = filePaths.size() == 1
+        ? "Importing " + newModels.first()->fileName() + "..."
+        : QString("Importing %1 DBC files...").arg(filePaths.size());
+
+    runModelJob(label,
+                [newModels, filePaths, succeeded](const DbcDataModel::ProgressCallback &progress) {
+                    const int count = newModels.size();
+                    std::vector<std::atomic<int>> filePercents(count);
+                    std::atomic<bool> canceled(false);
+
+                    QList<int> indexes;
+                    for (int i = 0; i < count; ++i) {
+                        indexes.append(i);
+                    }
+
+                    // The calling thread joins in, so this scales with the pool size
+                    QtConcurrent::blockingMap(indexes, [&](int index) {
+                        if (canceled) {
+                            return;
+                        }
+                        // Unchanged files come straight from the import cache
+                        DbcImportCache cache(filePaths[index]);
+                        if (cache.load(*newModels[index])) {
+                            filePercents[index] = 100;
+                            (*succeeded)[index] = true;
+                            return;
+                        }
+                        (*succeeded)[index] = newModels[index]->importDBC(filePaths[index], [&, index](int percent) {
+                            filePercents[index] = percent;
+                            int total = 0;
+                            for (const std::atomic<int> &filePercent : filePercents) {
+                                total += filePercent;
+                            }
+                            if (!progress(total / count)) {
+                                canceled = true;
+                            }
+                            return !canceled;
+                        });
+                        if ((*succeeded)[index]) {
+                            cache.store(*newModels[index]);
+                        }
+                    });
+                    return !canceled;
+                },
+                [this, newModels, filePaths, succeeded](bool ok, bool canceled) {
+                    if (!ok || canceled) {
+                        qDeleteAll(newModels);
+                        return;
+                    }
+
+                    QStringList failedFiles;
+                    for (int i = 0; i < newModels.size(); ++i) {
+                        if ((*succeeded)[i]) {
+                            // Only the new model's items are added to the tree
+                            dbcModels.append(newModels[i]);
+                            dbcTree->addModel(newModels[i]);
+                            addRecentImport(filePaths[i]);
+                        } else {
+                            failedFiles.append(filePaths[i]);
+                            delete newModels[i];
+                        }
+                    }
+
+                    if (!failedFiles.isEmpty()) {
+                        QMessageBox::warning(this, "Import Error", "Failed to import DBC file(s):\n" + failedFiles.join("\n"));
+                    }
+                });
 }
 
 
@@ -411,223 +764,205 @@ void MainWindow::updateDbcTree()
     dbcTree->populateTree(dbcModels);
 }
 
-void MainWindow::saveAsJson(const QString& filePath) {
-    QJsonArray busesArray;
-    QJsonArray messagesArray;
-    QJsonArray nodesArray;
+void MainWindow::saveWorkspace(const QString& filePath)
+{
+    if (QFileInfo(filePath).suffix() == DbcSnapshot::Suffix) {
+        saveAsSnapshot(filePath);
+    } else {
+        saveAsJson(filePath, saveCompact);
+    }
+}
+
+void MainWindow::saveAsSnapshot(const QString& filePath)
+{
+    if (DbcSnapshot::save(filePath, dbcModels)) {
+        addRecentSave(filePath);
+        qDebug() << "Data successfully saved to" << filePath;
+    }
+}
+
+// Attribute lists share one layout on networks, nodes, messages and signals
+static void writeAttributes(JsonStreamWriter& json, const char* key, const QList<Attribute>& attributes)
+{
+    json.key(key);
+    json.beginArray();
+    for (const auto& attribute : attributes) {
+        json.beginObject();
+        json.key("name");
+        json.value(attribute.name);
+        json.key("type");
+        json.value(attribute.type);
+        json.key("value");
+        json.value(attribute.value);
+        if (!attribute.range.isEmpty()) {
+            json.key("range");
+            json.value(attribute.range);
+        }
+        json.endObject();
+    }
+    json.endArray();
+}
+
+static void writeTxRxMessages(JsonStreamWriter& json, const char* key, const QList<TxRxMessage>& messages)
+{
+    json.key(key);
+    json.beginArray();
+    for (const auto& message : messages) {
+        json.beginObject();
+        json.key("name");
+        json.value(message.name);
+        json.endObject();
+    }
+    json.endArray();
+}
+
+// Writes the workspace straight to the file while walking the models, keys are kept in the
+// alphabetical order QJsonDocument used so saves stay diffable against older files
+void MainWindow::saveAsJson(const QString& filePath, bool compact) {
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not open file for writing:" << filePath;
+        return;
+    }
 
+    JsonStreamWriter json(&file, compact);
+    json.beginObject();
+
+    json.key("buses");
+    json.beginArray();
     for (const auto& model : dbcModels) {
-        // Convert Networks to JSON
         for (const auto& network : model->networks()) {
-            QJsonObject networkObj;
-            networkObj["name"] = network.name;
-            networkObj["baud"] = network.baud;
-
-            // Save Network Attributes
-            QJsonArray attributesArray;
-            for (const auto& attribute : network.networkAttributes) {
-                QJsonObject attributeObj;
-                attributeObj["name"] = attribute.name;
-                attributeObj["type"] = attribute.type;
-                attributeObj["value"] = attribute.value;
-                attributesArray.append(attributeObj);
-            }
-            networkObj["networkAttributes"] = attributesArray;
-
-            busesArray.append(networkObj);
+            json.beginObject();
+            json.key("baud");
+            json.value(network.baud);
+            json.key("name");
+            json.value(network.name);
+            writeAttributes(json, "networkAttributes", network.networkAttributes);
+            json.endObject();
         }
+    }
+    json.endArray();
 
-        // Convert Messages to JSON
-        for (const auto& message : model->messages()) {
-            QJsonObject messageObj;
-            messageObj["pgn"] = static_cast<qint64>(message.pgn);
-            messageObj["name"] = message.name;
-            messageObj["description"] = message.description;
-            messageObj["priority"] = message.priority;
-            messageObj["length"] = message.length;
-            messageObj["tx_periodicity"] = message.txPeriodicity;
-            messageObj["tx_onChange"] = message.txOnChange;
-
-            // Save Message Attributes
-            QJsonArray messageAttributesArray;
-            for (const auto& attribute : message.messageAttributes) {
-                QJsonObject attributeObj;
-                attributeObj["name"] = attribute.name;
-                attributeObj["type"] = attribute.type;
-                attributeObj["value"] = attribute.value;
-                messageAttributesArray.append(attributeObj);
-            }
-            messageObj["messageAttributes"] = messageAttributesArray;
+    json.key("format_version");
+    json.value(DbcDataModel::JsonFormatVersion);
 
-            QJsonArray signalsArray;
+    json.key("messages");
+    json.beginArray();
+    for (const auto& model : dbcModels) {
+        for (const auto& message : model->messages()) {
+            json.beginObject();
+            json.key("data");
+            json.beginArray();
             for (const auto& signal : message.messageSignals) {
-                QJsonObject signalObj;
-                signalObj["spn"] = signal.spn;
-                signalObj["name"] = signal.name;
-                signalObj["description"] = signal.description;
-                signalObj["start_bit"] = signal.startBit;
-                signalObj["bit_length"] = signal.bitLength;
-                signalObj["is_bigEndian"] = signal.isBigEndian;
-                signalObj["is_twosComplement"] = signal.isTwosComplement;
-                signalObj["factor"] = signal.factor;
-                signalObj["offset"] = signal.offset;
-                signalObj["units"] = signal.units;
-
-                // Save Signal Attributes
-                QJsonArray signalAttributesArray;
-                for (const auto& attribute : signal.signalAttributes) {
-                    QJsonObject attributeObj;
-                    attributeObj["name"] = attribute.name;
-                    attributeObj["type"] = attribute.type;
-                    attributeObj["value"] = attribute.value;
-                    signalAttributesArray.append(attributeObj);
-                }
-                signalObj["signalAttributes"] = signalAttributesArray;
-
-                QJsonArray enumerationsArray;
+                json.beginObject();
+                json.key("bit_length");
+                json.value(signal.bitLength);
+                json.key("description");
+                json.value(signal.description);
+                json.key("enumerations");
+                json.beginArray();
                 for (const auto& enumeration : signal.enumerations) {
-                    QJsonObject enumObj;
-                    enumObj["name"] = enumeration.name;
-                    enumObj["description"] = enumeration.description;
-                    enumObj["value"] = enumeration.value;
-                    enumerationsArray.append(enumObj);
+                    json.beginObject();
+                    json.key("description");
+                    json.value(enumeration.description);
+                    json.key("name");
+                    json.value(enumeration.name);
+                    json.key("value");
+                    json.value(enumeration.value);
+                    json.endObject();
                 }
-                signalObj["enumerations"] = enumerationsArray;
-                signalsArray.append(signalObj);
+                json.endArray();
+                json.key("factor");
+                json.value(signal.factor);
+                json.key("is_bigEndian");
+                json.value(signal.isBigEndian);
+                json.key("is_twosComplement");
+                json.value(signal.isTwosComplement);
+                json.key("name");
+                json.value(signal.name);
+                json.key("offset");
+                json.value(signal.offset);
+                writeAttributes(json, "signalAttributes", signal.signalAttributes);
+                json.key("spn");
+                json.value(signal.spn);
+                json.key("start_bit");
+                json.value(signal.startBit);
+                json.key("units");
+                json.value(signal.units);
+                json.endObject();
             }
-            messageObj["data"] = signalsArray;
-            messagesArray.append(messageObj);
+            json.endArray();
+            json.key("description");
+            json.value(message.description);
+            json.key("length");
+            json.value(message.length);
+            writeAttributes(json, "messageAttributes", message.messageAttributes);
+            json.key("name");
+            json.value(message.name);
+            json.key("pgn");
+            json.value(static_cast<qint64>(message.pgn));
+            json.key("priority");
+            json.value(message.priority);
+            json.key("tx_onChange");
+            json.value(message.txOnChange);
+            json.key("tx_periodicity");
+            json.value(message.txPeriodicity);
+            json.endObject();
         }
+    }
+    json.endArray();
 
-        // Convert Nodes to JSON
+    json.key("nodes");
+    json.beginArray();
+    for (const auto& model : dbcModels) {
         for (const auto& node : model->nodes()) {
-            QJsonObject nodeObj;
-            nodeObj["name"] = node.name;
-
-            // Save Node Attributes
-            QJsonArray nodeAttributesArray;
-            for (const auto& attribute : node.nodeAttributes) {
-                QJsonObject attributeObj;
-                attributeObj["name"] = attribute.name;
-                attributeObj["type"] = attribute.type;
-                attributeObj["value"] = attribute.value;
-                nodeAttributesArray.append(attributeObj);
-            }
-            nodeObj["nodeAttributes"] = nodeAttributesArray;
-
-            QJsonArray busesArray;
+            json.beginObject();
+            json.key("buses");
+            json.beginArray();
             for (const auto& bus : node.networks) {
-                QJsonObject busObj;
-                busObj["name"] = bus.networkName;
-                busObj["source_address"] = bus.sourceAddress;
-
-                QJsonArray txArray;
-                for (const auto& txMessage : bus.tx) {
-                    QJsonObject txObj;
-                    txObj["name"] = txMessage.name;
-                    txArray.append(txObj);
-                }
-                busObj["tx"] = txArray;
-
-                QJsonArray rxArray;
-                for (const auto& rxMessage : bus.rx) {
-                    QJsonObject rxObj;
-                    rxObj["name"] = rxMessage.name;
-                    rxArray.append(rxObj);
-                }
-                busObj["rx"] = rxArray;
-
-                busesArray.append(busObj);
+                json.beginObject();
+                json.key("name");
+                json.value(bus.networkName);
+                writeTxRxMessages(json, "rx", bus.rx);
+                json.key("source_address");
+                json.value(bus.sourceAddress);
+                writeTxRxMessages(json, "tx", bus.tx);
+                json.endObject();
             }
-            nodeObj["buses"] = busesArray;
-            nodesArray.append(nodeObj);
+            json.endArray();
+            json.key("name");
+            json.value(node.name);
+            writeAttributes(json, "nodeAttributes", node.nodeAttributes);
+            json.endObject();
         }
     }
+    json.endArray();
 
-    // Final JSON Document
-    QJsonObject rootObj;
-    rootObj["buses"] = busesArray;
-    rootObj["messages"] = messagesArray;
-    rootObj["nodes"] = nodesArray;
-
-    QJsonDocument doc(rootObj);
+    json.endObject();
 
-    // Write to File
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly)) {
-        qWarning() << "Could not open file for writing:" << filePath;
+    // Nothing replaces the previous file unless every byte made it to disk
+    if (!json.flush() || !file.commit()) {
+        qWarning() << "Could not write file:" << filePath << file.errorString();
         return;
     }
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
     addRecentSave(filePath);
     qDebug() << "Data successfully saved to" << filePath;
 }
 
 
 void MainWindow::filterTreeItems(const QString &filterText) {
-    QTreeWidgetItemIterator it(dbcTree);
-
-    while (*it) {
-        QTreeWidgetItem *item = *it;
-        QString itemType = item->data(0, Qt::UserRole).toString();
-
-        // Always show category bars
-        if (itemType == "Category") {
-            item->setHidden(false);
-            item->setExpanded(true);
-        } else {
-            bool match = item->text(0).contains(filterText, Qt::CaseInsensitive);
-            bool hasMatchingChild = false;
-
-            // Check if any child matches the filter, including nested children
-            for (int i = 0; i < item->childCount(); ++i) {
-                QTreeWidgetItem *child = item->child(i);
-                bool childMatch = child->text(0).contains(filterText, Qt::CaseInsensitive);
-                bool hasMatchingGrandchild = false;
-
-                // Check if any grandchild matches the filter
-                for (int j = 0; j < child->childCount(); ++j) {
-                    QTreeWidgetItem *grandchild = child->child(j);
-                    if (grandchild->text(0).contains(filterText, Qt::CaseInsensitive)) {
-                        grandchild->setHidden(false);
-                        hasMatchingGrandchild = true;
-                    } else {
-                        grandchild->setHidden(true);
-                    }
-                }
-
-                if (childMatch || hasMatchingGrandchild) {
-                    child->setHidden(false);
-                    child->setExpanded(hasMatchingGrandchild); // Expand if it has matching grandchildren
-                    hasMatchingChild = true;
-                } else {
-                    child->setHidden(true);
-                }
-            }
-
-            // If the item itself or any of its children matches, make it visible
-            if (match || hasMatchingChild) {
-                item->setHidden(false);
-                item->setExpanded(hasMatchingChild || match); // Expand if it has matching children or if the item matches
-            } else {
-                item->setHidden(true);
-            }
-        }
-
-        ++it;
-    }
+    dbcTree->filter(filterText);
 }
 
 
 
-void MainWindow::onTreeItemClicked(QTreeWidgetItem* item)
+void MainWindow::onTreeItemClicked(const QModelIndex& item)
 {
-    if (!item) return;
+    if (!item.isValid()) return;
 
-    QString itemType = item->data(0, Qt::UserRole).toString();
-    QString name = item->text(0);
-    QString model = item->data(0, Qt::UserRole + 1).toString();
+    QString itemType = item.data(DbcTreeModel::TypeRole).toString();
+    QString name = item.data().toString();
+    QString model = item.data(DbcTreeModel::ModelNamesRole).toString();
 
     // Clear existing tabs
     clearRightPanel();
@@ -660,7 +995,7 @@ void MainWindow::onTreeItemClicked(QTreeWidgetItem* item)
     }
 }
 
-void MainWindow::handleMessageItem(QTreeWidgetItem* item, const QString& name, const QString& modelName)
+void MainWindow::handleMessageItem(const QModelIndex& item, const QString& name, const QString& modelName)
 {
     DbcDataModel* model = nullptr;
     for (DbcDataModel* m : dbcModels) {
@@ -676,16 +1011,10 @@ void MainWindow::handleMessageItem(QTreeWidgetItem* item, const QString& name, c
     }
 
     // Retrieve the uniqueKey (which is the message's PGN)
-    QString uniqueKey = item->data(0, Qt::UserRole + 2).toString();
+    QString uniqueKey = item.data(DbcTreeModel::UniqueKeyRole).toString();
     // qDebug() << "Unique key for message:" << uniqueKey; // Debug log to see the unique key
 
-    Message* message = nullptr;
-    for (Message& msg : model->messages()) {
-        if (QString::number(msg.pgn) == uniqueKey) {
-            message = &msg;
-            break;
-        }
-    }
+    Message* message = model->findMessageByPgn(uniqueKey.toULongLong());
 
     if (!message) {
         // qWarning() << "Message not found for uniqueKey:" << uniqueKey;
@@ -698,7 +1027,7 @@ void MainWindow::handleMessageItem(QTreeWidgetItem* item, const QString& name, c
 
 
     QString txRxType;
-    QString itemType = item->data(0, Qt::UserRole).toString();
+    QString itemType = item.data(DbcTreeModel::TypeRole).toString();
     if (itemType == "TxMessage" || itemType == "RxMessage") {
         txRxType = (itemType == "TxMessage") ? "Transmitted" : "Received";
     }
@@ -737,27 +1066,17 @@ void MainWindow::handleMessageItem(QTreeWidgetItem* item, const QString& name, c
     connect(signalsList, &QListWidget::itemDoubleClicked, this, [this](QListWidgetItem* item) {
         QString signalName = item->text();
 
-        // Locate the QTreeWidgetItem corresponding to the signal name
-        if (currentTreeItem) {
-            QTreeWidgetItem* signalsCategoryItem = nullptr;
-
-            // Traverse through children of currentMessageItem to find the <Signals> node
-            for (int i = 0; i < currentTreeItem->childCount(); ++i) {
-                if (currentTreeItem->child(i)->text(0) == "<Signals>") {
-                    signalsCategoryItem = currentTreeItem->child(i);
-                    break;
-                }
-            }
-
-            // Now find the signal item within the <Signals> category
-            if (signalsCategoryItem) {
-                for (int i = 0; i < signalsCategoryItem->childCount(); ++i) {
-                    QTreeWidgetItem* signalItem = signalsCategoryItem->child(i);
-                    if (signalItem->text(0) == signalName) {
-                        dbcTree->setCurrentItem(signalItem);
-                        onTreeItemClicked(signalItem);
-                        break;
-                    }
+        // Locate the tree row corresponding to the signal name
+        if (currentTreeItem.isValid()) {
+            DbcTreeModel* treeModel = dbcTree->treeModel();
+
+            // Find the <Signals> node under the current message, then the signal within it
+            QModelIndex signalsCategoryItem = treeModel->childByName(currentTreeItem, "<Signals>");
+            if (signalsCategoryItem.isValid()) {
+                QModelIndex signalItem = treeModel->childByName(signalsCategoryItem, signalName);
+                if (signalItem.isValid()) {
+                    dbcTree->setCurrentIndex(signalItem);
+                    onTreeItemClicked(signalItem);
                 }
             }
         }
@@ -770,7 +1089,7 @@ void MainWindow::handleMessageItem(QTreeWidgetItem* item, const QString& name, c
 
     // Update transmitters table
     transmittersTable->setRowCount(0);
-    for(const std::pair<QString, QString>& pair : message->messageTransmitters) {
+    for(const std::pair<QString, QString>& pair : model->messageTransmitters(*message)) {
         addAttributeRow(transmittersTable, {pair.first, pair.second});
     }
 
@@ -781,7 +1100,7 @@ void MainWindow::handleMessageItem(QTreeWidgetItem* item, const QString& name, c
 
     // Update receivers table
     receiversTable->setRowCount(0);
-    for(const std::pair<QString, QString>& pair : message->messageReceivers) {
+    for(const std::pair<QString, QString>& pair : model->messageReceivers(*message)) {
         addAttributeRow(receiversTable, {pair.first, pair.second});
     }
 
@@ -820,62 +1139,35 @@ void MainWindow::handleMessageItem(QTreeWidgetItem* item, const QString& name, c
     displayBitLayout(*message, message->multiplexValue);
 
     // Connect pgnLineEdit to handle PGN changes
-    connect(pgnLineEdit, &QLineEdit::textChanged, this, [this, item](const QString &text) {
+    connect(pgnLineEdit, &QLineEdit::textChanged, this, [this](const QString &text) {
         if (currentMessage) {
             bool ok;
             quint64 newPgn = text.toULongLong(&ok, 16);
             if (ok && newPgn != currentMessage->pgn) {
-                // Update the PGN in the tree item and ensure all references are updated
-                item->setData(0, Qt::UserRole + 2, QString::number(newPgn));
-
-                // Iterate through all items and update PGN references where applicable
-                QList<QTreeWidgetItem *> items = dbcTree->findItems(QString::number(currentMessage->pgn), Qt::MatchExactly | Qt::MatchRecursive);
-                for (QTreeWidgetItem *currentItem : items) {
-                    if (currentItem->data(0, Qt::UserRole + 2).toString() == QString::number(currentMessage->pgn)) {
-                        currentItem->setData(0, Qt::UserRole + 2, QString::number(newPgn));
+                // Update the PGN through the owning model so its index stays in sync,
+                // the tree reads the new key from the message
+                for (DbcDataModel* owner : dbcModels) {
+                    if (owner->setMessagePgn(*currentMessage, newPgn)) {
+                        dbcTree->treeModel()->messageChanged(owner, currentMessage);
+                        break;
                     }
                 }
-
-                currentMessage->pgn = newPgn;
             }
         }
     });
 
     // Connect nameLineEdit to handle name changes
-    connect(nameLineEdit, &QLineEdit::textChanged, this, [this, item, model](const QString &text) {
+    connect(nameLineEdit, &QLineEdit::textChanged, this, [this, model](const QString &text) {
         if (currentMessage && !text.isEmpty() && text != currentMessage->name) {
-            // Update the name in the tree item
-            item->setText(0, text);
-
-            // Update all tree items that reference the old name
-            QList<QTreeWidgetItem *> items = dbcTree->findItems(currentMessage->name, Qt::MatchExactly | Qt::MatchRecursive);
-            for (QTreeWidgetItem *currentItem : items) {
-                if (currentItem->data(0, Qt::UserRole + 1).toString() == model->fileName() &&
-                    currentItem->text(0) == currentMessage->name) {
-                    currentItem->setText(0, text);
-                }
-            }
-
-
-            // Update all tx and rx references within the same model
-            for (auto& node : model->nodes()) {
-                for (auto& network : node.networks) {
-                    for (auto& txMessage : network.tx) {
-                        if (txMessage.name == currentMessage->name) {
-                            txMessage.name = text;  // Update to new name
-                        }
-                    }
-                    for (auto& rxMessage : network.rx) {
-                        if (rxMessage.name == currentMessage->name) {
-                            rxMessage.name = text;  // Update to new name
-                        }
-                    }
+            // Rename through the owning model so its indexes and tx/rx references stay in sync
+            for (DbcDataModel* owner : dbcModels) {
+                if (owner->setMessageName(*currentMessage, text)) {
+                    break;
                 }
             }
 
-
-
-            currentMessage->name = text;
+            // Refresh the tree items showing the message and its tx/rx entries
+            dbcTree->treeModel()->messageChanged(model, currentMessage);
         }
     });
 
@@ -952,6 +1244,8 @@ void MainWindow::removeMessageAttribute() {
             messageAttributesTable->removeRow(row);
         }
     }
+
+    dbcTree->treeModel()->fieldsChanged();
 }
 
 void MainWindow::onMessageAttributesTableCellChanged(int row, int column) {
@@ -979,11 +1273,13 @@ void MainWindow::onMessageAttributesTableCellChanged(int row, int column) {
         attr.value = value;
         break;
     }
+
+    dbcTree->treeModel()->fieldsChanged();
 }
 
 
 
-void MainWindow::handleSignalItem(QTreeWidgetItem* item, const QString& name, const QString& modelName)
+void MainWindow::handleSignalItem(const QModelIndex& item, const QString& name, const QString& modelName)
 {
     DbcDataModel* model = nullptr;
     for (DbcDataModel* m : dbcModels) {
@@ -999,27 +1295,21 @@ void MainWindow::handleSignalItem(QTreeWidgetItem* item, const QString& name, co
     }
 
     // Retrieve the uniqueKey of the parent message
-    QTreeWidgetItem* signalsCategory = item->parent();
-    if (!signalsCategory || signalsCategory->text(0) != "<Signals>") {
+    QModelIndex signalsCategory = item.parent();
+    if (!signalsCategory.isValid() || signalsCategory.data().toString() != "<Signals>") {
         QMessageBox::warning(this, "Error", "Parent <Signals> category not found.");
         return;
     }
 
-    QTreeWidgetItem* parentItem = signalsCategory->parent();
-    if (!parentItem) {
+    QModelIndex parentItem = signalsCategory.parent();
+    if (!parentItem.isValid()) {
         QMessageBox::warning(this, "Error", "Parent message not found.");
         return;
     }
 
-    QString messageUniqueKey = parentItem->data(0, Qt::UserRole + 2).toString();
+    QString messageUniqueKey = parentItem.data(DbcTreeModel::UniqueKeyRole).toString();
 
-    Message* message = nullptr;
-    for (Message& msg : model->messages()) {
-        if (QString::number(msg.pgn) == messageUniqueKey) {
-            message = &msg;
-            break;
-        }
-    }
+    Message* message = model->findMessageByPgn(messageUniqueKey.toULongLong());
 
     if (!message) {
         QMessageBox::warning(this, "Error", "Parent message not found in the model.");
@@ -1075,24 +1365,17 @@ void MainWindow::handleSignalItem(QTreeWidgetItem* item, const QString& name, co
     connect(spnSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int value) {
         if (currentSignal) {
             currentSignal->spn = value;
+            dbcTree->treeModel()->fieldsChanged();
         }
     });
 
     // Connect signalNameLineEdit to handle name changes
-    connect(signalNameLineEdit, &QLineEdit::textChanged, this, [this, item](const QString &text) {
+    connect(signalNameLineEdit, &QLineEdit::textChanged, this, [this, model](const QString &text) {
         if (currentSignal) {
-            // Update the name in the tree item
-            item->setText(0, text);
-
-            // Update all tree items that reference the old name
-            QList<QTreeWidgetItem *> items = dbcTree->findItems(currentMessage->name, Qt::MatchExactly | Qt::MatchRecursive);
-            for (QTreeWidgetItem *currentItem : items) {
-                if (currentItem->text(0) == currentMessage->name) {
-                    currentItem->setText(0, text);
-                }
-            }
-
             currentSignal->name = text;
+
+            // Refresh the tree items showing this signal
+            dbcTree->treeModel()->signalChanged(model, currentSignal);
         }
     });
 
@@ -1190,6 +1473,8 @@ void MainWindow::removeSignalAttribute() {
             signalAttributesTable->removeRow(row);
         }
     }
+
+    dbcTree->treeModel()->fieldsChanged();
 }
 
 void MainWindow::onSignalAttributesTableCellChanged(int row, int column) {
@@ -1217,11 +1502,13 @@ void MainWindow::onSignalAttributesTableCellChanged(int row, int column) {
         attr.value = value;
         break;
     }
+
+    dbcTree->treeModel()->fieldsChanged();
 }
 
 
 
-void MainWindow::handleNetworkItem(QTreeWidgetItem* item, const QString& name, const QString& modelName)
+void MainWindow::handleNetworkItem(const QModelIndex& item, const QString& name, const QString& modelName)
 {
     DbcDataModel* model = nullptr;
     // Find the corresponding model
@@ -1277,7 +1564,7 @@ void MainWindow::handleNetworkItem(QTreeWidgetItem* item, const QString& name, c
     connect(networkAttributesTable, &QTableWidget::cellChanged, this, &MainWindow::onNetworkAttributesTableCellChanged);
 
     // Connect Network Name to handle name changes
-    connect(networkNameLineEdit, &QLineEdit::textChanged, this, [this, item](const QString &text) {
+    connect(networkNameLineEdit, &QLineEdit::textChanged, this, [this](const QString &text) {
         if (currentNetwork && !text.isEmpty() && text != currentNetwork->name) {
             // Check if the new name is unique in the network list
             bool unique = true;
@@ -1302,27 +1589,13 @@ void MainWindow::handleNetworkItem(QTreeWidgetItem* item, const QString& name, c
             QString oldName = currentNetwork->name;
             currentNetwork->name = text;
 
-            // Update the tree item for the current network node
-            item->setText(0, text);
-
-            // Update all references to the old network name in the tree widget
-            QList<QTreeWidgetItem *> items = dbcTree->findItems(oldName, Qt::MatchExactly | Qt::MatchRecursive);
-            for (QTreeWidgetItem *currentItem : items) {
-                if (currentItem->text(0) == oldName) {
-                    currentItem->setText(0, text);
-                }
-            }
-
             // Update all nodes that reference this network
             for (DbcDataModel* model : dbcModels) {
-                for (Node& node : model->nodes()) {
-                    for (NodeNetworkAssociation& association : node.networks) {
-                        if (association.networkName == oldName) {
-                            association.networkName = text;
-                        }
-                    }
-                }
+                model->renameNetworkReferences(oldName, text);
             }
+
+            // Refresh the tree items showing networks
+            dbcTree->treeModel()->networksChanged();
         }
     });
 
@@ -1377,6 +1650,8 @@ void MainWindow::removeNetworkAttribute() {
             networkAttributesTable->removeRow(row);
         }
     }
+
+    dbcTree->treeModel()->fieldsChanged();
 }
 
 void MainWindow::onNetworkAttributesTableCellChanged(int row, int column) {
@@ -1406,12 +1681,14 @@ void MainWindow::onNetworkAttributesTableCellChanged(int row, int column) {
         attr.value = value;
         break;
     }
+
+    dbcTree->treeModel()->fieldsChanged();
 }
 
 
 
 
-void MainWindow::handleNodeItem(QTreeWidgetItem* item, const QString& name, const QString& modelName)
+void MainWindow::handleNodeItem(const QModelIndex& item, const QString& name, const QString& modelName)
 {
     DbcDataModel* model = nullptr;
     for (DbcDataModel* m : dbcModels) {
@@ -1466,39 +1743,14 @@ void MainWindow::handleNodeItem(QTreeWidgetItem* item, const QString& name, cons
     connect(nodeAttributesTable, &QTableWidget::cellChanged, this, &MainWindow::onNodeAttributesTableCellChanged);
 
     // Connect Node Name to handle name changes
-    connect(nodeNameLineEdit, &QLineEdit::textChanged, this, [this, item](const QString &text) {
+    connect(nodeNameLineEdit, &QLineEdit::textChanged, this, [this, model](const QString &text) {
         if (currentNode) {
             // Update the name in the data model
-            QString oldName = currentNode->name;
             currentNode->name = text;
 
-            // Update the tree item for the current node
-            item->setText(0, text);
-
-            // Update all references to the old node name in the tree widget
-            QList<QTreeWidgetItem *> items = dbcTree->findItems(oldName, Qt::MatchExactly | Qt::MatchRecursive);
-            for (QTreeWidgetItem *currentItem : items) {
-                if (currentItem->text(0) == oldName) {
-                    currentItem->setText(0, text);
-                }
-            }
-
-            // Update the transmitters and receivers tables in messages
-            for (DbcDataModel* model : dbcModels) {
-                for (Message& message : model->messages()) {
-                    for (auto& transmitter : message.messageTransmitters) {
-                        if (transmitter.first == oldName) {
-                            transmitter.first = text;
-                        }
-                    }
-
-                    for (auto& receiver : message.messageReceivers) {
-                        if (receiver.first == oldName) {
-                            receiver.first = text;
-                        }
-                    }
-                }
-            }
+            // Refresh the tree items showing this node, the transmitters and receivers
+            // tables read node names through the endpoint index and need no update
+            dbcTree->treeModel()->nodeChanged(model, currentNode);
         }
     });
 
@@ -1540,6 +1792,8 @@ void MainWindow::removeNodeAttribute() {
             nodeAttributesTable->removeRow(row);
         }
     }
+
+    dbcTree->treeModel()->fieldsChanged();
 }
 
 void MainWindow::onNodeAttributesTableCellChanged(int row, int column) {
@@ -1567,6 +1821,8 @@ void MainWindow::onNodeAttributesTableCellChanged(int row, int column) {
         attr.value = value;
         break;
     }
+
+    dbcTree->treeModel()->fieldsChanged();
 }
 
 
@@ -1581,7 +1837,7 @@ void MainWindow::setupRightPanel()
     currentNode = nullptr;
     currentMessage = nullptr;
     currentSignal = nullptr;
-    currentTreeItem = nullptr;
+    currentTreeItem = QPersistentModelIndex();
 
     //--------Messages--------------------
     // Definition
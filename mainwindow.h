@@ -13,6 +13,8 @@
 #include <QLineEdit>
 #include <QComboBox>
 #include <QPushButton>
+#include <QPersistentModelIndex>
+#include <functional>
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -29,12 +31,12 @@ public:
     ~MainWindow();
 
 private slots:
-    void onTreeItemClicked(QTreeWidgetItem* item);
+    void onTreeItemClicked(const QModelIndex& item);
     // Handle selection of node types to open tabs
-    void handleMessageItem(QTreeWidgetItem* item, const QString& name, const QString& modelName);
-    void handleSignalItem(QTreeWidgetItem* item, const QString& name, const QString& modelName);
-    void handleNetworkItem(QTreeWidgetItem* item, const QString& name, const QString& modelName);
-    void handleNodeItem(QTreeWidgetItem* item, const QString& name, const QString& modelName);
+    void handleMessageItem(const QModelIndex& item, const QString& name, const QString& modelName);
+    void handleSignalItem(const QModelIndex& item, const QString& name, const QString& modelName);
+    void handleNetworkItem(const QModelIndex& item, const QString& name, const QString& modelName);
+    void handleNodeItem(const QModelIndex& item, const QString& name, const QString& modelName);
     void filterTreeItems(const QString &filterText);
     // Handle adding and removing to attribute tables
     void addNetworkAttribute();
@@ -68,12 +70,22 @@ private:
     void updateDbcTree();
 
     // File operations
+    void runModelJob(const QString &label,
+                     std::function<bool(const DbcDataModel::ProgressCallback&)> job,
+                     std::function<void(bool ok, bool canceled)> onFinished);
     void openJsonFile(const QString &filePath);
+    void openSnapshotFile(const QString &filePath);
+    void openWorkspaceFile(const QString &filePath);
     void importDBCFile(const QString &filePath);
-    void saveAsJson(const QString& filePath);
+    void importDBCFiles(const QStringList &filePaths);
+    void saveWorkspace(const QString& filePath);
+    void saveAsJson(const QString& filePath, bool compact = false);
+    void saveAsSnapshot(const QString& filePath);
+    void decodeCanLog(const QString& filePath);
 
     // Current Files
     QString saveFilePath;
+    bool saveCompact = false;     // Write saves without indentation
 
     // Recent Files
     QMenu *recentSavesMenu;
@@ -185,6 +197,6 @@ private:
     Node *currentNode;
     Message *currentMessage;
     Signal *currentSignal;
-    QTreeWidgetItem* currentTreeItem;
+    QPersistentModelIndex currentTreeItem;
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,150 @@
+#include <benchmark/benchmark.h>
+#include <QDir>
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "canlog.h"
+#include "dbcdata.h"
+#include "j1939.h"
+#include "samples.h"
+
+namespace {
+
+const char* const FormatNames[] = {"candump", "ASC", "TRC"};
+const char* const FormatSuffixes[] = {"log", "asc", "trc"};
+
+// Frames written per log, enough for the ASC and TRC logs to span more than one mapped window
+constexpr int FrameCount = 1000000;
+
+// The J1939 sample, whose messages the generated logs carry
+DbcDataModel* sampleModel()
+{
+    static DbcDataModel model;
+    static bool loaded = model.importDBC(j1939SamplePath());
+    return loaded ? &model : nullptr;
+}
+
+// A log of one text format with random payloads on the identifiers of the sample's messages,
+// so every frame decodes. Written once per run, in the layout the logging tools produce.
+const QString& logPath(int format)
+{
+    static QTemporaryFile files[3];
+    static QString paths[3];
+    QString& path = paths[format];
+    if (!path.isEmpty() || !sampleModel()) {
+        return path;
+    }
+
+    std::vector<quint32> ids;
+    for (const Message& message : sampleModel()->messages()) {
+        if (J1939Id::isCanId(message.pgn)) {
+            ids.push_back(quint32(message.pgn) & 0x1FFFFFFF);
+        }
+    }
+    QTemporaryFile& file = files[format];
+    file.setFileTemplate(QDir::tempPath() + "/canlog-XXXXXX." + FormatSuffixes[format]);
+    if (ids.empty() || !file.open()) {
+        return path;
+    }
+
+    if (format == 1) {
+        file.write("date Mon Jan 1 00:00:00.000 am 2024\nbase hex  timestamps absolute\nBegin Triggerblock\n");
+    } else if (format == 2) {
+        file.write(";$FILEVERSION=2.1\n;$COLUMNS=N,O,T,B,I,d,R,L,D\n");
+    }
+    std::mt19937 random(3);
+    QByteArray text;
+    char line[160];
+    for (int i = 0; i < FrameCount; ++i) {
+        const quint32 id = ids[random() % ids.size()];
+        uchar data[8];
+        for (uchar& byte : data) {
+            byte = uchar(random());
+        }
+        const long long micros = 1000LL * i + random() % 1000;
+        int length = 0;
+        if (format == 0) {
+            length = std::snprintf(line, sizeof(line), "(%010lld.%06lld) can0 %08X#%02X%02X%02X%02X%02X%02X%02X%02X\n",
+                                   1600000000LL + micros / 1000000, micros % 1000000, id, data[0], data[1],
+                                   data[2], data[3], data[4], data[5], data[6], data[7]);
+        } else if (format == 1) {
+            length = std::snprintf(line, sizeof(line),
+                                   "%6lld.%06lld 1  %Xx       Rx   d 8 %02X %02X %02X %02X %02X %02X %02X %02X"
+                                   "  Length = 0 BitCount = 0\n",
+                                   micros / 1000000, micros % 1000000, id, data[0], data[1], data[2], data[3],
+                                   data[4], data[5], data[6], data[7]);
+        } else {
+            length = std::snprintf(line, sizeof(line),
+                                   "%7d %13lld.%03lld DT 1 %08X Rx - 8    %02X %02X %02X %02X %02X %02X %02X %02X\n",
+                                   i + 1, micros / 1000, micros % 1000, id, data[0], data[1], data[2], data[3],
+                                   data[4], data[5], data[6], data[7]);
+        }
+        text.append(line, length);
+        if (text.size() >= (1 << 20) || i == FrameCount - 1) {
+            if (file.write(text) != text.size()) {
+                return path;
+            }
+            text.clear();
+        }
+    }
+    file.flush();
+    path = file.fileName();
+    return path;
+}
+
+// Parsing alone, from the mapped file to frames
+void BM_ReadCanLog(benchmark::State& state)
+{
+    const int format = int(state.range(0));
+    const QString& filePath = logPath(format);
+    if (filePath.isEmpty()) {
+        state.SkipWithError("Failed to write the log");
+        return;
+    }
+    state.SetLabel(FormatNames[format]);
+    for (auto _ : state) {
+        std::unique_ptr<CanLogReader> reader = CanLogReader::open(filePath);
+        if (!reader) {
+            state.SkipWithError("Failed to open the log");
+            break;
+        }
+        CanFrame frame;
+        qint64 frames = 0;
+        while (reader->next(frame)) {
+            ++frames;
+        }
+        benchmark::DoNotOptimize(frames);
+    }
+    state.SetBytesProcessed(state.iterations() * QFileInfo(filePath).size());
+}
+BENCHMARK(BM_ReadCanLog)->DenseRange(0, 2)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Parsing and decoding every frame into physical values
+void BM_DecodeCanLog(benchmark::State& state)
+{
+    const int format = int(state.range(0));
+    const QString& filePath = logPath(format);
+    if (filePath.isEmpty()) {
+        state.SkipWithError("Failed to write the log");
+        return;
+    }
+    state.SetLabel(FormatNames[format]);
+    J1939Dispatch dispatch;
+    dispatch.build(QList<DbcDataModel*>() << sampleModel());
+    for (auto _ : state) {
+        std::unique_ptr<CanLogReader> reader = CanLogReader::open(filePath);
+        if (!reader) {
+            state.SkipWithError("Failed to open the log");
+            break;
+        }
+        CanLogDecoder decoder(dispatch);
+        decoder.run(*reader);
+        benchmark::DoNotOptimize(decoder.summary().decoded);
+    }
+    state.SetBytesProcessed(state.iterations() * QFileInfo(filePath).size());
+}
+BENCHMARK(BM_DecodeCanLog)->DenseRange(0, 2)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}
@@ -0,0 +1,310 @@
+#include <gtest/gtest.h>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QThreadPool>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "canlog.h"
+#include "dbcdata.h"
+#include "j1939.h"
+
+namespace {
+
+// Writes text to a file of the directory and returns its path, empty on failure
+QString writeFile(const QTemporaryDir& directory, const char* name, const QByteArray& text)
+{
+    const QString path = directory.filePath(QString::fromUtf8(name));
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(text) != text.size()) {
+        return QString();
+    }
+    return path;
+}
+
+// Every frame of a log, empty if it cannot be opened
+std::vector<CanFrame> readFrames(const QString& path)
+{
+    std::vector<CanFrame> frames;
+    std::unique_ptr<CanLogReader> reader = CanLogReader::open(path);
+    if (reader) {
+        CanFrame frame;
+        while (reader->next(frame)) {
+            frames.push_back(frame);
+        }
+    }
+    return frames;
+}
+
+std::vector<uchar> payload(const CanFrame& frame)
+{
+    return std::vector<uchar>(frame.data, frame.data + frame.size);
+}
+
+std::vector<uchar> counting(int size)
+{
+    std::vector<uchar> data;
+    for (int i = 0; i < size; ++i) {
+        data.push_back(uchar(i));
+    }
+    return data;
+}
+
+TEST(CanLogReader, Candump)
+{
+    QTemporaryDir directory;
+    ASSERT_TRUE(directory.isValid());
+    const QString path = writeFile(directory, "candump.log",
+                                   "(1436509052.249713) can0 18FEF100#0102030405060708\n"
+                                   "(1436509052.250000) can1 123#R\n"
+                                   "\n"
+                                   "(1436509052.250001) vcan12 18FEF101##1000102030405060708090A0B\r\n"
+                                   "not a frame\n"
+                                   "(1436509052.250002) can0 20000080#0000000000000000\n"
+                                   "(1436509052.250003) can0 7FF#\n");
+    const std::vector<CanFrame> frames = readFrames(path);
+    ASSERT_EQ(frames.size(), 5u);
+
+    EXPECT_EQ(frames[0].timestamp, 1436509052249713);
+    EXPECT_EQ(frames[0].id, 0x18FEF100u);
+    EXPECT_EQ(frames[0].flags, CanFrame::Extended);
+    EXPECT_EQ(frames[0].channel, 0);
+    EXPECT_EQ(payload(frames[0]), (std::vector<uchar>{1, 2, 3, 4, 5, 6, 7, 8}));
+
+    EXPECT_EQ(frames[1].timestamp, 1436509052250000);
+    EXPECT_EQ(frames[1].id, 0x123u);
+    EXPECT_EQ(frames[1].flags, CanFrame::Remote);
+    EXPECT_EQ(frames[1].channel, 1);
+    EXPECT_EQ(frames[1].size, 0);
+
+    EXPECT_EQ(frames[2].flags, CanFrame::Extended | CanFrame::FlexibleDataRate);
+    EXPECT_EQ(frames[2].channel, 12);
+    EXPECT_EQ(payload(frames[2]), counting(12));
+
+    EXPECT_EQ(frames[3].id, 0x80u);
+    EXPECT_EQ(frames[3].flags, CanFrame::Extended | CanFrame::Error);
+
+    EXPECT_EQ(frames[4].id, 0x7FFu);
+    EXPECT_EQ(frames[4].flags, 0);
+    EXPECT_EQ(frames[4].size, 0);
+}
+
+TEST(CanLogReader, AscHex)
+{
+    QTemporaryDir directory;
+    ASSERT_TRUE(directory.isValid());
+    const QString path = writeFile(directory, "hex.asc",
+                                   "date Mon Jan 1 00:00:00.000 am 2024\n"
+                                   "base hex  timestamps absolute\n"
+                                   "internal events logged\n"
+                                   "Begin Triggerblock Mon Jan 1 00:00:00.000 am 2024\n"
+                                   "   0.000000 Start of measurement\n"
+                                   "   0.015991 1  18FEF100x       Rx   d 8 01 02 03 04 05 06 07 08  Length = 0 BitCount = 0\n"
+                                   "   0.016122 2  123             Tx   r\n"
+                                   "   0.016200 1  ErrorFrame\n"
+                                   "   0.016345 CANFD   3 Rx   18FEF101x  EngineData   1 0 9 12 "
+                                   "00 01 02 03 04 05 06 07 08 09 0A 0B\n"
+                                   "   0.016400 CANFD   1 Rx   7F0  1 0 2 2 AA BB\n"
+                                   "  12.500000 1  7FF             Rx   d 2 AA BB\n"
+                                   "End TriggerBlock\n");
+    const std::vector<CanFrame> frames = readFrames(path);
+    ASSERT_EQ(frames.size(), 5u);
+
+    EXPECT_EQ(frames[0].timestamp, 15991);
+    EXPECT_EQ(frames[0].id, 0x18FEF100u);
+    EXPECT_EQ(frames[0].flags, CanFrame::Extended);
+    EXPECT_EQ(frames[0].channel, 1);
+    EXPECT_EQ(payload(frames[0]), (std::vector<uchar>{1, 2, 3, 4, 5, 6, 7, 8}));
+
+    EXPECT_EQ(frames[1].id, 0x123u);
+    EXPECT_EQ(frames[1].flags, CanFrame::Remote);
+    EXPECT_EQ(frames[1].channel, 2);
+
+    EXPECT_EQ(frames[2].timestamp, 16345);
+    EXPECT_EQ(frames[2].id, 0x18FEF101u);
+    EXPECT_EQ(frames[2].flags, CanFrame::Extended | CanFrame::FlexibleDataRate);
+    EXPECT_EQ(frames[2].channel, 3);
+    EXPECT_EQ(payload(frames[2]), counting(12));
+
+    EXPECT_EQ(frames[3].id, 0x7F0u);
+    EXPECT_EQ(frames[3].flags, CanFrame::FlexibleDataRate);
+    EXPECT_EQ(payload(frames[3]), (std::vector<uchar>{0xAA, 0xBB}));
+
+    EXPECT_EQ(frames[4].timestamp, 12500000);
+    EXPECT_EQ(frames[4].id, 0x7FFu);
+    EXPECT_EQ(frames[4].flags, 0);
+}
+
+TEST(CanLogReader, AscDecimal)
+{
+    QTemporaryDir directory;
+    ASSERT_TRUE(directory.isValid());
+    const QString path = writeFile(directory, "dec.asc",
+                                   "base dec  timestamps absolute\n"
+                                   "   0.100000 1  419361024x      Rx   d 1 FF\n"
+                                   "   0.200000 1  291             Rx   d 1 01\n");
+    const std::vector<CanFrame> frames = readFrames(path);
+    ASSERT_EQ(frames.size(), 2u);
+    EXPECT_EQ(frames[0].id, 0x18FEF100u);
+    EXPECT_EQ(frames[0].flags, CanFrame::Extended);
+    EXPECT_EQ(frames[1].id, 0x123u);
+    EXPECT_EQ(frames[1].flags, 0);
+}
+
+// Version 2 files name their columns, L is a DLC
+TEST(CanLogReader, TrcColumns)
+{
+    QTemporaryDir directory;
+    ASSERT_TRUE(directory.isValid());
+    const QString path = writeFile(directory, "v21.trc",
+                                   ";$FILEVERSION=2.1\n"
+                                   ";$STARTTIME=43101.5\n"
+                                   ";$COLUMNS=N,O,T,B,I,d,R,L,D\n"
+                                   ";\n"
+                                   "      1      1059.900 DT 1 18FEF100 Rx - 8    01 02 03 04 05 06 07 08\n"
+                                   "      2      1060.123 RR 2 0123 Rx - 4\n"
+                                   "      3      1061.000 FD 1 18FEF101 Rx - 9    00 01 02 03 04 05 06 07 08 09 0A 0B\n"
+                                   "      4      1062.000 ST 1 Rx 00000000\n"
+                                   "      5      1063.000 DT 1 07FF Tx - 2    AA BB\n");
+    const std::vector<CanFrame> frames = readFrames(path);
+    ASSERT_EQ(frames.size(), 4u);
+
+    EXPECT_EQ(frames[0].timestamp, 1059900);
+    EXPECT_EQ(frames[0].id, 0x18FEF100u);
+    EXPECT_EQ(frames[0].flags, CanFrame::Extended);
+    EXPECT_EQ(frames[0].channel, 1);
+    EXPECT_EQ(payload(frames[0]), (std::vector<uchar>{1, 2, 3, 4, 5, 6, 7, 8}));
+
+    EXPECT_EQ(frames[1].timestamp, 1060123);
+    EXPECT_EQ(frames[1].id, 0x123u);
+    EXPECT_EQ(frames[1].flags, CanFrame::Remote);
+    EXPECT_EQ(frames[1].channel, 2);
+    EXPECT_EQ(frames[1].size, 0);
+
+    EXPECT_EQ(frames[2].flags, CanFrame::Extended | CanFrame::FlexibleDataRate);
+    EXPECT_EQ(payload(frames[2]), counting(12));
+
+    EXPECT_EQ(frames[3].id, 0x7FFu);
+    EXPECT_EQ(frames[3].flags, 0);
+    EXPECT_EQ(payload(frames[3]), (std::vector<uchar>{0xAA, 0xBB}));
+}
+
+// Version 1.1 has a fixed layout with a data length, and logs bus warnings as lines
+TEST(CanLogReader, TrcVersion1)
+{
+    QTemporaryDir directory;
+    ASSERT_TRUE(directory.isValid());
+    const QString path = writeFile(directory, "v11.trc",
+                                   ";$FILEVERSION=1.1\n"
+                                   ";   Start time: 1/1/2024 00:00:00.000.0\n"
+                                   ";   Message Number\n"
+                                   "     1)      1059.9  Rx     18FEF100  8  01 02 03 04 05 06 07 08\n"
+                                   "     2)      1060.1  Warng  FFFFFFFF  4  00 00 00 08  BUSHEAVY\n"
+                                   "     3)      1061.0  Tx         0123  2  AA BB\n");
+    const std::vector<CanFrame> frames = readFrames(path);
+    ASSERT_EQ(frames.size(), 2u);
+    EXPECT_EQ(frames[0].timestamp, 1059900);
+    EXPECT_EQ(frames[0].id, 0x18FEF100u);
+    EXPECT_EQ(frames[0].flags, CanFrame::Extended);
+    EXPECT_EQ(payload(frames[0]), (std::vector<uchar>{1, 2, 3, 4, 5, 6, 7, 8}));
+    EXPECT_EQ(frames[1].timestamp, 1061000);
+    EXPECT_EQ(frames[1].id, 0x123u);
+    EXPECT_EQ(payload(frames[1]), (std::vector<uchar>{0xAA, 0xBB}));
+}
+
+// Logs much larger than a part are parsed on several threads; frames come back once each and
+// in file order, whatever the format
+TEST(CanLogReader, ParallelParts)
+{
+    QTemporaryDir directory;
+    ASSERT_TRUE(directory.isValid());
+    const int threads = QThreadPool::globalInstance()->maxThreadCount();
+    QThreadPool::globalInstance()->setMaxThreadCount(4);
+
+    constexpr int FrameCount = 100000;
+    const char* const names[] = {"parts.log", "parts.asc", "parts.trc"};
+    for (int format = 0; format < 3; ++format) {
+        SCOPED_TRACE(names[format]);
+        QByteArray text = format == 1 ? "base hex  timestamps absolute\nBegin Triggerblock\n"
+                                      : format == 2 ? ";$FILEVERSION=2.1\n;$COLUMNS=N,O,T,B,I,d,R,L,D\n" : "";
+        char line[128];
+        for (int i = 0; i < FrameCount; ++i) {
+            const uchar b0 = uchar(i >> 16), b1 = uchar(i >> 8), b2 = uchar(i);
+            int length = 0;
+            if (format == 0) {
+                length = std::snprintf(line, sizeof(line), "(%d.%06d) can0 18FEF100#%02X%02X%02X\n",
+                                       i / 1000, i % 1000 * 1000, b0, b1, b2);
+            } else if (format == 1) {
+                length = std::snprintf(line, sizeof(line), "%6d.%06d 1  18FEF100x  Rx   d 3 %02X %02X %02X\n",
+                                       i / 1000, i % 1000 * 1000, b0, b1, b2);
+            } else {
+                length = std::snprintf(line, sizeof(line), "%7d %13d.000 DT 1 18FEF100 Rx - 3    %02X %02X %02X\n",
+                                       i + 1, i, b0, b1, b2);
+            }
+            text.append(line, length);
+        }
+        const QString path = writeFile(directory, names[format], text);
+        ASSERT_FALSE(path.isEmpty());
+
+        const std::vector<CanFrame> frames = readFrames(path);
+        ASSERT_EQ(frames.size(), size_t(FrameCount));
+        for (int i = 0; i < FrameCount; ++i) {
+            const CanFrame& frame = frames[size_t(i)];
+            const int index = frame.data[0] << 16 | frame.data[1] << 8 | frame.data[2];
+            if (index != i || frame.timestamp != qint64(i) * 1000) {
+                ADD_FAILURE() << "frame " << i << " holds frame " << index;
+                break;
+            }
+        }
+    }
+    QThreadPool::globalInstance()->setMaxThreadCount(threads);
+}
+
+// A multiplexer stored as (raw * 2 + 1) selects by its raw value, as DBC m<value> indicators give it
+TEST(CanLogDecoder, ScaledMultiplexer)
+{
+    QTemporaryDir directory;
+    ASSERT_TRUE(directory.isValid());
+    const QString dbcPath = writeFile(directory, "mux.dbc",
+                                      "VERSION \"\"\n\n"
+                                      "BU_: ECU\n\n"
+                                      "BO_ 291 Mux: 3 ECU\n"
+                                      " SG_ Selector M : 0|8@1+ (2,1) [1|511] \"\" Vector__XXX\n"
+                                      " SG_ First m0 : 8|8@1+ (1,0) [0|255] \"\" Vector__XXX\n"
+                                      " SG_ Second m1 : 8|8@1+ (1,0) [0|255] \"\" Vector__XXX\n"
+                                      " SG_ Always : 16|8@1+ (1,0) [0|255] \"\" Vector__XXX\n");
+    ASSERT_FALSE(dbcPath.isEmpty());
+    const QString logPath = writeFile(directory, "mux.log",
+                                      "(1.000000) can0 123#000507\n"
+                                      "(2.000000) can0 123#010908\n"
+                                      "(3.000000) can0 123#000301\n");
+    ASSERT_FALSE(logPath.isEmpty());
+
+    DbcDataModel model;
+    ASSERT_TRUE(model.importDBC(dbcPath));
+    J1939Dispatch dispatch;
+    dispatch.build(QList<DbcDataModel*>() << &model);
+    ASSERT_EQ(dispatch.size(), 1);
+
+    std::unique_ptr<CanLogReader> reader = CanLogReader::open(logPath);
+    ASSERT_TRUE(reader);
+    CanLogDecoder decoder(dispatch);
+    ASSERT_TRUE(decoder.run(*reader));
+    EXPECT_EQ(decoder.summary().decoded, 3);
+
+    const std::vector<CanLogDecoder::SignalStatistics>& statistics = decoder.summary().perSignal[0];
+    ASSERT_EQ(statistics.size(), 4u);
+    EXPECT_EQ(statistics[0].count, 3);
+    EXPECT_EQ(statistics[0].min, 1.0);
+    EXPECT_EQ(statistics[0].max, 3.0);
+    EXPECT_EQ(statistics[1].count, 2);
+    EXPECT_EQ(statistics[1].min, 3.0);
+    EXPECT_EQ(statistics[1].max, 5.0);
+    EXPECT_EQ(statistics[1].last, 3.0);
+    EXPECT_EQ(statistics[2].count, 1);
+    EXPECT_EQ(statistics[2].last, 9.0);
+    EXPECT_EQ(statistics[3].count, 3);
+    EXPECT_EQ(statistics[3].last, 1.0);
+}
+
+}
@@ -0,0 +1,330 @@
+#include <gtest/gtest.h>
+#include <QFile>
+#include <QHash>
+#include <QTemporaryDir>
+#include <ostream>
+#include "dbcdata.h"
+#include "dbcdecode.h"
+#include "dbcsnapshot.h"
+#include "j1939.h"
+#include "samples.h"
+
+// Readable failure output for QString comparisons
+void PrintTo(const QString& text, std::ostream* out)
+{
+    *out << '"' << text.toStdString() << '"';
+}
+
+namespace {
+
+QHash<QString, QString> attributeValues(const QList<Attribute>& attributes)
+{
+    QHash<QString, QString> values;
+    for (const Attribute& attribute : attributes) {
+        values.insert(attribute.name, attribute.value);
+    }
+    return values;
+}
+
+QHash<QString, QString> attributeRanges(const QList<Attribute>& attributes)
+{
+    QHash<QString, QString> ranges;
+    for (const Attribute& attribute : attributes) {
+        ranges.insert(attribute.name, attribute.range);
+    }
+    return ranges;
+}
+
+// Everything exportDBC writes out must come back from importDBC unchanged
+void expectSameModel(DbcDataModel& expected, DbcDataModel& actual)
+{
+    ASSERT_EQ(expected.nodes().size(), actual.nodes().size());
+    for (int i = 0; i < expected.nodes().size(); ++i) {
+        const Node& node = expected.nodes()[i];
+        EXPECT_EQ(node.name, actual.nodes()[i].name);
+        EXPECT_EQ(attributeValues(node.nodeAttributes), attributeValues(actual.nodes()[i].nodeAttributes))
+            << node.name.toStdString();
+        EXPECT_EQ(attributeRanges(node.nodeAttributes), attributeRanges(actual.nodes()[i].nodeAttributes))
+            << node.name.toStdString();
+    }
+    if (!expected.networks().isEmpty()) {
+        ASSERT_FALSE(actual.networks().isEmpty());
+        EXPECT_EQ(attributeValues(expected.networks().first().networkAttributes),
+                  attributeValues(actual.networks().first().networkAttributes));
+        EXPECT_EQ(attributeRanges(expected.networks().first().networkAttributes),
+                  attributeRanges(actual.networks().first().networkAttributes));
+    }
+
+    ASSERT_EQ(expected.messages().size(), actual.messages().size());
+    for (int i = 0; i < expected.messages().size(); ++i) {
+        const Message& message = expected.messages()[i];
+        const Message& roundTripped = actual.messages()[i];
+        SCOPED_TRACE(message.name.toStdString());
+        EXPECT_EQ(message.pgn, roundTripped.pgn);
+        EXPECT_EQ(message.name, roundTripped.name);
+        EXPECT_EQ(message.length, roundTripped.length);
+        EXPECT_EQ(message.description, roundTripped.description);
+        EXPECT_EQ(attributeValues(message.messageAttributes), attributeValues(roundTripped.messageAttributes));
+        EXPECT_EQ(attributeRanges(message.messageAttributes), attributeRanges(roundTripped.messageAttributes));
+
+        ASSERT_EQ(message.messageSignals.size(), roundTripped.messageSignals.size());
+        for (int j = 0; j < message.messageSignals.size(); ++j) {
+            const Signal& signal = message.messageSignals[j];
+            const Signal& other = roundTripped.messageSignals[j];
+            SCOPED_TRACE(signal.name.toStdString());
+            EXPECT_EQ(signal.name, other.name);
+            EXPECT_EQ(signal.spn, other.spn);
+            EXPECT_EQ(signal.startBit, other.startBit);
+            EXPECT_EQ(signal.bitLength, other.bitLength);
+            EXPECT_EQ(signal.isBigEndian, other.isBigEndian);
+            EXPECT_EQ(signal.isTwosComplement, other.isTwosComplement);
+            EXPECT_EQ(signal.isMultiplexer, other.isMultiplexer);
+            EXPECT_EQ(signal.multiplexValue, other.multiplexValue);
+            EXPECT_EQ(signal.factor, other.factor);
+            EXPECT_EQ(signal.offset, other.offset);
+            EXPECT_EQ(signal.scaledMin.toDouble(), other.scaledMin.toDouble());
+            EXPECT_EQ(signal.scaledMax.toDouble(), other.scaledMax.toDouble());
+            EXPECT_EQ(signal.units, other.units);
+            EXPECT_EQ(signal.description, other.description);
+            EXPECT_EQ(attributeValues(signal.signalAttributes), attributeValues(other.signalAttributes));
+            EXPECT_EQ(attributeRanges(signal.signalAttributes), attributeRanges(other.signalAttributes));
+
+            ASSERT_EQ(signal.enumerations.size(), other.enumerations.size());
+            for (int k = 0; k < signal.enumerations.size(); ++k) {
+                EXPECT_EQ(signal.enumerations[k].value, other.enumerations[k].value);
+                EXPECT_EQ(signal.enumerations[k].name, other.enumerations[k].name);
+            }
+        }
+    }
+}
+
+void expectRoundTrip(const QString& dbcPath)
+{
+    DbcDataModel imported;
+    ASSERT_TRUE(imported.importDBC(dbcPath));
+    ASSERT_FALSE(imported.messages().isEmpty());
+
+    QTemporaryDir directory;
+    ASSERT_TRUE(directory.isValid());
+    const QString exportPath = directory.filePath("exported.dbc");
+    ASSERT_TRUE(imported.exportDBC(exportPath));
+
+    DbcDataModel reimported;
+    ASSERT_TRUE(reimported.importDBC(exportPath));
+    expectSameModel(imported, reimported);
+}
+
+TEST(DbcRoundTrip, J1939Sample)
+{
+    expectRoundTrip(j1939SamplePath());
+}
+
+TEST(DbcRoundTrip, CssElectronicsSample)
+{
+    expectRoundTrip(samplePath("J1939 DBC/CSS-Electronics-SAE-J1939-DEMO.dbc"));
+}
+
+// Quotes inside units, comments, value labels and string attributes survive export
+TEST(DbcRoundTrip, EmbeddedQuotes)
+{
+    QTemporaryDir directory;
+    ASSERT_TRUE(directory.isValid());
+    const QString dbcPath = directory.filePath("quotes.dbc");
+    QFile file(dbcPath);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("VERSION \"\"\n\n"
+               "BU_: ECU\n\n"
+               "BO_ 2364540158 EEC1: 8 ECU\n"
+               " SG_ EngineSpeed : 24|16@1+ (0.125,0) [0|8031.875] \"1/\\\"min\\\"\" Vector__XXX\n\n"
+               "CM_ SG_ 2364540158 EngineSpeed \"Actual \\\"engine\\\" speed\";\n"
+               "BA_DEF_ BO_ \"Label\" STRING ;\n"
+               "BA_DEF_DEF_ \"Label\" \"plain\";\n"
+               "BA_ \"Label\" BO_ 2364540158 \"say \\\"hi\\\"\";\n"
+               "VAL_ 2364540158 EngineSpeed 0 \"\\\"off\\\"\" 1 \"on\" ;\n");
+    file.close();
+
+    DbcDataModel imported;
+    ASSERT_TRUE(imported.importDBC(dbcPath));
+    ASSERT_EQ(imported.messages().size(), 1);
+    const Message& message = imported.messages().first();
+    ASSERT_EQ(message.messageSignals.size(), 1);
+    EXPECT_EQ(message.messageSignals.first().units, QString("1/\"min\""));
+    EXPECT_EQ(message.messageSignals.first().description, QString("Actual \"engine\" speed"));
+    EXPECT_EQ(attributeValues(message.messageAttributes).value("Label"), QString("say \"hi\""));
+    ASSERT_EQ(message.messageSignals.first().enumerations.size(), 2);
+    EXPECT_EQ(message.messageSignals.first().enumerations.first().name, QString("\"off\""));
+
+    const QString exportPath = directory.filePath("exported.dbc");
+    ASSERT_TRUE(imported.exportDBC(exportPath));
+    DbcDataModel reimported;
+    ASSERT_TRUE(reimported.importDBC(exportPath));
+    expectSameModel(imported, reimported);
+}
+
+// @0 is Motorola and @1 Intel, on import, through the decoder and back out of exportDBC
+TEST(DbcRoundTrip, ByteOrder)
+{
+    QTemporaryDir directory;
+    ASSERT_TRUE(directory.isValid());
+    const QString dbcPath = directory.filePath("byteorder.dbc");
+    QFile file(dbcPath);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("VERSION \"\"\n\n"
+               "BU_: ECU\n\n"
+               "BO_ 2364540158 Orders: 8 ECU\n"
+               " SG_ Intel : 0|16@1+ (1,0) [0|65535] \"\" Vector__XXX\n"
+               " SG_ Motorola : 23|16@0+ (1,0) [0|65535] \"\" Vector__XXX\n");
+    file.close();
+
+    DbcDataModel imported;
+    ASSERT_TRUE(imported.importDBC(dbcPath));
+    ASSERT_EQ(imported.messages().size(), 1);
+    const Message& message = imported.messages().first();
+    ASSERT_EQ(message.messageSignals.size(), 2);
+    EXPECT_FALSE(message.messageSignals[0].isBigEndian);
+    EXPECT_TRUE(message.messageSignals[1].isBigEndian);
+
+    const uchar payload[8] = {0x34, 0x12, 0x12, 0x34, 0, 0, 0, 0};
+    double values[2] = {};
+    MessageDecoder(message).decode(payload, 8, values);
+    EXPECT_EQ(values[0], 0x1234);
+    EXPECT_EQ(values[1], 0x1234);
+
+    const QString exportPath = directory.filePath("exported.dbc");
+    ASSERT_TRUE(imported.exportDBC(exportPath));
+    QFile exported(exportPath);
+    ASSERT_TRUE(exported.open(QIODevice::ReadOnly));
+    const QByteArray text = exported.readAll();
+    EXPECT_TRUE(text.contains("Intel : 0|16@1+"));
+    EXPECT_TRUE(text.contains("Motorola : 23|16@0+"));
+}
+
+// Workspaces from a newer format are refused rather than read with a different meaning
+TEST(DbcRoundTrip, JsonFormatVersion)
+{
+    QTemporaryDir directory;
+    ASSERT_TRUE(directory.isValid());
+    const QString jsonPath = directory.filePath("newer.json");
+    QFile file(jsonPath);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray("{\"format_version\": ") + QByteArray::number(DbcDataModel::JsonFormatVersion + 1)
+               + ", \"messages\": []}");
+    file.close();
+
+    DbcDataModel model;
+    EXPECT_FALSE(model.loadJson(jsonPath));
+    EXPECT_TRUE(model.loadJson(samplePath("JSON/1Bus.json")));
+}
+
+// BA_DEF_ ranges and ENUM labels are kept on import and written back as they were
+TEST(DbcRoundTrip, AttributeRanges)
+{
+    QTemporaryDir directory;
+    ASSERT_TRUE(directory.isValid());
+    const QString dbcPath = directory.filePath("ranges.dbc");
+    QFile file(dbcPath);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("VERSION \"\"\n\n"
+               "BU_: ECU\n\n"
+               "BO_ 2364540158 EEC1: 8 ECU\n"
+               " SG_ EngineSpeed : 24|16@1+ (0.125,0) [0|8031.875] \"rpm\" Vector__XXX\n\n"
+               "BA_DEF_ \"BusType\" STRING ;\n"
+               "BA_DEF_ BU_ \"NmStationAddress\" HEX 0 254;\n"
+               "BA_DEF_ BO_ \"GenMsgCycleTime\" INT 0 65535 ;\n"
+               "BA_DEF_ BO_ \"VFrameFormat\" ENUM \"StandardCAN\",\"ExtendedCAN\",\"J1939PG\";\n"
+               "BA_DEF_ SG_ \"GenSigStartValue\" FLOAT -1.5 1e+06;\n"
+               "BA_DEF_DEF_ \"BusType\" \"CAN\";\n"
+               "BA_DEF_DEF_ \"NmStationAddress\" 0;\n"
+               "BA_DEF_DEF_ \"GenMsgCycleTime\" 100;\n"
+               "BA_DEF_DEF_ \"VFrameFormat\" \"J1939PG\";\n"
+               "BA_DEF_DEF_ \"GenSigStartValue\" 0;\n"
+               "BA_ \"VFrameFormat\" BO_ 2364540158 1;\n");
+    file.close();
+
+    DbcDataModel imported;
+    ASSERT_TRUE(imported.importDBC(dbcPath));
+    ASSERT_EQ(imported.messages().size(), 1);
+    const Message& message = imported.messages().first();
+    EXPECT_EQ(attributeRanges(imported.networks().first().networkAttributes).value("BusType"), QString());
+    EXPECT_EQ(attributeRanges(imported.nodes().first().nodeAttributes).value("NmStationAddress"), QString("0 254"));
+    EXPECT_EQ(attributeRanges(message.messageAttributes).value("GenMsgCycleTime"), QString("0 65535"));
+    EXPECT_EQ(attributeRanges(message.messageAttributes).value("VFrameFormat"),
+              QString("\"StandardCAN\",\"ExtendedCAN\",\"J1939PG\""));
+    EXPECT_EQ(attributeRanges(message.messageSignals.first().signalAttributes).value("GenSigStartValue"),
+              QString("-1.5 1e+06"));
+
+    const QString exportPath = directory.filePath("exported.dbc");
+    ASSERT_TRUE(imported.exportDBC(exportPath));
+    QFile exported(exportPath);
+    ASSERT_TRUE(exported.open(QIODevice::ReadOnly));
+    const QByteArray text = exported.readAll();
+    exported.close();
+    EXPECT_TRUE(text.contains("BA_DEF_ \"BusType\" STRING;\n"));
+    EXPECT_TRUE(text.contains("BA_DEF_ BU_ \"NmStationAddress\" HEX 0 254;\n"));
+    EXPECT_TRUE(text.contains("BA_DEF_ BO_ \"GenMsgCycleTime\" INT 0 65535;\n"));
+    EXPECT_TRUE(text.contains("BA_DEF_ BO_ \"VFrameFormat\" ENUM \"StandardCAN\",\"ExtendedCAN\",\"J1939PG\";\n"));
+    EXPECT_TRUE(text.contains("BA_DEF_ SG_ \"GenSigStartValue\" FLOAT -1.5 1e+06;\n"));
+
+    DbcDataModel reimported;
+    ASSERT_TRUE(reimported.importDBC(exportPath));
+    expectSameModel(imported, reimported);
+
+    // Snapshots carry the ranges as well
+    const QString snapshotPath = directory.filePath(QString("ranges.") + DbcSnapshot::Suffix);
+    ASSERT_TRUE(DbcSnapshot::save(snapshotPath, QList<DbcDataModel*>() << &imported));
+    QList<DbcDataModel*> loaded;
+    ASSERT_TRUE(DbcSnapshot::load(snapshotPath, loaded));
+    ASSERT_EQ(loaded.size(), 1);
+    expectSameModel(imported, *loaded.first());
+    qDeleteAll(loaded);
+}
+
+// Attributes without a BA_DEF_ range, e.g. from a JSON workspace, are declared over their values
+TEST(DbcRoundTrip, DerivedAttributeRanges)
+{
+    DbcDataModel model;
+    Network network;
+    network.name = QStringLiteral("Vehicle");
+    model.networks().append(network);
+    const char* const cycleTimes[] = {"100", "10", "1000", "100"};
+    for (int i = 0; i < 4; ++i) {
+        Message message;
+        message.pgn = DbcExtendedIdFlag | quint64(0x18FF0000 + i);
+        message.name = QString("Message%1").arg(i);
+        message.priority = 6;
+        message.length = 8;
+        message.txPeriodicity = 0;
+        message.multiplexValue = -1;
+        message.txOnChange = false;
+        message.messageAttributes.append(Attribute{"GenMsgCycleTime", "INT", cycleTimes[i], {}});
+        message.messageAttributes.append(Attribute{"Offset", "FLOAT", "-0.5", {}});
+        model.messages().append(message);
+    }
+
+    QTemporaryDir directory;
+    ASSERT_TRUE(directory.isValid());
+    const QString exportPath = directory.filePath("exported.dbc");
+    ASSERT_TRUE(model.exportDBC(exportPath));
+    QFile exported(exportPath);
+    ASSERT_TRUE(exported.open(QIODevice::ReadOnly));
+    const QByteArray text = exported.readAll();
+    EXPECT_TRUE(text.contains("BA_DEF_ BO_ \"GenMsgCycleTime\" INT 10 1000;\n"));
+    EXPECT_TRUE(text.contains("BA_DEF_ BO_ \"Offset\" FLOAT -0.5 -0.5;\n"));
+    EXPECT_TRUE(text.contains("BA_DEF_DEF_ \"GenMsgCycleTime\" 100;\n"));
+}
+
+// A DBC describes one network, models with more are not flattened into one file
+TEST(DbcRoundTrip, SeveralNetworks)
+{
+    DbcDataModel model;
+    ASSERT_TRUE(model.loadJson(samplePath("JSON/3Bus.json")));
+    ASSERT_GT(model.networks().size(), 1);
+
+    QTemporaryDir directory;
+    ASSERT_TRUE(directory.isValid());
+    const QString exportPath = directory.filePath("exported.dbc");
+    EXPECT_FALSE(model.exportDBC(exportPath));
+    EXPECT_FALSE(QFile::exists(exportPath));
+}
+
+}
@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "dbcdata.h"
+#include "dbcdecode.h"
+#include "samples.h"
+
+namespace {
+
+// Decoders for every message of the J1939 sample, each with a random payload of its length
+struct DecodeFixture {
+    std::vector<MessageDecoder> decoders;
+    std::vector<std::vector<uchar>> payloads;
+    int maxSignals = 0;
+    qint64 signalCount = 0;
+
+    bool load() {
+        DbcDataModel model;
+        if (!model.importDBC(j1939SamplePath())) {
+            return false;
+        }
+        std::mt19937 random(1);
+        for (const Message& message : model.messages()) {
+            decoders.emplace_back(message);
+            std::vector<uchar> payload(size_t(std::max(message.length, 0)));
+            for (uchar& byte : payload) {
+                byte = uchar(random());
+            }
+            payloads.push_back(std::move(payload));
+            maxSignals = std::max(maxSignals, decoders.back().signalCount());
+            signalCount += decoders.back().signalCount();
+        }
+        return true;
+    }
+};
+
+// One pass over all messages of the sample per iteration, the signals counter gives the rate
+void BM_DecodeJ1939Messages(benchmark::State& state)
+{
+    DecodeFixture fixture;
+    if (!fixture.load()) {
+        state.SkipWithError("Failed to import the J1939 sample");
+        return;
+    }
+    std::vector<double> values(size_t(fixture.maxSignals));
+    for (auto _ : state) {
+        for (size_t i = 0; i < fixture.decoders.size(); ++i) {
+            const std::vector<uchar>& payload = fixture.payloads[i];
+            fixture.decoders[i].decode(payload.data(), int(payload.size()), values.data());
+            benchmark::ClobberMemory();
+        }
+    }
+    state.counters["signals"] = benchmark::Counter(double(state.iterations() * fixture.signalCount),
+                                                   benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_DecodeJ1939Messages);
+
+// Decoding with the multiplexed, long and Motorola cases the sample hardly has: a 64-byte
+// payload packed with signals of every byte order and width
+void BM_DecodeMixedLayout(benchmark::State& state)
+{
+    Message message;
+    message.length = 64;
+    std::mt19937 random(2);
+    for (int startBit = 0, i = 0; startBit < 64 * 8 - 32; startBit += 24, ++i) {
+        Signal signal{};
+        signal.name = QString("S%1").arg(i);
+        signal.startBit = startBit;
+        signal.bitLength = 1 + int(random() % 32);
+        signal.isBigEndian = i % 2 == 1;
+        signal.isTwosComplement = i % 3 == 0;
+        signal.factor = 0.125;
+        signal.offset = -40;
+        message.messageSignals.append(signal);
+    }
+    const MessageDecoder decoder(message);
+    std::vector<uchar> payload(size_t(message.length));
+    for (uchar& byte : payload) {
+        byte = uchar(random());
+    }
+    std::vector<double> values(size_t(decoder.signalCount()));
+    for (auto _ : state) {
+        decoder.decode(payload.data(), int(payload.size()), values.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["signals"] = benchmark::Counter(double(state.iterations() * decoder.signalCount()),
+                                                   benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_DecodeMixedLayout);
+
+}
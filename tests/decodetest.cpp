@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "dbcdata.h"
+#include "dbcdecode.h"
+
+namespace {
+
+Signal makeSignal(int startBit, int bitLength, bool bigEndian, bool twosComplement = false,
+                  double factor = 1.0, double offset = 0.0)
+{
+    Signal signal;
+    signal.spn = 0;
+    signal.startBit = startBit;
+    signal.bitLength = bitLength;
+    signal.isBigEndian = bigEndian;
+    signal.isTwosComplement = twosComplement;
+    signal.isMultiplexer = false;
+    signal.factor = factor;
+    signal.offset = offset;
+    signal.multiplexValue = -1;
+    return signal;
+}
+
+Message makeMessage(const QList<Signal>& signalList)
+{
+    Message message;
+    message.pgn = 0x18FEF100;
+    message.priority = 6;
+    message.length = 8;
+    message.txPeriodicity = 0;
+    message.multiplexValue = -1;
+    message.txOnChange = false;
+    message.messageSignals = signalList;
+    return message;
+}
+
+std::vector<double> decode(const Message& message, const std::vector<uchar>& payload)
+{
+    const MessageDecoder decoder(message);
+    std::vector<double> values(size_t(decoder.signalCount()));
+    decoder.decode(payload.data(), int(payload.size()), values.data());
+    return values;
+}
+
+// Start bits give the least significant bit for @1 (Intel) and the most significant one for
+// @0 (Motorola), bits are numbered from bit 0 of byte 0
+TEST(MessageDecoder, IntelAcrossBytes)
+{
+    const Message message = makeMessage(QList<Signal>() << makeSignal(4, 12, false) << makeSignal(52, 12, false));
+    const std::vector<double> values = decode(message, {0xA0, 0xBC, 0, 0, 0, 0, 0x50, 0x7F});
+    EXPECT_EQ(values[0], 0xBCA);
+    EXPECT_EQ(values[1], 0x7F5);
+}
+
+TEST(MessageDecoder, MotorolaAcrossBytes)
+{
+    const Message message = makeMessage(QList<Signal>() << makeSignal(3, 12, true) << makeSignal(29, 16, true));
+    const std::vector<double> values = decode(message, {0x0A, 0xBC, 0, 0x2A, 0xFF, 0x40, 0, 0});
+    EXPECT_EQ(values[0], 0xABC);
+    EXPECT_EQ(values[1], 0xABFD);
+}
+
+TEST(MessageDecoder, Signed)
+{
+    const Message message = makeMessage(QList<Signal>() << makeSignal(0, 8, false, true, 0.5, 10)
+                                                        << makeSignal(11, 12, true, true)
+                                                        << makeSignal(24, 16, false, true));
+    const std::vector<double> values = decode(message, {0xFE, 0x08, 0x00, 0x00, 0x80, 0, 0, 0});
+    EXPECT_EQ(values[0], 9.0);
+    EXPECT_EQ(values[1], -2048.0);
+    EXPECT_EQ(values[2], -32768.0);
+}
+
+TEST(MessageDecoder, SixtyFourBits)
+{
+    const std::vector<uchar> counting = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    EXPECT_EQ(decode(makeMessage(QList<Signal>() << makeSignal(0, 64, false)), counting)[0],
+              double(0x0807060504030201ULL));
+    EXPECT_EQ(decode(makeMessage(QList<Signal>() << makeSignal(7, 64, true)), counting)[0],
+              double(0x0102030405060708ULL));
+
+    const std::vector<uchar> ones(8, 0xFF);
+    EXPECT_EQ(decode(makeMessage(QList<Signal>() << makeSignal(0, 64, false)), ones)[0], double(~0ULL));
+    EXPECT_EQ(decode(makeMessage(QList<Signal>() << makeSignal(0, 64, false, true)), ones)[0], -1.0);
+    EXPECT_EQ(decode(makeMessage(QList<Signal>() << makeSignal(7, 64, true, true)),
+                     {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE})[0], -2.0);
+}
+
+// Bytes past the received length read as zero, also for signals straddling the end
+TEST(MessageDecoder, ShortPayload)
+{
+    const Message message = makeMessage(QList<Signal>() << makeSignal(24, 16, false)
+                                                        << makeSignal(31, 16, true)
+                                                        << makeSignal(48, 8, false));
+    std::vector<double> values = decode(message, {0x11, 0x22, 0x33, 0x44});
+    EXPECT_EQ(values[0], 0x44);
+    EXPECT_EQ(values[1], 0x4400);
+    EXPECT_EQ(values[2], 0.0);
+
+    values = decode(message, {});
+    EXPECT_EQ(values[0], 0.0);
+    EXPECT_EQ(values[1], 0.0);
+    EXPECT_EQ(values[2], 0.0);
+}
+
+// Every signal is decoded whatever the multiplexer selects, raw() gives the multiplexer unscaled
+TEST(MessageDecoder, Multiplexed)
+{
+    Signal multiplexer = makeSignal(0, 8, false, false, 2, 1);
+    multiplexer.isMultiplexer = true;
+    Signal first = makeSignal(8, 8, false);
+    first.multiplexValue = 0;
+    Signal second = makeSignal(8, 8, false, true);
+    second.multiplexValue = 1;
+    const Message message = makeMessage(QList<Signal>() << multiplexer << first << second);
+
+    const std::vector<uchar> payload = {0x01, 0xFE, 0, 0, 0, 0, 0, 0};
+    const std::vector<double> values = decode(message, payload);
+    EXPECT_EQ(values[0], 3.0);
+    EXPECT_EQ(values[1], 254.0);
+    EXPECT_EQ(values[2], -2.0);
+
+    const MessageDecoder decoder(message);
+    EXPECT_EQ(decoder.raw(payload.data(), int(payload.size()), 0), 1u);
+    EXPECT_EQ(decoder.raw(payload.data(), int(payload.size()), 2), 0xFEu);
+}
+
+TEST(MessageDecoder, ImpossibleLayout)
+{
+    const Message message = makeMessage(QList<Signal>() << makeSignal(0, 0, false) << makeSignal(0, 65, false)
+                                                        << makeSignal(-1, 8, true) << makeSignal(8, 8, false));
+    const std::vector<uchar> payload = {0xFF, 0x12, 0, 0, 0, 0, 0, 0};
+    const std::vector<double> values = decode(message, payload);
+    EXPECT_TRUE(std::isnan(values[0]));
+    EXPECT_TRUE(std::isnan(values[1]));
+    EXPECT_TRUE(std::isnan(values[2]));
+    EXPECT_EQ(values[3], 0x12);
+    EXPECT_EQ(MessageDecoder(message).raw(payload.data(), int(payload.size()), 1), 0u);
+}
+
+}
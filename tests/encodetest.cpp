@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "dbcdata.h"
+#include "dbcdecode.h"
+#include "dbcencode.h"
+#include "samples.h"
+
+namespace {
+
+Signal makeSignal(int startBit, int bitLength, bool bigEndian, bool twosComplement = false)
+{
+    Signal signal;
+    signal.spn = 0;
+    signal.startBit = startBit;
+    signal.bitLength = bitLength;
+    signal.isBigEndian = bigEndian;
+    signal.isTwosComplement = twosComplement;
+    signal.isMultiplexer = false;
+    signal.factor = 1.0;
+    signal.offset = 0.0;
+    signal.multiplexValue = -1;
+    return signal;
+}
+
+Message makeMessage(const QList<Signal>& signalList)
+{
+    Message message;
+    message.pgn = 0x18FEF100;
+    message.priority = 6;
+    message.length = 8;
+    message.txPeriodicity = 0;
+    message.multiplexValue = -1;
+    message.txOnChange = false;
+    message.messageSignals = signalList;
+    return message;
+}
+
+// Encodes into a zeroed payload of size bytes
+std::vector<uchar> encode(const Message& message, const std::vector<double>& values, int size = 8)
+{
+    std::vector<uchar> payload(size_t(size), 0);
+    MessageEncoder(message).encode(values.data(), payload.data(), size);
+    return payload;
+}
+
+std::vector<double> decode(const Message& message, const std::vector<uchar>& payload)
+{
+    const MessageDecoder decoder(message);
+    std::vector<double> values(size_t(decoder.signalCount()));
+    decoder.decode(payload.data(), int(payload.size()), values.data());
+    return values;
+}
+
+// Values decoded from random payloads encode back to the same values, for the sample as
+// imported and with every signal made Motorola, two's complement or both. Ranges are dropped,
+// random payloads leave them.
+TEST(MessageEncoder, J1939SampleRoundTrip)
+{
+    DbcDataModel model;
+    ASSERT_TRUE(model.importDBC(j1939SamplePath()));
+    ASSERT_FALSE(model.messages().isEmpty());
+
+    std::mt19937 random(2);
+    for (int variant = 0; variant < 4; ++variant) {
+        SCOPED_TRACE(variant);
+        for (Message message : model.messages()) {
+            SCOPED_TRACE(message.name.toStdString());
+            for (Signal& signal : message.messageSignals) {
+                if (variant != 0) {
+                    signal.isBigEndian = (variant & 1) != 0;
+                    signal.isTwosComplement = (variant & 2) != 0;
+                }
+                signal.scaledMin = QVariant();
+                signal.scaledMax = QVariant();
+            }
+            std::vector<uchar> payload(size_t(std::max(message.length, 0)));
+            for (uchar& byte : payload) {
+                byte = uchar(random());
+            }
+
+            const std::vector<double> values = decode(message, payload);
+            const std::vector<double> roundTripped = decode(message, encode(message, values, int(payload.size())));
+            for (int i = 0; i < message.messageSignals.size(); ++i) {
+                if (!std::isnan(values[size_t(i)]) && message.messageSignals[i].factor != 0.0) {
+                    EXPECT_EQ(values[size_t(i)], roundTripped[size_t(i)]) << message.messageSignals[i].name.toStdString();
+                }
+            }
+        }
+    }
+}
+
+TEST(MessageEncoder, KnownFrame)
+{
+    Signal speed = makeSignal(8, 16, false);
+    speed.factor = 0.125;
+    Signal torque = makeSignal(31, 12, true, true);
+    torque.offset = -100;
+    const Message message = makeMessage(QList<Signal>() << makeSignal(0, 4, false) << speed << torque);
+
+    const std::vector<uchar> payload = encode(message, {5, 1000, -103});
+    EXPECT_EQ(payload, (std::vector<uchar>{0x05, 0x40, 0x1F, 0xFF, 0xD0, 0, 0, 0}));
+}
+
+// Physical ranges clamp first, then what the raw field holds
+TEST(MessageEncoder, Clamping)
+{
+    Signal ranged = makeSignal(0, 8, false);
+    ranged.scaledMin = 10.0;
+    ranged.scaledMax = 200.0;
+    const Message message = makeMessage(QList<Signal>() << ranged << makeSignal(8, 8, false)
+                                                        << makeSignal(23, 8, true, true));
+
+    EXPECT_EQ(decode(message, encode(message, {300, 300, 200})), (std::vector<double>{200, 255, 127}));
+    EXPECT_EQ(decode(message, encode(message, {-5, -5, -200})), (std::vector<double>{10, 0, -128}));
+}
+
+// Bits past size are dropped, the bytes before it still get the signal's low part
+TEST(MessageEncoder, ShortPayload)
+{
+    const Message message = makeMessage(QList<Signal>() << makeSignal(24, 16, false) << makeSignal(15, 16, true)
+                                                        << makeSignal(48, 8, false));
+    std::vector<uchar> payload(8, 0xAA);
+    MessageEncoder(message).encode(std::vector<double>{0x1234, 0x5678, 0x99}.data(), payload.data(), 3);
+    EXPECT_EQ(payload, (std::vector<uchar>{0xAA, 0x56, 0x78, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA}));
+
+    payload.assign(8, 0);
+    MessageEncoder(message).encode(std::vector<double>{0x1234, 0x5678, 0x99}.data(), payload.data(), 4);
+    EXPECT_EQ(payload, (std::vector<uchar>{0, 0x56, 0x78, 0x34, 0, 0, 0, 0}));
+}
+
+// Raw values pass through a double: wide fields clamp to the largest integer below their limit
+// a double holds instead of wrapping around
+TEST(MessageEncoder, WideLimits)
+{
+    const Message message = makeMessage(QList<Signal>() << makeSignal(0, 64, false));
+    EXPECT_EQ(decode(message, encode(message, {std::ldexp(1.0, 63)})), (std::vector<double>{std::ldexp(1.0, 63)}));
+    EXPECT_EQ(encode(message, {std::ldexp(1.0, 64)}),
+              (std::vector<uchar>{0x00, 0xF8, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}));
+    EXPECT_EQ(encode(message, {-1}), std::vector<uchar>(8, 0));
+
+    const Message signedMessage = makeMessage(QList<Signal>() << makeSignal(0, 64, false, true));
+    EXPECT_EQ(encode(signedMessage, {1e30}), (std::vector<uchar>{0x00, 0xFC, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F}));
+    EXPECT_EQ(encode(signedMessage, {-1e30}), (std::vector<uchar>{0, 0, 0, 0, 0, 0, 0, 0x80}));
+
+    const Message sixtyBits = makeMessage(QList<Signal>() << makeSignal(0, 60, false));
+    EXPECT_EQ(decode(sixtyBits, encode(sixtyBits, {1e30})),
+              (std::vector<double>{std::nextafter(std::ldexp(1.0, 60), 0.0)}));
+}
+
+}
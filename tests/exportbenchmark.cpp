@@ -0,0 +1,30 @@
+#include <benchmark/benchmark.h>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include "dbcdata.h"
+#include "samples.h"
+
+namespace {
+
+// Writes the imported J1939 sample back out, bytes are counted on the written file
+void BM_ExportDbc(benchmark::State& state)
+{
+    DbcDataModel model;
+    QTemporaryDir directory;
+    if (!directory.isValid() || !model.importDBC(j1939SamplePath())) {
+        state.SkipWithError("Failed to import the J1939 sample");
+        return;
+    }
+    const QString exportPath = directory.filePath("exported.dbc");
+    for (auto _ : state) {
+        if (!model.exportDBC(exportPath)) {
+            state.SkipWithError("Failed to export the J1939 sample");
+            break;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * QFileInfo(exportPath).size());
+    state.counters["messages"] = double(model.messages().size());
+}
+BENCHMARK(BM_ExportDbc)->Unit(benchmark::kMillisecond);
+
+}
@@ -0,0 +1,156 @@
+#include <benchmark/benchmark.h>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include "dbcdata.h"
+#include "samples.h"
+
+namespace {
+
+// Line matching of the importer the tokenizer replaced: every line went through up to six
+// regular expressions until one matched. Building the model is left out, so the speedup
+// against BM_ImportDbc is understated rather than overstated.
+void BM_ImportDbcRegexCascade(benchmark::State& state)
+{
+    const QRegularExpression reNode("^BU_:\\s*(.*)");
+    const QRegularExpression reMessage("^BO_\\s+(\\d+)\\s+(\\w+):\\s+(\\d+)\\s+(\\w+)");
+    const QRegularExpression reSignal(
+        "^\\s*SG_\\s+(\\w+)\\s*(?:([mM]\\d*[mM]?)\\s*)?:\\s*"
+        "(\\d+)\\|(\\d+)@(\\d+)([+-])\\s+"
+        "\\(([^,]+),([^\\)]+)\\)\\s+"
+        "\\[([^\\|]+)\\|([^\\]]+)\\]\\s+"
+        "\"([^\"]*)\"\\s*"
+        "(.*)");
+    const QRegularExpression reAttributeDef("^BA_DEF_\\s+(\\w+)\\s+\"([^\"]+)\"\\s+(\\w+)");
+    const QRegularExpression reAttributeDefDef("^BA_DEF_DEF_\\s+\"([^\"]+)\"\\s+\"?([^\"]+)\"?");
+    const QRegularExpression reAttributeAssignment("^BA_\\s+\"([^\"]+)\"\\s+(\\w+)\\s+(\\w+)\\s+\"?([^\"]+)\"?");
+    const QRegularExpression* cascade[] = {&reNode, &reMessage, &reSignal, &reAttributeDef, &reAttributeDefDef,
+                                           &reAttributeAssignment};
+
+    const QString filePath = j1939SamplePath();
+    for (auto _ : state) {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            state.SkipWithError("Failed to open the J1939 sample");
+            break;
+        }
+        QTextStream in(&file);
+        int matched = 0;
+        while (!in.atEnd()) {
+            const QString line = in.readLine();
+            for (const QRegularExpression* expression : cascade) {
+                if (expression->match(line).hasMatch()) {
+                    ++matched;
+                    break;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(matched);
+    }
+    state.SetBytesProcessed(state.iterations() * QFileInfo(filePath).size());
+}
+BENCHMARK(BM_ImportDbcRegexCascade)->Unit(benchmark::kMillisecond);
+
+void BM_ImportDbc(benchmark::State& state)
+{
+    const QString filePath = j1939SamplePath();
+    qint64 comments = 0;
+    qint64 valueTables = 0;
+    for (auto _ : state) {
+        DbcDataModel model;
+        if (!model.importDBC(filePath)) {
+            state.SkipWithError("Failed to import the J1939 sample");
+            break;
+        }
+        benchmark::DoNotOptimize(model.messages().size());
+
+        // Comments and value tables attached, to see none are lost
+        state.PauseTiming();
+        comments = 0;
+        valueTables = 0;
+        for (const Message& message : model.messages()) {
+            comments += !message.description.isEmpty();
+            for (const Signal& signal : message.messageSignals) {
+                comments += !signal.description.isEmpty();
+                valueTables += !signal.enumerations.isEmpty();
+            }
+        }
+        state.ResumeTiming();
+    }
+    state.counters["comments"] = double(comments);
+    state.counters["valueTables"] = double(valueTables);
+    state.SetBytesProcessed(state.iterations() * QFileInfo(filePath).size());
+}
+BENCHMARK(BM_ImportDbc)->Unit(benchmark::kMillisecond);
+
+// The sample without its CM_ and VAL_ statements, written once per run. Statements end at the
+// first semicolon outside a string, comments may span lines.
+const QString& sampleWithoutCommentsAndValues()
+{
+    static QTemporaryFile stripped;
+    static QString path;
+    if (!path.isEmpty()) {
+        return path;
+    }
+
+    QFile file(j1939SamplePath());
+    if (!file.open(QIODevice::ReadOnly) || !stripped.open()) {
+        return path;
+    }
+    const QByteArray text = file.readAll();
+    QByteArray kept;
+    kept.reserve(text.size());
+    qsizetype pos = 0;
+    while (pos < text.size()) {
+        qsizetype lineEnd = text.indexOf('\n', pos);
+        lineEnd = lineEnd < 0 ? text.size() : lineEnd + 1;
+        const QByteArray line = text.mid(pos, lineEnd - pos);
+        if (!line.startsWith("CM_ ") && !line.startsWith("VAL_ ")) {
+            kept += line;
+            pos = lineEnd;
+            continue;
+        }
+        bool quoted = false;
+        for (; pos < text.size(); ++pos) {
+            const char c = text[pos];
+            if (c == '\\' && quoted) {
+                ++pos;
+            } else if (c == '"') {
+                quoted = !quoted;
+            } else if (c == ';' && !quoted) {
+                break;
+            }
+        }
+        pos = text.indexOf('\n', pos);
+        pos = pos < 0 ? text.size() : pos + 1;
+    }
+    stripped.write(kept);
+    stripped.flush();
+    path = stripped.fileName();
+    return path;
+}
+
+// Against BM_ImportDbc this shows what parsing the about 4,200 comments and 1,900 value
+// tables of the sample costs. Bytes are counted on the full sample so both rates compare.
+void BM_ImportDbcWithoutCommentsAndValues(benchmark::State& state)
+{
+    const QString& filePath = sampleWithoutCommentsAndValues();
+    if (filePath.isEmpty()) {
+        state.SkipWithError("Failed to write the stripped J1939 sample");
+        return;
+    }
+    for (auto _ : state) {
+        DbcDataModel model;
+        if (!model.importDBC(filePath)) {
+            state.SkipWithError("Failed to import the stripped J1939 sample");
+            break;
+        }
+        benchmark::DoNotOptimize(model.messages().size());
+    }
+    state.SetBytesProcessed(state.iterations() * QFileInfo(j1939SamplePath()).size());
+}
+BENCHMARK(BM_ImportDbcWithoutCommentsAndValues)->Unit(benchmark::kMillisecond);
+
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "dbcdata.h"
+#include "j1939.h"
+
+namespace {
+
+Message makeMessage(const char* name, quint64 pgn)
+{
+    Message message;
+    message.pgn = pgn;
+    message.name = QString::fromUtf8(name);
+    message.priority = 6;
+    message.length = 8;
+    message.txPeriodicity = 0;
+    message.multiplexValue = -1;
+    message.txOnChange = false;
+    return message;
+}
+
+// Name of the message a frame routes to, empty if none
+QString routed(const J1939Dispatch& dispatch, quint32 canId, bool extended = true)
+{
+    const J1939Dispatch::Target* target = dispatch.route(canId, extended);
+    return target ? target->messageName : QString();
+}
+
+TEST(J1939Id, Fields)
+{
+    const J1939Id pdu2 = J1939Id::fromCanId(0x1DFEF117);
+    EXPECT_EQ(pdu2.priority, 7);
+    EXPECT_FALSE(pdu2.extendedDataPage);
+    EXPECT_TRUE(pdu2.dataPage);
+    EXPECT_EQ(pdu2.pgn, 0x1FEF1u);
+    EXPECT_EQ(pdu2.sourceAddress, 0x17);
+    EXPECT_FALSE(pdu2.isPdu1());
+    EXPECT_EQ(pdu2.destination(), 0xFF);
+
+    const J1939Id pdu1 = J1939Id::fromCanId(0x0AEF2A17);
+    EXPECT_EQ(pdu1.priority, 2);
+    EXPECT_TRUE(pdu1.extendedDataPage);
+    EXPECT_FALSE(pdu1.dataPage);
+    EXPECT_EQ(pdu1.pgn, 0x2EF00u);
+    EXPECT_TRUE(pdu1.isPdu1());
+    EXPECT_EQ(pdu1.destination(), 0x2A);
+
+    EXPECT_TRUE(J1939Id::isCanId(DbcExtendedIdFlag | 0x18FEF100));
+    EXPECT_FALSE(J1939Id::isCanId(0xFEF1));
+    EXPECT_EQ(J1939Id::pgnOf(DbcExtendedIdFlag | 0x18FEF100), 0xFEF1u);
+    EXPECT_EQ(J1939Id::pgnOf(0xEF00), 0xEF00u);
+}
+
+// A PDU2 message from a DBC BO_ id is found through the flat table from any source and priority
+TEST(J1939Dispatch, Pdu2)
+{
+    DbcDataModel model;
+    model.messages().append(makeMessage("CCVS", DbcExtendedIdFlag | 0x18FEF100));
+    J1939Dispatch dispatch;
+    dispatch.build(QList<DbcDataModel*>() << &model);
+
+    EXPECT_EQ(routed(dispatch, 0x18FEF100), QString("CCVS"));
+    EXPECT_EQ(routed(dispatch, 0x18FEF117), QString("CCVS"));
+    EXPECT_EQ(routed(dispatch, 0x0CFEF100), QString("CCVS"));
+    EXPECT_EQ(routed(dispatch, 0x18FEF200), QString());
+}
+
+// PDU1 PGNs leave out the destination address the identifier carries
+TEST(J1939Dispatch, Pdu1Destination)
+{
+    DbcDataModel model;
+    model.messages().append(makeMessage("TSC1", 0x0000));
+    model.messages().append(makeMessage("PropA", DbcExtendedIdFlag | 0x18EF2A17));
+    J1939Dispatch dispatch;
+    dispatch.build(QList<DbcDataModel*>() << &model);
+
+    EXPECT_EQ(routed(dispatch, 0x0C000017), QString("TSC1"));
+    EXPECT_EQ(routed(dispatch, 0x0C00FF03), QString("TSC1"));
+    EXPECT_EQ(routed(dispatch, 0x18EF2A17), QString("PropA"));
+    EXPECT_EQ(routed(dispatch, 0x18EF0517), QString("PropA"));
+}
+
+// A PGN both bound to one source and given as a bare PGN: the bound message for its source,
+// the bare one for every other source
+TEST(J1939Dispatch, SourceBoundAndWildcard)
+{
+    DbcDataModel model;
+    model.messages().append(makeMessage("AnySource", 0xFEF1));
+    model.messages().append(makeMessage("Engine", DbcExtendedIdFlag | 0x18FEF100));
+    model.messages().append(makeMessage("Retarder", DbcExtendedIdFlag | 0x18FEF10F));
+    J1939Dispatch dispatch;
+    dispatch.build(QList<DbcDataModel*>() << &model);
+    EXPECT_EQ(dispatch.size(), 3);
+
+    EXPECT_EQ(routed(dispatch, 0x18FEF100), QString("Engine"));
+    EXPECT_EQ(routed(dispatch, 0x18FEF10F), QString("Retarder"));
+    EXPECT_EQ(routed(dispatch, 0x18FEF117), QString("AnySource"));
+}
+
+// Without a bare PGN, the first message registered answers for unknown sources
+TEST(J1939Dispatch, SourceBoundOnly)
+{
+    DbcDataModel model;
+    model.messages().append(makeMessage("Engine", DbcExtendedIdFlag | 0x18FEF100));
+    model.messages().append(makeMessage("Retarder", DbcExtendedIdFlag | 0x18FEF10F));
+    model.messages().append(makeMessage("EngineAgain", DbcExtendedIdFlag | 0x0CFEF100));
+    J1939Dispatch dispatch;
+    dispatch.build(QList<DbcDataModel*>() << &model);
+    EXPECT_EQ(dispatch.size(), 2);
+
+    EXPECT_EQ(routed(dispatch, 0x18FEF10F), QString("Retarder"));
+    EXPECT_EQ(routed(dispatch, 0x18FEF100), QString("Engine"));
+    EXPECT_EQ(routed(dispatch, 0x18FEF117), QString("Engine"));
+}
+
+// Priority is not part of the PGN, the data page bits are
+TEST(J1939Dispatch, PriorityAndDataPage)
+{
+    DbcDataModel model;
+    model.messages().append(makeMessage("Page0", DbcExtendedIdFlag | 0x18FEF100));
+    model.messages().append(makeMessage("Page1", DbcExtendedIdFlag | 0x19FEF100));
+    model.messages().append(makeMessage("Extended", DbcExtendedIdFlag | 0x1AEF0000));
+    J1939Dispatch dispatch;
+    dispatch.build(QList<DbcDataModel*>() << &model);
+
+    for (quint32 priority = 0; priority < 8; ++priority) {
+        EXPECT_EQ(routed(dispatch, (priority << 26) | 0x00FEF100), QString("Page0"));
+        EXPECT_EQ(routed(dispatch, (priority << 26) | 0x01FEF100), QString("Page1"));
+    }
+    EXPECT_EQ(routed(dispatch, 0x1AEF1234), QString("Extended"));
+    EXPECT_EQ(routed(dispatch, 0x18EF1234), QString());
+    EXPECT_EQ(routed(dispatch, 0x1BFEF100), QString());
+}
+
+TEST(J1939Dispatch, UnknownAndStandard)
+{
+    DbcDataModel model;
+    model.messages().append(makeMessage("Standard", 0x123));
+    J1939Dispatch dispatch;
+    dispatch.build(QList<DbcDataModel*>() << &model);
+
+    EXPECT_EQ(routed(dispatch, 0x123, false), QString("Standard"));
+    EXPECT_EQ(routed(dispatch, 0x124, false), QString());
+    EXPECT_EQ(routed(dispatch, 0x18FEF100), QString());
+
+    J1939Dispatch empty;
+    EXPECT_EQ(routed(empty, 0x18FEF100), QString());
+    EXPECT_EQ(routed(empty, 0x123, false), QString());
+}
+
+}
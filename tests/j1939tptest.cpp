@@ -0,0 +1,259 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "dbcdata.h"
+#include "j1939.h"
+#include "j1939tp.h"
+
+namespace {
+
+constexpr quint32 Dm1 = 0xFECA;
+constexpr quint32 Proprietary = 0xEF00;
+
+// A capture of transport sessions fed frame by frame, keeping copies of what completes
+struct Capture {
+    struct Payload {
+        quint32 pgn;
+        quint8 source;
+        quint8 destination;
+        std::vector<uchar> data;
+        QString messageName;
+        std::vector<double> values;
+    };
+
+    DbcDataModel model;
+    J1939Dispatch dispatch;
+    J1939TransportReassembler reassembler;
+    std::vector<Payload> completed;
+
+    // DM1 with one signal in its 9th byte, so a completed BAM decodes
+    Capture() : reassembler(dispatch)
+    {
+        Signal signal;
+        signal.spn = 0;
+        signal.name = "NinthByte";
+        signal.startBit = 64;
+        signal.bitLength = 8;
+        signal.isBigEndian = false;
+        signal.isTwosComplement = false;
+        signal.isMultiplexer = false;
+        signal.factor = 1.0;
+        signal.offset = 0.0;
+        signal.multiplexValue = -1;
+        Message message;
+        message.pgn = Dm1;
+        message.name = "DM1";
+        message.priority = 6;
+        message.length = 20;
+        message.txPeriodicity = 0;
+        message.multiplexValue = -1;
+        message.txOnChange = false;
+        message.messageSignals.append(signal);
+        model.messages().append(message);
+        dispatch.build(QList<DbcDataModel*>() << &model);
+
+        reassembler.setCompletedCallback([this](const J1939TransportReassembler::Completed& payload) {
+            completed.push_back({payload.pgn, payload.source, payload.destination,
+                                 std::vector<uchar>(payload.data, payload.data + payload.size),
+                                 payload.target ? payload.target->messageName : QString(),
+                                 payload.values ? std::vector<double>(payload.values, payload.values + 1)
+                                                : std::vector<double>()});
+        });
+    }
+
+    bool send(quint32 canId, std::vector<uchar> data, qint64 timestamp)
+    {
+        return reassembler.processFrame(canId, data.data(), int(data.size()), timestamp);
+    }
+
+    // TP.CM BAM or RTS announcing size bytes of pgn in as many packets as it takes
+    void announce(quint8 source, quint8 destination, int size, quint32 pgn, qint64 timestamp)
+    {
+        const bool broadcast = destination == 0xFF;
+        send(0x1CEC0000 | quint32(destination) << 8 | source,
+             {uchar(broadcast ? 32 : 16), uchar(size), uchar(size >> 8), uchar((size + 6) / 7), 0xFF, uchar(pgn),
+              uchar(pgn >> 8), uchar(pgn >> 16)},
+             timestamp);
+    }
+
+    // TP.DT packet sequence of the payload counting up from 1
+    void transfer(quint8 source, quint8 destination, int sequence, qint64 timestamp)
+    {
+        std::vector<uchar> data = {uchar(sequence)};
+        for (int i = 0; i < 7; ++i) {
+            data.push_back(uchar((sequence - 1) * 7 + i + 1));
+        }
+        send(0x1CEB0000 | quint32(destination) << 8 | source, data, timestamp);
+    }
+
+    // TP.CM sent by from, to the other side of a connection
+    void control(quint8 from, quint8 to, uchar controlByte, quint32 pgn, qint64 timestamp)
+    {
+        send(0x1CEC0000 | quint32(to) << 8 | from,
+             {controlByte, 1, 1, 0xFF, 0xFF, uchar(pgn), uchar(pgn >> 8), uchar(pgn >> 16)}, timestamp);
+    }
+};
+
+// Payload bytes as transfer() sends them
+std::vector<uchar> counting(int size)
+{
+    std::vector<uchar> data;
+    for (int i = 1; i <= size; ++i) {
+        data.push_back(uchar(i));
+    }
+    return data;
+}
+
+TEST(J1939Transport, Broadcast)
+{
+    Capture capture;
+    capture.announce(0x00, 0xFF, 20, Dm1, 0);
+    for (int sequence = 1; sequence <= 3; ++sequence) {
+        capture.transfer(0x00, 0xFF, sequence, sequence * 50000);
+    }
+
+    ASSERT_EQ(capture.completed.size(), 1u);
+    const Capture::Payload& payload = capture.completed.front();
+    EXPECT_EQ(payload.pgn, Dm1);
+    EXPECT_EQ(payload.source, 0x00);
+    EXPECT_EQ(payload.destination, 0xFF);
+    EXPECT_EQ(payload.data, counting(20));
+    EXPECT_EQ(payload.messageName, QString("DM1"));
+    ASSERT_EQ(payload.values.size(), 1u);
+    EXPECT_EQ(payload.values[0], 9.0);
+    EXPECT_EQ(capture.reassembler.statistics().completed, 1);
+    EXPECT_EQ(capture.reassembler.activeSessions(), 0);
+}
+
+// RTS/CTS: packets resent after a CTS are already stored and skipped
+TEST(J1939Transport, RequestToSend)
+{
+    Capture capture;
+    capture.announce(0x00, 0x17, 16, Proprietary, 0);
+    capture.control(0x17, 0x00, 17, Proprietary, 10000);
+    capture.transfer(0x00, 0x17, 1, 20000);
+    capture.transfer(0x00, 0x17, 2, 30000);
+    capture.control(0x17, 0x00, 17, Proprietary, 40000);
+    capture.transfer(0x00, 0x17, 2, 50000);
+    capture.transfer(0x00, 0x17, 3, 60000);
+    capture.control(0x17, 0x00, 19, Proprietary, 70000);
+
+    ASSERT_EQ(capture.completed.size(), 1u);
+    const Capture::Payload& payload = capture.completed.front();
+    EXPECT_EQ(payload.pgn, Proprietary);
+    EXPECT_EQ(payload.source, 0x00);
+    EXPECT_EQ(payload.destination, 0x17);
+    EXPECT_EQ(payload.data, counting(16));
+    EXPECT_EQ(payload.messageName, QString());
+    EXPECT_TRUE(payload.values.empty());
+    EXPECT_EQ(capture.reassembler.statistics().dropped, 0);
+}
+
+TEST(J1939Transport, OutOfOrder)
+{
+    Capture capture;
+    capture.announce(0x00, 0xFF, 20, Dm1, 0);
+    capture.transfer(0x00, 0xFF, 2, 10000);
+    capture.transfer(0x00, 0xFF, 1, 20000);
+    capture.transfer(0x00, 0xFF, 3, 30000);
+
+    EXPECT_TRUE(capture.completed.empty());
+    EXPECT_EQ(capture.reassembler.statistics().dropped, 1);
+    EXPECT_EQ(capture.reassembler.activeSessions(), 0);
+}
+
+TEST(J1939Transport, MissingPacket)
+{
+    Capture capture;
+    capture.announce(0x00, 0x17, 20, Proprietary, 0);
+    capture.transfer(0x00, 0x17, 1, 10000);
+    capture.transfer(0x00, 0x17, 3, 20000);
+
+    EXPECT_TRUE(capture.completed.empty());
+    EXPECT_EQ(capture.reassembler.statistics().dropped, 1);
+    EXPECT_EQ(capture.reassembler.activeSessions(), 0);
+}
+
+// Either side of a connection may abort it
+TEST(J1939Transport, Abort)
+{
+    Capture capture;
+    capture.announce(0x00, 0x17, 20, Proprietary, 0);
+    capture.transfer(0x00, 0x17, 1, 10000);
+    capture.control(0x17, 0x00, 255, Proprietary, 20000);
+    capture.transfer(0x00, 0x17, 2, 30000);
+    capture.transfer(0x00, 0x17, 3, 40000);
+
+    capture.announce(0x05, 0x17, 20, Proprietary, 50000);
+    capture.control(0x05, 0x17, 255, Proprietary, 60000);
+
+    EXPECT_TRUE(capture.completed.empty());
+    EXPECT_EQ(capture.reassembler.statistics().aborted, 2);
+    EXPECT_EQ(capture.reassembler.activeSessions(), 0);
+}
+
+// BAM packets may be 750 ms apart, connection mode ones 1250 ms
+TEST(J1939Transport, Timeout)
+{
+    Capture capture;
+    capture.announce(0x00, 0xFF, 20, Dm1, 0);
+    capture.announce(0x01, 0x17, 20, Proprietary, 0);
+    capture.transfer(0x00, 0xFF, 1, 700000);
+    capture.transfer(0x01, 0x17, 1, 700000);
+    EXPECT_EQ(capture.reassembler.activeSessions(), 2);
+
+    capture.reassembler.expire(1500000);
+    EXPECT_EQ(capture.reassembler.statistics().timedOut, 1);
+    EXPECT_EQ(capture.reassembler.activeSessions(), 1);
+    capture.transfer(0x00, 0xFF, 2, 1500000);
+    capture.transfer(0x00, 0xFF, 3, 1500000);
+    EXPECT_TRUE(capture.completed.empty());
+
+    capture.transfer(0x01, 0x17, 2, 1900000);
+    capture.transfer(0x01, 0x17, 3, 3200000);
+    EXPECT_EQ(capture.reassembler.statistics().timedOut, 2);
+    EXPECT_TRUE(capture.completed.empty());
+    EXPECT_EQ(capture.reassembler.activeSessions(), 0);
+}
+
+// One session per (source, destination): a new announcement replaces the one in progress,
+// other pairs are unaffected
+TEST(J1939Transport, ReplacedSession)
+{
+    Capture capture;
+    capture.announce(0x00, 0xFF, 20, Proprietary, 0);
+    capture.announce(0x03, 0xFF, 14, Proprietary, 0);
+    capture.transfer(0x00, 0xFF, 1, 10000);
+    capture.transfer(0x03, 0xFF, 1, 10000);
+    capture.announce(0x00, 0xFF, 20, Dm1, 20000);
+    EXPECT_EQ(capture.reassembler.statistics().aborted, 1);
+    EXPECT_EQ(capture.reassembler.activeSessions(), 2);
+
+    for (int sequence = 1; sequence <= 3; ++sequence) {
+        capture.transfer(0x00, 0xFF, sequence, 30000 + sequence * 10000);
+    }
+    capture.transfer(0x03, 0xFF, 2, 70000);
+
+    ASSERT_EQ(capture.completed.size(), 2u);
+    EXPECT_EQ(capture.completed[0].pgn, Dm1);
+    EXPECT_EQ(capture.completed[0].source, 0x00);
+    EXPECT_EQ(capture.completed[0].data, counting(20));
+    EXPECT_EQ(capture.completed[1].pgn, Proprietary);
+    EXPECT_EQ(capture.completed[1].source, 0x03);
+    EXPECT_EQ(capture.completed[1].data, counting(14));
+}
+
+TEST(J1939Transport, OtherFrames)
+{
+    Capture capture;
+    EXPECT_FALSE(capture.send(0x18FEF100, {1, 2, 3, 4, 5, 6, 7, 8}, 0));
+    EXPECT_TRUE(capture.send(0x1CECFF00, {32, 20, 0}, 0));
+    EXPECT_EQ(capture.reassembler.activeSessions(), 0);
+
+    // Sizes that need no transport or more packets than announced
+    capture.send(0x1CECFF00, {32, 8, 0, 2, 0xFF, 0xCA, 0xFE, 0}, 0);
+    capture.send(0x1CECFF00, {32, 20, 0, 2, 0xFF, 0xCA, 0xFE, 0}, 0);
+    EXPECT_EQ(capture.reassembler.statistics().dropped, 2);
+    EXPECT_EQ(capture.reassembler.activeSessions(), 0);
+}
+
+}
@@ -0,0 +1,321 @@
+#include <benchmark/benchmark.h>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryFile>
+#include <algorithm>
+#include <functional>
+#include "dbcdata.h"
+#include "jsonwriter.h"
+#include "samples.h"
+
+#ifdef Q_OS_LINUX
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+void writeAttributes(JsonStreamWriter& json, const char* key, const QList<Attribute>& attributes)
+{
+    json.key(key);
+    json.beginArray();
+    for (const Attribute& attribute : attributes) {
+        json.beginObject();
+        json.key("name");
+        json.value(attribute.name);
+        json.key("type");
+        json.value(attribute.type);
+        json.key("value");
+        json.value(attribute.value);
+        if (!attribute.range.isEmpty()) {
+            json.key("range");
+            json.value(attribute.range);
+        }
+        json.endObject();
+    }
+    json.endArray();
+}
+
+// The J1939 sample as a workspace, in the layout MainWindow::saveAsJson writes, so the load
+// paths are measured on a real database rather than generated data
+const QString& workspacePath()
+{
+    static QTemporaryFile file;
+    static QString path;
+    if (!path.isEmpty()) {
+        return path;
+    }
+
+    DbcDataModel model;
+    if (!model.importDBC(j1939SamplePath()) || !file.open()) {
+        return path;
+    }
+    JsonStreamWriter json(&file);
+    json.beginObject();
+
+    json.key("buses");
+    json.beginArray();
+    for (const Network& network : model.networks()) {
+        json.beginObject();
+        json.key("baud");
+        json.value(network.baud);
+        json.key("name");
+        json.value(network.name);
+        writeAttributes(json, "networkAttributes", network.networkAttributes);
+        json.endObject();
+    }
+    json.endArray();
+
+    json.key("messages");
+    json.beginArray();
+    for (const Message& message : model.messages()) {
+        json.beginObject();
+        json.key("data");
+        json.beginArray();
+        for (const Signal& signal : message.messageSignals) {
+            json.beginObject();
+            json.key("bit_length");
+            json.value(signal.bitLength);
+            json.key("description");
+            json.value(signal.description);
+            json.key("enumerations");
+            json.beginArray();
+            for (const Enumeration& enumeration : signal.enumerations) {
+                json.beginObject();
+                json.key("description");
+                json.value(enumeration.description);
+                json.key("name");
+                json.value(enumeration.name);
+                json.key("value");
+                json.value(enumeration.value);
+                json.endObject();
+            }
+            json.endArray();
+            json.key("factor");
+            json.value(signal.factor);
+            json.key("is_bigEndian");
+            json.value(signal.isBigEndian);
+            json.key("is_twosComplement");
+            json.value(signal.isTwosComplement);
+            json.key("name");
+            json.value(signal.name);
+            json.key("offset");
+            json.value(signal.offset);
+            writeAttributes(json, "signalAttributes", signal.signalAttributes);
+            json.key("spn");
+            json.value(signal.spn);
+            json.key("start_bit");
+            json.value(signal.startBit);
+            json.key("units");
+            json.value(signal.units);
+            json.endObject();
+        }
+        json.endArray();
+        json.key("description");
+        json.value(message.description);
+        json.key("length");
+        json.value(message.length);
+        writeAttributes(json, "messageAttributes", message.messageAttributes);
+        json.key("name");
+        json.value(message.name);
+        json.key("pgn");
+        json.value(static_cast<qint64>(message.pgn));
+        json.key("priority");
+        json.value(message.priority);
+        json.endObject();
+    }
+    json.endArray();
+
+    json.key("nodes");
+    json.beginArray();
+    for (const Node& node : model.nodes()) {
+        json.beginObject();
+        json.key("name");
+        json.value(node.name);
+        writeAttributes(json, "nodeAttributes", node.nodeAttributes);
+        json.endObject();
+    }
+    json.endArray();
+
+    json.endObject();
+    if (!json.flush()) {
+        return path;
+    }
+    path = file.fileName();
+    return path;
+}
+
+QList<Attribute> readAttributes(const QJsonArray& array)
+{
+    QList<Attribute> attributes;
+    for (const QJsonValue& value : array) {
+        const QJsonObject object = value.toObject();
+        attributes.append({object.value("name").toString(), object.value("type").toString(),
+                           object.value("value").toString()});
+    }
+    return attributes;
+}
+
+// The load path the pull parser replaced: the whole file in memory, a QJsonDocument over it,
+// and everything copied out of the DOM into the model lists
+bool loadWithJsonDocument(const QString& filePath, QList<Message>& messages, QList<Node>& nodes)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+    if (!document.isObject()) {
+        return false;
+    }
+    const QJsonObject root = document.object();
+
+    for (const QJsonValue& messageValue : root.value("messages").toArray()) {
+        const QJsonObject messageObject = messageValue.toObject();
+        Message message;
+        message.pgn = messageObject.value("pgn").toVariant().toULongLong();
+        message.name = messageObject.value("name").toString();
+        message.description = messageObject.value("description").toString();
+        message.priority = messageObject.value("priority").toInt();
+        message.length = messageObject.value("length").toInt();
+        message.messageAttributes = readAttributes(messageObject.value("messageAttributes").toArray());
+        for (const QJsonValue& signalValue : messageObject.value("data").toArray()) {
+            const QJsonObject signalObject = signalValue.toObject();
+            Signal signal;
+            signal.spn = signalObject.value("spn").toInt(0);
+            signal.name = signalObject.value("name").toString();
+            signal.description = signalObject.value("description").toString();
+            signal.startBit = signalObject.value("start_bit").toInt();
+            signal.bitLength = signalObject.value("bit_length").toInt();
+            signal.isBigEndian = signalObject.value("is_bigEndian").toBool(false);
+            signal.isTwosComplement = signalObject.value("is_twosComplement").toBool(false);
+            signal.factor = signalObject.value("factor").toDouble(1.0);
+            signal.offset = signalObject.value("offset").toDouble(0.0);
+            signal.units = signalObject.value("units").toString();
+            signal.signalAttributes = readAttributes(signalObject.value("signalAttributes").toArray());
+            for (const QJsonValue& enumValue : signalObject.value("enumerations").toArray()) {
+                const QJsonObject enumObject = enumValue.toObject();
+                Enumeration enumeration;
+                enumeration.name = enumObject.value("name").toString();
+                enumeration.description = enumObject.value("description").toString();
+                enumeration.value = enumObject.value("value").toInt();
+                signal.enumerations.append(enumeration);
+            }
+            message.messageSignals.append(signal);
+        }
+        messages.append(message);
+    }
+    std::sort(messages.begin(), messages.end(), [](const Message& a, const Message& b) {
+        return a.name.toLower() < b.name.toLower();
+    });
+
+    for (const QJsonValue& nodeValue : root.value("nodes").toArray()) {
+        const QJsonObject nodeObject = nodeValue.toObject();
+        Node node;
+        node.name = nodeObject.value("name").toString();
+        node.nodeAttributes = readAttributes(nodeObject.value("nodeAttributes").toArray());
+        nodes.append(node);
+    }
+    return true;
+}
+
+// Peak memory a load adds on top of the process, in MiB. The load runs in a forked child whose
+// high-water mark starts at the inherited resident size, so both paths are measured from the
+// same point and neither sees the other's freed memory. -1 where this cannot be measured.
+double peakLoadMemory(const std::function<bool()>& load)
+{
+#ifdef Q_OS_LINUX
+    int channel[2];
+    if (pipe(channel) != 0) {
+        return -1;
+    }
+    const pid_t child = fork();
+    if (child == 0) {
+        close(channel[0]);
+        auto residentKiB = [](const char* field) {
+            QFile status(QStringLiteral("/proc/self/status"));
+            if (!status.open(QIODevice::ReadOnly)) {
+                return qint64(-1);
+            }
+            for (const QByteArray& line : status.readAll().split('\n')) {
+                if (line.startsWith(field)) {
+                    return line.mid(qstrlen(field)).trimmed().split(' ').first().toLongLong();
+                }
+            }
+            return qint64(-1);
+        };
+        const qint64 before = residentKiB("VmRSS:");
+        const bool loaded = load();
+        const qint64 peak = residentKiB("VmHWM:");
+        const double added = loaded && before >= 0 && peak >= 0 ? double(peak - before) / 1024.0 : -1.0;
+        const ssize_t written = write(channel[1], &added, sizeof(added));
+        _exit(written == sizeof(added) ? 0 : 1);
+    }
+    close(channel[1]);
+    double added = -1;
+    if (child < 0 || read(channel[0], &added, sizeof(added)) != sizeof(added)) {
+        added = -1;
+    }
+    close(channel[0]);
+    if (child > 0) {
+        waitpid(child, nullptr, 0);
+    }
+    return added;
+#else
+    Q_UNUSED(load);
+    return -1;
+#endif
+}
+
+void BM_LoadJsonPullParser(benchmark::State& state)
+{
+    const QString& filePath = workspacePath();
+    if (filePath.isEmpty()) {
+        state.SkipWithError("Failed to write the workspace");
+        return;
+    }
+    for (auto _ : state) {
+        DbcDataModel model;
+        if (!model.loadJson(filePath)) {
+            state.SkipWithError("Failed to load the workspace");
+            break;
+        }
+        benchmark::DoNotOptimize(model.messages().size());
+    }
+    state.SetBytesProcessed(state.iterations() * QFileInfo(filePath).size());
+    state.counters["peakMiB"] = peakLoadMemory([&filePath]() {
+        DbcDataModel model;
+        return model.loadJson(filePath);
+    });
+}
+BENCHMARK(BM_LoadJsonPullParser)->Unit(benchmark::kMillisecond);
+
+void BM_LoadJsonDocument(benchmark::State& state)
+{
+    const QString& filePath = workspacePath();
+    if (filePath.isEmpty()) {
+        state.SkipWithError("Failed to write the workspace");
+        return;
+    }
+    for (auto _ : state) {
+        QList<Message> messages;
+        QList<Node> nodes;
+        if (!loadWithJsonDocument(filePath, messages, nodes)) {
+            state.SkipWithError("Failed to load the workspace");
+            break;
+        }
+        benchmark::DoNotOptimize(messages.size());
+    }
+    state.SetBytesProcessed(state.iterations() * QFileInfo(filePath).size());
+    state.counters["peakMiB"] = peakLoadMemory([&filePath]() {
+        QList<Message> messages;
+        QList<Node> nodes;
+        return loadWithJsonDocument(filePath, messages, nodes);
+    });
+}
+BENCHMARK(BM_LoadJsonDocument)->Unit(benchmark::kMillisecond);
+
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <QHash>
+#include <QSet>
+#include "dbcdata.h"
+#include "dbcquery.h"
+#include "j1939.h"
+
+namespace {
+
+Attribute makeAttribute(const char* name, const char* value)
+{
+    Attribute attribute;
+    attribute.name = QString::fromUtf8(name);
+    attribute.type = QStringLiteral("STRING");
+    attribute.value = QString::fromUtf8(value);
+    return attribute;
+}
+
+Signal makeSignal(const char* name, int spn)
+{
+    Signal signal;
+    signal.spn = spn;
+    signal.name = QString::fromUtf8(name);
+    signal.startBit = 0;
+    signal.bitLength = 8;
+    signal.isBigEndian = false;
+    signal.isTwosComplement = false;
+    signal.isMultiplexer = false;
+    signal.factor = 1.0;
+    signal.offset = 0.0;
+    signal.multiplexValue = -1;
+    return signal;
+}
+
+Message makeMessage(const char* name, quint64 pgn)
+{
+    Message message;
+    message.pgn = pgn;
+    message.name = QString::fromUtf8(name);
+    message.priority = 6;
+    message.length = 8;
+    message.txPeriodicity = 0;
+    message.multiplexValue = -1;
+    message.txOnChange = false;
+    return message;
+}
+
+// EEC1 from a DBC BO_ id, CCVS as a bare PGN, and TSC1 whose signal has no SPN
+class DbcQuery : public ::testing::Test {
+    protected:
+        DbcDataModel model;
+        DbcQueryEngine engine;
+
+        void SetUp() override
+        {
+            Network network;
+            network.name = QStringLiteral("Vehicle");
+            network.baud = QStringLiteral("250k");
+            network.networkAttributes.append(makeAttribute("BusType", "CAN"));
+            model.networks().append(network);
+
+            Node node;
+            node.name = QStringLiteral("Engine");
+            node.nodeAttributes.append(makeAttribute("NmStationAddress", "0"));
+            model.nodes().append(node);
+
+            Message eec1 = makeMessage("EEC1", DbcExtendedIdFlag | 0x0CF00400);
+            Signal speed = makeSignal("EngineSpeed", 190);
+            speed.signalAttributes.append(makeAttribute("SigType", "\"Default\""));
+            eec1.messageSignals.append(speed);
+            model.messages().append(eec1);
+
+            Message ccvs = makeMessage("CCVS", 0xFEF1);
+            ccvs.messageSignals.append(makeSignal("WheelBasedVehicleSpeed", 84));
+            ccvs.messageAttributes.append(makeAttribute("GenMsgCycleTime", "100"));
+            model.messages().append(ccvs);
+
+            Message tsc1 = makeMessage("TSC1", DbcExtendedIdFlag | 0x0C000003);
+            tsc1.messageSignals.append(makeSignal("Unnumbered", 0));
+            tsc1.messageAttributes.append(makeAttribute("GenMsgCycleTime", "10"));
+            model.messages().append(tsc1);
+            model.rebuildMessageIndex();
+
+            engine.setModels(QList<DbcDataModel*>() << &model);
+        }
+
+        // Matches of a query string for the model, with whether every term was well formed
+        DbcQueryMatches query(const QString& text, bool* wellFormed = nullptr)
+        {
+            QStringList fieldTerms;
+            QStringList plainWords;
+            DbcQueryEngine::splitTerms(text, fieldTerms, plainWords);
+            QHash<DbcDataModel*, DbcQueryMatches> results;
+            const bool ok = engine.run(fieldTerms, results);
+            if (wellFormed) {
+                *wellFormed = ok;
+            }
+            return results.value(&model);
+        }
+};
+
+TEST_F(DbcQuery, SplitTerms)
+{
+    QStringList fieldTerms;
+    QStringList plainWords;
+    DbcQueryEngine::splitTerms(QStringLiteral("  EEC1 PGN:0xF004 speed  attr:SigType=Default spn:190"), fieldTerms,
+                               plainWords);
+    EXPECT_EQ(fieldTerms, QStringList({"PGN:0xF004", "attr:SigType=Default", "spn:190"}));
+    EXPECT_EQ(plainWords, QStringList({"EEC1", "speed"}));
+}
+
+// Messages are found by PGN in hex or decimal, and by the DBC identifier they were imported with
+TEST_F(DbcQuery, Pgn)
+{
+    EXPECT_EQ(query("pgn:0xF004").messages, QSet<int>({0}));
+    EXPECT_EQ(query("pgn:61444").messages, QSet<int>({0}));
+    EXPECT_EQ(query("pgn:0x8CF00400").messages, QSet<int>({0}));
+    EXPECT_EQ(query("PGN:0XFEF1").messages, QSet<int>({1}));
+    EXPECT_EQ(query("pgn:0x0000").messages, QSet<int>({2}));
+    EXPECT_TRUE(query("pgn:0x1234").messages.isEmpty());
+    EXPECT_TRUE(query("pgn:0xF004").signalMessages.isEmpty());
+}
+
+TEST_F(DbcQuery, Spn)
+{
+    EXPECT_EQ(query("spn:190").signalMessages, QSet<int>({0}));
+    EXPECT_EQ(query("spn:84").signalMessages, QSet<int>({1}));
+    EXPECT_TRUE(query("spn:190").messages.isEmpty());
+    EXPECT_TRUE(query("spn:0").signalMessages.isEmpty());
+    EXPECT_TRUE(query("spn:191").signalMessages.isEmpty());
+}
+
+// Names and values compare case-insensitively and without quotes
+TEST_F(DbcQuery, Attribute)
+{
+    EXPECT_EQ(query("attr:GenMsgCycleTime=100").messages, QSet<int>({1}));
+    EXPECT_EQ(query("attr:genmsgcycletime").messages, QSet<int>({1, 2}));
+    EXPECT_EQ(query("attr:BusType=can").networks, QSet<int>({0}));
+    EXPECT_EQ(query("attr:NmStationAddress").nodes, QSet<int>({0}));
+    EXPECT_EQ(query("attr:SigType=default").signalMessages, QSet<int>({0}));
+    EXPECT_TRUE(query("attr:SigType=other").signalMessages.isEmpty());
+    EXPECT_TRUE(query("attr:Missing").messages.isEmpty());
+}
+
+// All terms have to match; a message found through its own fields stays an own match
+TEST_F(DbcQuery, Combined)
+{
+    const DbcQueryMatches matches = query("pgn:0xF004 spn:190");
+    EXPECT_EQ(matches.messages, QSet<int>({0}));
+    EXPECT_TRUE(matches.signalMessages.isEmpty());
+
+    EXPECT_TRUE(query("pgn:0xFEF1 spn:190").messages.isEmpty());
+    EXPECT_EQ(query("attr:GenMsgCycleTime spn:84").messages, QSet<int>({1}));
+}
+
+// Terms whose argument does not parse match nothing instead of being ignored
+TEST_F(DbcQuery, Malformed)
+{
+    const char* const queries[] = {"pgn:", "pgn:0x", "pgn:F004", "spn:", "spn:abc", "attr:", "attr:=1",
+                                   "attr:GenMsgCycleTime spn:x"};
+    for (const char* text : queries) {
+        SCOPED_TRACE(text);
+        bool wellFormed = true;
+        const DbcQueryMatches matches = query(QString::fromUtf8(text), &wellFormed);
+        EXPECT_FALSE(wellFormed);
+        EXPECT_TRUE(matches.networks.isEmpty());
+        EXPECT_TRUE(matches.nodes.isEmpty());
+        EXPECT_TRUE(matches.messages.isEmpty());
+        EXPECT_TRUE(matches.signalMessages.isEmpty());
+    }
+}
+
+// Edits show once the model's indexes are invalidated
+TEST_F(DbcQuery, Invalidate)
+{
+    EXPECT_TRUE(query("spn:4000").signalMessages.isEmpty());
+    model.messages()[1].messageSignals.append(makeSignal("Added", 4000));
+    engine.invalidate(&model);
+    EXPECT_EQ(query("spn:4000").signalMessages, QSet<int>({1}));
+}
+
+}
@@ -0,0 +1,18 @@
+#ifndef SAMPLES_H
+#define SAMPLES_H
+
+#include <QString>
+
+// Path of a file under "Sample Files", the directory is set by tests/CMakeLists.txt
+inline QString samplePath(const char* relativePath)
+{
+    return QString::fromUtf8(HEAVYINSIGHT_SAMPLES_DIR) + QLatin1Char('/') + QString::fromUtf8(relativePath);
+}
+
+// The 19k-line J1939 database the import, export and decode measurements are made on
+inline QString j1939SamplePath()
+{
+    return samplePath("J1939 DBC/j1939_DBC_EXAMPLE.dbc");
+}
+
+#endif // SAMPLES_H
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include <QGuiApplication>
+#include <QHash>
+#include <memory>
+#include "dbcdata.h"
+#include "dbctreemodel.h"
+#include "j1939.h"
+
+namespace {
+
+Signal makeSignal(const char* name, int spn)
+{
+    Signal signal;
+    signal.spn = spn;
+    signal.name = QString::fromUtf8(name);
+    signal.startBit = 0;
+    signal.bitLength = 8;
+    signal.isBigEndian = false;
+    signal.isTwosComplement = false;
+    signal.isMultiplexer = false;
+    signal.factor = 1.0;
+    signal.offset = 0.0;
+    signal.multiplexValue = -1;
+    return signal;
+}
+
+Message makeMessage(const char* name, quint64 pgn, const Signal& signal)
+{
+    Message message;
+    message.pgn = pgn;
+    message.name = QString::fromUtf8(name);
+    message.priority = 6;
+    message.length = 8;
+    message.txPeriodicity = 0;
+    message.multiplexValue = -1;
+    message.txOnChange = false;
+    message.messageSignals.append(signal);
+    return message;
+}
+
+// The tree over one model: network Vehicle, node Engine on it sending EEC1, and three messages
+// whose signals are only built into the tree when a branch is fetched
+class DbcTreeSearch : public ::testing::Test {
+    protected:
+        DbcDataModel model;
+        std::unique_ptr<DbcTreeModel> tree;
+
+        static void SetUpTestSuite()
+        {
+            // The model holds icons, which want a GUI application; offscreen needs no display
+            if (!QCoreApplication::instance()) {
+                qputenv("QT_QPA_PLATFORM", "offscreen");
+                static int argc = 1;
+                static char name[] = "HeavyInsightTests";
+                static char* argv[] = {name, nullptr};
+                static QGuiApplication application(argc, argv);
+            }
+        }
+
+        void SetUp() override
+        {
+            Network network;
+            network.name = QStringLiteral("Vehicle");
+            network.baud = QStringLiteral("250k");
+            model.networks().append(network);
+
+            NodeNetworkAssociation association;
+            association.networkName = network.name;
+            association.sourceAddress = 0;
+            TxRxMessage eec1;
+            eec1.name = QStringLiteral("EEC1");
+            association.tx.append(eec1);
+            Node node;
+            node.name = QStringLiteral("Engine");
+            node.networks.append(association);
+            model.nodes().append(node);
+
+            model.messages().append(makeMessage("EEC1", DbcExtendedIdFlag | 0x0CF00400, makeSignal("EngineSpeed", 190)));
+            model.messages().append(makeMessage("CCVS", 0xFEF1, makeSignal("WheelBasedVehicleSpeed", 84)));
+            model.messages().append(makeMessage("SpeedLimit", 0xFD00, makeSignal("Limit", 0)));
+            model.rebuildMessageIndex();
+            model.rebuildEndpointIndex();
+
+            tree = std::make_unique<DbcTreeModel>();
+            tree->setModels(QList<DbcDataModel*>() << &model);
+        }
+
+        // SearchMatch flags per top-level item name
+        QHash<QString, int> search(const QString& text)
+        {
+            QHash<QString, int> matches;
+            tree->search(text, [&matches](const QModelIndex& item, int match) {
+                matches.insert(item.data().toString(), match);
+            });
+            return matches;
+        }
+};
+
+const int No = DbcTreeModel::NoMatch;
+const int Name = DbcTreeModel::NameMatch;
+const int Content = DbcTreeModel::ContentMatch;
+
+TEST_F(DbcTreeSearch, Names)
+{
+    using Matches = QHash<QString, int>;
+    EXPECT_EQ(search("speed"),
+              (Matches{{"Vehicle", No}, {"Engine", No}, {"EEC1", Content}, {"CCVS", Content}, {"SpeedLimit", Name}}));
+    EXPECT_EQ(search("SP"),
+              (Matches{{"Vehicle", No}, {"Engine", No}, {"EEC1", Content}, {"CCVS", Content}, {"SpeedLimit", Name}}));
+    EXPECT_EQ(search("eec"),
+              (Matches{{"Vehicle", No}, {"Engine", Content}, {"EEC1", Name}, {"CCVS", No}, {"SpeedLimit", No}}));
+    EXPECT_EQ(search("vehicle"),
+              (Matches{{"Vehicle", Name}, {"Engine", Content}, {"EEC1", No}, {"CCVS", Content}, {"SpeedLimit", No}}));
+    EXPECT_EQ(search("missing"),
+              (Matches{{"Vehicle", No}, {"Engine", No}, {"EEC1", No}, {"CCVS", No}, {"SpeedLimit", No}}));
+    EXPECT_EQ(search(""),
+              (Matches{{"Vehicle", Name}, {"Engine", Name}, {"EEC1", Name}, {"CCVS", Name}, {"SpeedLimit", Name}}));
+
+    // Signals were found without their branches being built
+    const QModelIndex messages = tree->index(2, 0);
+    ASSERT_EQ(tree->rowCount(messages), 3);
+    EXPECT_TRUE(tree->canFetchMore(tree->index(0, 0, messages)));
+}
+
+// Field terms go through the query engine and must match along with the words
+TEST_F(DbcTreeSearch, FieldTerms)
+{
+    using Matches = QHash<QString, int>;
+    EXPECT_EQ(search("pgn:0xFEF1"),
+              (Matches{{"Vehicle", No}, {"Engine", No}, {"EEC1", No}, {"CCVS", Name}, {"SpeedLimit", No}}));
+    EXPECT_EQ(search("spn:190 speed"),
+              (Matches{{"Vehicle", No}, {"Engine", No}, {"EEC1", Content}, {"CCVS", No}, {"SpeedLimit", No}}));
+    EXPECT_EQ(search("pgn:0xFEF1 engine"),
+              (Matches{{"Vehicle", No}, {"Engine", No}, {"EEC1", No}, {"CCVS", No}, {"SpeedLimit", No}}));
+    EXPECT_EQ(search("spn:abc").value("EEC1"), No);
+
+    EXPECT_EQ(DbcTreeModel::searchWords("pgn:0xFEF1  Wheel Speed"), QString("wheel speed"));
+    EXPECT_EQ(DbcTreeModel::searchWords("Wheel  Speed"), QString("wheel  speed"));
+}
+
+// Renames reach the search through the change notifications
+TEST_F(DbcTreeSearch, Rename)
+{
+    Signal& signal = model.messages()[1].messageSignals[0];
+    signal.name = QStringLiteral("Velocity");
+    tree->signalChanged(&model, &signal);
+    EXPECT_EQ(search("velocity").value("CCVS"), Content);
+    EXPECT_EQ(search("wheel").value("CCVS"), No);
+}
+
+// Closing a model takes out the items only it referenced
+TEST_F(DbcTreeSearch, RemoveModel)
+{
+    DbcDataModel other;
+    other.messages().append(makeMessage("CCVS", 0xFEF1, makeSignal("WheelBasedVehicleSpeed", 84)));
+    other.messages().append(makeMessage("DM1", 0xFECA, makeSignal("Lamps", 0)));
+    other.rebuildMessageIndex();
+    other.rebuildEndpointIndex();
+    tree->addModel(&other);
+
+    const QModelIndex messages = tree->index(2, 0);
+    EXPECT_EQ(tree->rowCount(messages), 4);
+    EXPECT_EQ(search("lamps").value("DM1"), Content);
+
+    tree->removeModel(&model);
+    EXPECT_EQ(tree->rowCount(tree->index(0, 0)), 0);
+    EXPECT_EQ(tree->rowCount(tree->index(1, 0)), 0);
+    EXPECT_EQ(tree->rowCount(messages), 2);
+    EXPECT_EQ(search("speed"), (QHash<QString, int>{{"CCVS", Content}, {"DM1", No}}));
+}
+
+}